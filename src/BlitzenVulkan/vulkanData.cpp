@@ -1,31 +1,93 @@
+#define BLIT_LOG_CHANNEL    Vulkan
+
 #include "vulkanData.h"
 //Included in the source and forward declared in the header to avoid circular dependency
 #include "vulkanRenderer.h"
 
+#include <algorithm>
+
 namespace BlitzenVulkan
 {
-    void Node::UpdateTransform(const glm::mat4& topMatrix)
+    uint32_t TransformHierarchy::AddNode(uint32_t parent, const glm::mat4& localTransform, MeshAsset* pMesh)
     {
-        //The parent's matrix is used to get the world transform
-        worldTransform = topMatrix * localTransform;
-        for(Node* child : m_children)
+        uint32_t index = static_cast<uint32_t>(parents.size());
+        BLIT_ASSERT(parent == BLITZEN_TRANSFORM_NO_PARENT || parent < index)
+        parents.push_back(parent);
+        localTransforms.push_back(localTransform);
+        worldTransforms.push_back(localTransform);
+        meshes.push_back(pMesh);
+        subtreeEnds.push_back(index + 1);
+        objectOffsets.push_back(objectCount);
+        if(pMesh)
         {
-            child->UpdateTransform(worldTransform);
+            meshNodes.push_back(index);
+            objectCount += static_cast<uint32_t>(pMesh->surfaces.size());
         }
+
+        // Nodes are added depth first, so the new node is the last one of every ancestor's subtree so far
+        for(uint32_t ancestor = parent; ancestor != BLITZEN_TRANSFORM_NO_PARENT; ancestor = parents[ancestor])
+        {
+            subtreeEnds[ancestor] = index + 1;
+        }
+        return index;
     }
 
-    void Node::AddToDrawContext(glm::mat4& topMatrix, DrawContext& drawContext)
+    void TransformHierarchy::UpdateWorldTransforms()
     {
-        //Most of the work is done when the node is a mesh node
-        if(pMesh)
+        // Parents come first, so their world transform is always ready by the time a child reads it
+        for(size_t i = 0; i < parents.size(); ++i)
         {
-            //A mesh node's transform goes through one final modification, where it is multiplied by the scene's transform
-            glm::mat4 finalMatrix = topMatrix * worldTransform;
+            uint32_t parent = parents[i];
+            worldTransforms[i] = parent == BLITZEN_TRANSFORM_NO_PARENT ? localTransforms[i] : worldTransforms[parent] * localTransforms[i];
+        }
+        dirtyNodes.clear();
+    }
+
+    void TransformHierarchy::SetLocalTransform(uint32_t node, const glm::mat4& localTransform)
+    {
+        localTransforms[node] = localTransform;
+        dirtyNodes.push_back(node);
+    }
+
+    void TransformHierarchy::PropagateDirtyTransforms(std::vector<uint32_t>& changedMeshNodes)
+    {
+        if(dirtyNodes.empty())
+        {
+            return;
+        }
+
+        // Once sorted, an ancestor comes before the dirty nodes in its subtree, which are then skipped since its pass covers them.
+        // The parent of the first node in each pass is outside of it and already up to date
+        std::sort(dirtyNodes.begin(), dirtyNodes.end());
+        uint32_t coveredEnd = 0;
+        for(uint32_t dirty : dirtyNodes)
+        {
+            if(dirty < coveredEnd)
+            {
+                continue;
+            }
+            coveredEnd = subtreeEnds[dirty];
+            for(uint32_t i = dirty; i < coveredEnd; ++i)
+            {
+                uint32_t parent = parents[i];
+                worldTransforms[i] = parent == BLITZEN_TRANSFORM_NO_PARENT ? localTransforms[i] : worldTransforms[parent] * localTransforms[i];
+                if(meshes[i])
+                {
+                    changedMeshNodes.push_back(i);
+                }
+            }
+        }
+        dirtyNodes.clear();
+    }
+
+    void LoadedScene::AddToDrawContext(const glm::mat4& topMatrix, DrawContext& drawContext)
+    {
+        for(uint32_t node : m_hierarchy.meshNodes)
+        {
+            MeshAsset* pMesh = m_hierarchy.meshes[node];
 
-            glm::vec3 translation;
-            glm::vec3 scale;
-            glm::vec4 rotation;
-            DecomposeTransform(translation, rotation, scale, finalMatrix);
+            //A mesh node's transform goes through one final modification, where it is multiplied by the scene's transform
+            glm::mat4 finalMatrix = topMatrix * m_hierarchy.worldTransforms[node];
 
             //All the surfaces of the mesh will be added to the draw context, so it is resized in advance
             size_t startIndex = drawContext.opaqueRenderObjects.size();
@@ -68,25 +130,11 @@ namespace BlitzenVulkan
                 #endif
             }
         }
-        //Recurse down to update the next mesh node that is found
-        for(Node* child : m_children)
-        {
-            child->AddToDrawContext(topMatrix, drawContext);
-        }
-    }
-
-    void LoadedScene::AddToDrawContext(glm::mat4& topMatrix, DrawContext& drawContext)
-    {
-        //Iterates through the parent nodes to update their children based on the hierarchy
-        for(Node* pNode : m_pureParentNodes)
-        {
-            pNode->AddToDrawContext(topMatrix, drawContext);
-        }
     }
 
     void LoadedScene::ClearAll()
     {
-        vmaDestroyBuffer(m_pRenderer->m_allocator, m_materialDataBuffer.buffer, m_materialDataBuffer.allocation);
+        m_materialDataBuffer.CleanupResources(m_pRenderer->m_allocator);
 
         for(auto& [name, texture] : m_textures)
         {
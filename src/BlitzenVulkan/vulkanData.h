@@ -8,6 +8,7 @@
 
 #include "Core/math.h"
 #include "Core/blitAssert.h"
+#include "Core/blitMemory.h"
 
 #include <vulkan/vulkan.h>
 
@@ -66,13 +67,40 @@ namespace BlitzenVulkan
         VkDescriptorPool GetDescriptorPool();
     };
 
+    // Node transforms that one render context can carry, the engine holds on to the rest until the next one
+    #define BLITZEN_RENDER_CONTEXT_MAX_NODE_UPDATES                 64
+
+    // Gives a node of one of the manifest's scenes a new local transform, which moves it in every instance of the scene
+    struct NodeTransformUpdate
+    {
+        uint32_t scene;
+        uint32_t node;
+        glm::mat4 localTransform;
+    };
+
+    // A copy of everything that a frame is drawn with. It may be drawn on the render thread while the main thread simulates the next frame,
+    // so it never points to game state
     struct RenderContext
     {
-        bool bResize;
+        bool bResize = false;
         bool bDrawIndirect = true;
+        // What the swapchain is recreated with when bResize is set
+        uint32_t windowWidth = 0;
+        uint32_t windowHeight = 0;
 
-        void* pCamera;
         glm::mat4 viewMatrix;// This is given separately so that the frustum can be frozen
+        glm::mat4 projectionView;
+        glm::mat4 projectionTranspose;
+
+        // The main thread's frame that the context was made on
+        uint32_t frameIndex = 0;
+        // Clock time of the main thread's frame
+        double time = 0.0;
+        // Set when the memory report is due. It is taken by the thread that draws the context, since that one owns the renderer
+        bool bReportMemory = false;
+
+        NodeTransformUpdate nodeUpdates[BLITZEN_RENDER_CONTEXT_MAX_NODE_UPDATES];
+        uint32_t nodeUpdateCount = 0;
     };
 
     struct VulkanStats
@@ -96,11 +124,21 @@ namespace BlitzenVulkan
 
     struct AllocatedBuffer
     {
-        VkBuffer buffer;
-        VmaAllocation allocation;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
         VmaAllocationInfo allocationInfo;
+
+        void CleanupResources(const VmaAllocator& allocator);
     };
 
+    // Allocations carry their memory category in their user data, so that it can be taken out of the memory report when they are destroyed
+    inline void* GpuMemoryCategoryToUserData(BlitzenCore::GpuMemoryCategory category) 
+    {
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(category) + 1);
+    }
+    void TrackGpuAllocation(const VmaAllocator& allocator, VmaAllocation allocation);
+    void TrackGpuFree(const VmaAllocator& allocator, VmaAllocation allocation);
+
     //Represents a vertex processed in shaders. UvMaps split into 2 floats, for alignment purposes
     struct Vertex 
     {
@@ -296,35 +334,57 @@ namespace BlitzenVulkan
         #endif
     };
 
-    class Node
+    // Marks a node without a parent in TransformHierarchy::parents
+    #define BLITZEN_TRANSFORM_NO_PARENT                             UINT32_MAX
+
+    // The nodes of a scene in flat arrays, ordered so that every parent comes before its children (depth first).
+    // The world transforms are then found with one pass from the front, without recursion or following pointers
+    struct TransformHierarchy
     {
-    public:
-        Node* pParent;
-        std::vector<Node*> m_children;
+        // Index of each node's parent in the same arrays, always lower than the node's own
+        std::vector<uint32_t> parents;
 
-        //Each node starts with a local transform which is then updated into the world transform by updating with a parent matrix
-        glm::mat4 worldTransform;
-        glm::mat4 localTransform;
+        std::vector<glm::mat4> localTransforms;
+        std::vector<glm::mat4> worldTransforms;
 
-        //Some Nodes also include a mesh asset, that makes them mesh nodes and AddToDrawContext has extra functionality for them
-        MeshAsset* pMesh = nullptr;
-    public:
-        void AddToDrawContext(glm::mat4& topMatrix, DrawContext& drawContext);
+        // Null for nodes that only place their children
+        std::vector<MeshAsset*> meshes;
+
+        // Indices of the nodes that have a mesh, in order, so that drawing does not go through the rest
+        std::vector<uint32_t> meshNodes;
+
+        // One past the last node of each node's subtree, the subtree is contiguous since every node follows its parent
+        std::vector<uint32_t> subtreeEnds;
+
+        // Where each mesh node's surfaces start among the render objects that one instance of the scene adds to the draw context
+        std::vector<uint32_t> objectOffsets;
+        uint32_t objectCount = 0;
+
+        // Nodes whose local transform changed since the world transforms were last updated, their whole subtree is out of date
+        std::vector<uint32_t> dirtyNodes;
+
+        // Adds a node after its parent (or as a root) and returns its index
+        uint32_t AddNode(uint32_t parent, const glm::mat4& localTransform, MeshAsset* pMesh);
 
-        //Takes a top matrix and uses it to initialize the world transform
-        void UpdateTransform(const glm::mat4& topMatrix);
+        void UpdateWorldTransforms();
+
+        void SetLocalTransform(uint32_t node, const glm::mat4& localTransform);
+
+        // Only recomputes the subtrees of the dirty nodes, the mesh nodes among them are added to changedMeshNodes
+        void PropagateDirtyTransforms(std::vector<uint32_t>& changedMeshNodes);
     };
 
     class LoadedScene
     {
     public:
-        std::unordered_map<std::string, Node> m_nodes;
         std::unordered_map<std::string, MeshAsset> m_meshes;
         std::unordered_map<std::string, AllocatedImage> m_textures;
         std::unordered_map<std::string, MaterialInstance> m_materials;
 
-        //Holds all pure parent nodes(ones that have no parent nodes)
-        std::vector<Node*> m_pureParentNodes;
+        TransformHierarchy m_hierarchy;
+
+        // The renderer's instances of this scene, a node that moves has to move in every one of them
+        std::vector<uint32_t> m_instances;
 
         //Holds all the samplers used for the textures in a scene
         std::vector<VkSampler> m_samplers;
@@ -334,11 +394,19 @@ namespace BlitzenVulkan
 
         VulkanRenderer* m_pRenderer;
 
-        void AddToDrawContext(glm::mat4& topMatrix, DrawContext& drawContex);
+        void AddToDrawContext(const glm::mat4& topMatrix, DrawContext& drawContex);
 
         void ClearAll();
     };
 
+    // A manifest instance of a loaded scene, the render objects that it adds to the draw context are contiguous
+    struct SceneInstance
+    {
+        LoadedScene* pScene;
+        glm::mat4 transform;
+        uint32_t firstObject;
+    };
+
     //Gets generic data from the transform of an object that will be used for culling or other operations
     void DecomposeTransform(glm::vec3& translation, glm::vec4& rotation, glm::vec3& scale, const glm::mat4& transform);
 }
\ No newline at end of file
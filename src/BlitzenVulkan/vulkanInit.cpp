@@ -1,3 +1,5 @@
+#define BLIT_LOG_CHANNEL    Vulkan
+
 #include "vulkanRenderer.h"
 #include "Platform/blitPlatform.h"
 
@@ -36,16 +38,18 @@ namespace BlitzenVulkan
     // Validation layers function pointers
 
 
-    void VulkanRenderer::Init(void* pState, uint32_t* pWidth, uint32_t* pHeight)
+    uint8_t VulkanRenderer::InitInstance()
     {
-        m_pWindowWidth = pWidth;
-        m_pWindowHeight = pHeight; 
-
         /*
             If the renderer ever uses a custom allocator it should be initialized here
         */
         m_pCustomAllocator = nullptr;
 
+        BlitzenCore::MetricsRegister("DrawCalls", BlitzenCore::MetricType::Counter, m_metrics.drawCalls);
+        BlitzenCore::MetricsRegister("VisibleObjects", BlitzenCore::MetricType::Counter, m_metrics.visibleObjects);
+        BlitzenCore::MetricsRegister("Triangles", BlitzenCore::MetricType::Counter, m_metrics.triangles);
+        BlitzenCore::MetricsRegister("UploadedBytes", BlitzenCore::MetricType::Counter, m_metrics.uploadedBytes);
+
         /*------------------------
             VkInstance Creation
         -------------------------*/
@@ -157,8 +161,11 @@ namespace BlitzenVulkan
         ----------------------------------------------------------*/
         #endif
 
+        return 1;
+    }
 
-
+    uint8_t VulkanRenderer::InitDevice(void* pState)
+    {
         {
             BlitzenPlatform::PlatformState* pTrueState = reinterpret_cast<BlitzenPlatform::PlatformState*>(pState);
             BlitzenPlatform::CreateVulkanSurface(pTrueState, m_bootstrapObjects.instance, m_bootstrapObjects.surface, m_pCustomAllocator);
@@ -170,7 +177,11 @@ namespace BlitzenVulkan
         {
             uint32_t physicalDeviceCount = 0;
             vkEnumeratePhysicalDevices(m_bootstrapObjects.instance, &physicalDeviceCount, nullptr);
-            //BLIT_ASSERT(physicalDeviceCount)
+            if(!physicalDeviceCount)
+            {
+                BLIT_ERROR("No GPU with Vulkan support was found")
+                return 0;
+            }
             std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
             vkEnumeratePhysicalDevices(m_bootstrapObjects.instance, &physicalDeviceCount, physicalDevices.data());
 
@@ -372,12 +383,19 @@ namespace BlitzenVulkan
             Device created and saved to m_device. Queue handles retrieved
         */
 
+        return 1;
+    }
+
+    uint8_t VulkanRenderer::InitSwapchain(uint32_t* pWidth, uint32_t* pHeight)
+    {
+        m_windowWidth = *pWidth;
+        m_windowHeight = *pHeight;
 
         CreateSwapchain(pWidth, pHeight);
         
-        
         InitAllocator();
         InitCommands();
+        return 1;
     }
 
     void VulkanRenderer::CreateSwapchain(uint32_t* pWidth, uint32_t* pHeight)
@@ -459,7 +477,7 @@ namespace BlitzenVulkan
             }
         }
         //Set the swapchain extent to the window's width and height
-        m_bootstrapObjects.swapchainExtent = {static_cast<uint32_t>(*m_pWindowWidth), static_cast<uint32_t>(*m_pWindowHeight)};
+        m_bootstrapObjects.swapchainExtent = {m_windowWidth, m_windowHeight};
         // Retrieve surface capabilities to properly configure some swapchain values
         VkSurfaceCapabilitiesKHR surfaceCapabilities{};
         VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_bootstrapObjects.chosenGPU, m_bootstrapObjects.surface, &surfaceCapabilities));
@@ -526,9 +544,9 @@ namespace BlitzenVulkan
         }
 
         #if BLITZEN_START_VULKAN_WITH_INDIRECT
-            vmaDestroyBuffer(m_allocator, m_drawIndirectDataBuffer.buffer, m_drawIndirectDataBuffer.allocation);
-            vmaDestroyBuffer(m_allocator, m_finalIndirectBuffer.buffer, m_finalIndirectBuffer.allocation);
-            vmaDestroyBuffer(m_allocator, m_surfaceFrustumCollisionBuffer.buffer, m_surfaceFrustumCollisionBuffer.allocation);
+            m_drawIndirectDataBuffer.CleanupResources(m_allocator);
+            m_finalIndirectBuffer.CleanupResources(m_allocator);
+            m_surfaceFrustumCollisionBuffer.CleanupResources(m_allocator);
             vkDestroyPipeline(m_device, m_indirectCullingComputePipelineData.pipeline, nullptr);
             vkDestroyPipelineLayout(m_device, m_indirectCullingComputePipelineData.layout, nullptr);
             for(size_t i = 0; i < m_indirectCullingComputePipelineData.setLayouts.size(); ++i)
@@ -536,11 +554,9 @@ namespace BlitzenVulkan
                 vkDestroyDescriptorSetLayout(m_device, m_indirectCullingComputePipelineData.setLayouts[i], nullptr);
             }
         #endif
-        vmaDestroyBuffer(m_allocator, m_globalMaterialConstantsBuffer.buffer, m_globalMaterialConstantsBuffer.allocation);
-        vmaDestroyBuffer(m_allocator, m_globalIndexAndVertexBuffer.vertexBuffer.buffer, 
-        m_globalIndexAndVertexBuffer.vertexBuffer.allocation);
-        vmaDestroyBuffer(m_allocator, m_globalIndexAndVertexBuffer.indexBuffer.buffer, 
-        m_globalIndexAndVertexBuffer.indexBuffer.allocation);
+        m_globalMaterialConstantsBuffer.CleanupResources(m_allocator);
+        m_globalIndexAndVertexBuffer.vertexBuffer.CleanupResources(m_allocator);
+        m_globalIndexAndVertexBuffer.indexBuffer.CleanupResources(m_allocator);
 
         m_mainMaterialData.CleanupResources(m_device);
 
@@ -594,12 +610,49 @@ namespace BlitzenVulkan
 
     void AllocatedImage::CleanupResources(const VkDevice& device, const VmaAllocator& allocator)
     {
+        TrackGpuFree(allocator, allocation);
         vmaDestroyImage(allocator, image, allocation);
         vkDestroyImageView(device, imageView, nullptr);
     }
 
+    void AllocatedBuffer::CleanupResources(const VmaAllocator& allocator)
+    {
+        TrackGpuFree(allocator, allocation);
+        vmaDestroyBuffer(allocator, buffer, allocation);
+    }
+
+    void TrackGpuAllocation(const VmaAllocator& allocator, VmaAllocation allocation)
+    {
+        if(allocation == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        VmaAllocationInfo info;
+        vmaGetAllocationInfo(allocator, allocation, &info);
+        if(uintptr_t category = reinterpret_cast<uintptr_t>(info.pUserData))
+        {
+            BlitzenCore::GpuMemoryTrackAllocation(static_cast<BlitzenCore::GpuMemoryCategory>(category - 1), static_cast<size_t>(info.size));
+        }
+    }
+
+    void TrackGpuFree(const VmaAllocator& allocator, VmaAllocation allocation)
+    {
+        if(allocation == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        VmaAllocationInfo info;
+        vmaGetAllocationInfo(allocator, allocation, &info);
+        if(uintptr_t category = reinterpret_cast<uintptr_t>(info.pUserData))
+        {
+            BlitzenCore::GpuMemoryTrackFree(static_cast<BlitzenCore::GpuMemoryCategory>(category - 1), static_cast<size_t>(info.size));
+        }
+    }
+
     void VulkanRenderer::CleanupFrameTools()
     {
+        m_gpuProfiler.Cleanup(m_device);
+
         for(size_t i = 0; i < m_frameTools.size(); ++i)
         {
             vkDestroyCommandPool(m_device, m_frameTools[i].graphicsCommandPool, nullptr);
@@ -608,17 +661,12 @@ namespace BlitzenVulkan
             vkDestroySemaphore(m_device, m_frameTools[i].imageAcquiredSemaphore, nullptr);
             vkDestroySemaphore(m_device, m_frameTools[i].readyToPresentSemaphore, nullptr);
 
-            //#ifndef NDEBUG
-                vkDestroyQueryPool(m_device, m_frameTools[i].timestampQueryPool, nullptr);
-            //#endif
-
             m_frameTools[i].sceneDataDescriptroAllocator.CleanupResources();
-            vmaDestroyBuffer(m_allocator, m_frameTools[i].sceneDataUniformBuffer.buffer, 
-            m_frameTools[i].sceneDataUniformBuffer.allocation);
+            m_frameTools[i].sceneDataUniformBuffer.CleanupResources(m_allocator);
 
             #if BLITZEN_START_VULKAN_WITH_INDIRECT
-                vmaDestroyBuffer(m_allocator, m_frameTools[i].indirectFrustumDataUniformBuffer.buffer, 
-            m_frameTools[i].indirectFrustumDataUniformBuffer.allocation);
+                m_frameTools[i].indirectFrustumDataUniformBuffer.CleanupResources(m_allocator);
+                m_frameTools[i].objectUploadStagingBuffer.CleanupResources(m_allocator);
             #endif
         }
     }
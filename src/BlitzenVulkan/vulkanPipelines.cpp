@@ -1,7 +1,54 @@
+#define BLIT_LOG_CHANNEL    Vulkan
+
 #include "vulkanPipelines.h"
+#include "Platform/blitAsyncIO.h"
+#include "Platform/blitPlatform.h"
+
+#include <mutex>
 
 namespace BlitzenVulkan
 {
+    // SPIR-V read ahead of pipeline creation, by file path
+    static std::unordered_map<std::string, std::vector<char>> shaderCodeCache;
+    static std::mutex shaderCodeCacheMutex;
+
+    uint8_t PreloadShaderCode(const char* const* ppFilepaths, uint32_t count)
+    {
+        std::vector<BlitzenPlatform::IoReadRequest> reads(count);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            reads[i].filepath = ppFilepaths[i];
+            reads[i].priority = BlitzenPlatform::IoPriority::High;
+        }
+        std::vector<BlitzenPlatform::IoHandle> handles(count);
+        BlitzenPlatform::AsyncIoSubmitReads(reads.data(), count, handles.data());
+
+        uint8_t bRead = 1;
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            void* pData;
+            uint64_t size;
+            if(BlitzenPlatform::AsyncIoTakeOrRead(handles[i], reads[i], pData, size) != BlitzenPlatform::IoStatus::Complete)
+            {
+                BLIT_ERROR("Failed to read shader %s", ppFilepaths[i])
+                bRead = 0;
+                continue;
+            }
+
+            std::vector<char> code(reinterpret_cast<char*>(pData), reinterpret_cast<char*>(pData) + size);
+            BlitzenPlatform::PlatformFree(pData, 0);
+            std::lock_guard<std::mutex> lock(shaderCodeCacheMutex);
+            shaderCodeCache[ppFilepaths[i]] = std::move(code);
+        }
+        return bRead;
+    }
+
+    void ClearShaderCodeCache()
+    {
+        std::lock_guard<std::mutex> lock(shaderCodeCacheMutex);
+        shaderCodeCache.clear();
+    }
+
     void GraphicsPipelineBuilder::Init(const VkDevice* pDevice, VkPipelineLayout* pLayout, VkPipeline* pPipeline)
     {
         m_pDevice = pDevice; 
@@ -21,19 +68,35 @@ namespace BlitzenVulkan
     void CreateShaderProgram(const VkDevice& device, const char* filepath, VkShaderStageFlagBits shaderStage, const char* entryPointName, 
     VkShaderModule& shaderModule, VkPipelineShaderStageCreateInfo& pipelineShaderStage, std::vector<char>& shaderCode)
     {
-        std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-        //If the file did not open, something might be wrong with the filepath, so it needs to be checked
-        if (!file.is_open())
+        // The same file can be used by more than one pipeline, so the cached code is copied
+        uint8_t bPreloaded = 0;
+        {
+            std::lock_guard<std::mutex> lock(shaderCodeCacheMutex);
+            auto cached = shaderCodeCache.find(filepath);
+            if(cached != shaderCodeCache.end())
+            {
+                shaderCode = cached->second;
+                bPreloaded = 1;
+            }
+        }
+
+        if(!bPreloaded)
         {
-        	__debugbreak();
+            std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+            //If the file did not open, something might be wrong with the filepath, so it needs to be checked
+            if (!file.is_open())
+            {
+                BLIT_ERROR("Failed to open shader %s", filepath)
+                BDB_BREAK
+            }
+            size_t filesize = static_cast<size_t>(file.tellg());
+            shaderCode.resize(filesize);
+            //put the file cursor at the beginning
+            file.seekg(0);
+            // load the entire file into the array
+            file.read(shaderCode.data(), filesize);
+            file.close();
         }
-        size_t filesize = static_cast<size_t>(file.tellg());
-        shaderCode.resize(filesize);
-        //put the file cursor at the beginning
-        file.seekg(0);
-        // load the entire file into the array
-        file.read(shaderCode.data(), filesize);
-        file.close();
 
         //Wrap the code in a shader module object
         VkShaderModuleCreateInfo shaderModuleInfo{};
@@ -72,7 +72,13 @@ namespace BlitzenVulkan
         VkPipelineDynamicStateCreateInfo m_dynamicState{};
     };
 
+    // Reads the files through the async I/O service, so that pipeline creation does not wait for the disk. Returns 0 if any read failed
+    uint8_t PreloadShaderCode(const char* const* ppFilepaths, uint32_t count);
+    // Frees the preloaded code once every pipeline has been created
+    void ClearShaderCodeCache();
+
     //Helper function that compiles spir-v and adds it to shader stage. Will aid in the creation of graphics and compute pipelines
+    //Takes the code from the preloaded files when the file was preloaded
     void CreateShaderProgram(const VkDevice& device, const char* filepath, VkShaderStageFlagBits shaderStage, const char* entryPointName, 
     VkShaderModule& shaderModule, VkPipelineShaderStageCreateInfo& pipelineShaderStage, std::vector<char>& shaderCode);
 
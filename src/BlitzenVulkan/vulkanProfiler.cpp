@@ -0,0 +1,186 @@
+#define BLIT_LOG_CHANNEL    Vulkan
+
+#include "vulkanProfiler.h"
+#include "Core/blitProfiler.h"
+#include "Core/blitFrameStats.h"
+
+namespace BlitzenVulkan
+{
+    uint8_t GpuProfiler::Init(VkDevice device, VkPhysicalDevice gpu, uint32_t graphicsQueueFamilyIndex)
+    {
+        #if BLITZEN_VULKAN_GPU_PROFILER
+            // The period never changes, so it is only asked for once
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(gpu, &props);
+            m_timestampPeriod = static_cast<double>(props.limits.timestampPeriod);
+
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, queueFamilies.data());
+            uint32_t validBits = graphicsQueueFamilyIndex < queueFamilyCount ? queueFamilies[graphicsQueueFamilyIndex].timestampValidBits : 0;
+
+            if(!validBits || m_timestampPeriod <= 0.0)
+            {
+                BLIT_WARN("The graphics queue does not support timestamps, GPU profiling is disabled")
+                return 0;
+            }
+            m_timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = BLITZEN_VULKAN_GPU_PROFILER_MAX_SCOPES * 2;
+            for(GpuProfilerFrame& frame : m_frames)
+            {
+                if(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+                {
+                    BLIT_ERROR("Failed to create a timestamp query pool, GPU profiling is disabled")
+                    Cleanup(device);
+                    return 0;
+                }
+                // Pools start with undefined queries
+                vkResetQueryPool(device, frame.queryPool, 0, queryPoolInfo.queryCount);
+            }
+
+            m_bTraceTrack = BlitzenCore::ProfilerCreateTrack("GPU", m_traceTrack);
+            m_bEnabled = 1;
+            return 1;
+        #else
+            return 0;
+        #endif
+    }
+
+    void GpuProfiler::Cleanup(VkDevice device)
+    {
+        for(GpuProfilerFrame& frame : m_frames)
+        {
+            if(frame.queryPool != VK_NULL_HANDLE)
+            {
+                vkDestroyQueryPool(device, frame.queryPool, nullptr);
+                frame.queryPool = VK_NULL_HANDLE;
+            }
+        }
+
+        if(m_droppedFrames)
+        {
+            BLIT_INFO("%llu GPU profiler frames were dropped because their results were not ready",
+            static_cast<unsigned long long>(m_droppedFrames))
+        }
+        m_bEnabled = 0;
+    }
+
+    void GpuProfiler::BeginFrame(VkDevice device, VkCommandBuffer commandBuffer)
+    {
+        if(!m_bEnabled)
+        {
+            return;
+        }
+
+        m_currentFrame = (m_currentFrame + 1) % BLITZEN_VULKAN_GPU_PROFILER_LATENCY;
+        GpuProfilerFrame& frame = m_frames[m_currentFrame];
+        if(frame.bSubmitted)
+        {
+            ReadFrameResults(device, frame);
+        }
+
+        // The frame that last used the pool is done, so it can be reset from the host
+        vkResetQueryPool(device, frame.queryPool, 0, BLITZEN_VULKAN_GPU_PROFILER_MAX_SCOPES * 2);
+        frame.scopeCount = 0;
+        frame.bSubmitted = 0;
+
+        BeginScope(commandBuffer, "GPU frame");
+    }
+
+    void GpuProfiler::EndFrame(VkCommandBuffer commandBuffer)
+    {
+        if(!m_bEnabled)
+        {
+            return;
+        }
+
+        GpuProfilerFrame& frame = m_frames[m_currentFrame];
+        EndScope(commandBuffer, 0);
+        frame.submitTime = BlitzenCore::ProfilerGetTime();
+        frame.bSubmitted = 1;
+    }
+
+    uint32_t GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name)
+    {
+        GpuProfilerFrame& frame = m_frames[m_currentFrame];
+        if(!m_bEnabled || frame.scopeCount >= BLITZEN_VULKAN_GPU_PROFILER_MAX_SCOPES)
+        {
+            return BLITZEN_VULKAN_GPU_PROFILER_INVALID_SCOPE;
+        }
+
+        uint32_t scope = frame.scopeCount++;
+        frame.scopeNames[scope] = name;
+        // Waits for the commands before it to finish, so that the scope does not include them
+        vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, frame.queryPool, scope * 2);
+        return scope;
+    }
+
+    void GpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scope)
+    {
+        if(!m_bEnabled || scope == BLITZEN_VULKAN_GPU_PROFILER_INVALID_SCOPE)
+        {
+            return;
+        }
+
+        vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_frames[m_currentFrame].queryPool, scope * 2 + 1);
+    }
+
+    void GpuProfiler::ReadFrameResults(VkDevice device, GpuProfilerFrame& frame)
+    {
+        // Each query is followed by its availability, so that a scope that was never ended does not stall or poison the frame
+        uint64_t results[BLITZEN_VULKAN_GPU_PROFILER_MAX_SCOPES * 2 * 2];
+        uint32_t queryCount = frame.scopeCount * 2;
+        VkResult res = vkGetQueryPoolResults(device, frame.queryPool, 0, queryCount, sizeof(uint64_t) * 2 * queryCount, results,
+        sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if(res != VK_SUCCESS && res != VK_NOT_READY)
+        {
+            ++m_droppedFrames;
+            return;
+        }
+
+        // The whole frame's scope is needed to place the others
+        if(!results[1] || !results[3])
+        {
+            ++m_droppedFrames;
+            return;
+        }
+        uint64_t frameStart = results[0] & m_timestampMask;
+        double microsecondsPerTick = m_timestampPeriod / 1000.0;
+
+        // There is no shared clock with the CPU, so the frame is assumed to start executing when it was submitted,
+        // or when the previous frame ended if the GPU was still busy with it
+        double traceStart = frame.submitTime > m_lastTraceEnd ? frame.submitTime : m_lastTraceEnd;
+
+        for(uint32_t scope = 0; scope < frame.scopeCount; ++scope)
+        {
+            const uint64_t* pBegin = results + scope * 4;
+            const uint64_t* pEnd = pBegin + 2;
+            if(!pBegin[1] || !pEnd[1])
+            {
+                continue;
+            }
+
+            // Masked subtraction, in case the counter wrapped during the frame
+            uint64_t startTicks = ((pBegin[0] & m_timestampMask) - frameStart) & m_timestampMask;
+            uint64_t durationTicks = ((pEnd[0] & m_timestampMask) - (pBegin[0] & m_timestampMask)) & m_timestampMask;
+            double duration = static_cast<double>(durationTicks) * microsecondsPerTick;
+
+            if(scope == 0)
+            {
+                BlitzenCore::FrameStatsRecord(BlitzenCore::FrameStatType::GpuFrame, duration / 1000.0);
+                m_lastTraceEnd = traceStart + duration;
+            }
+
+            if(m_bTraceTrack)
+            {
+                BlitzenCore::ProfilerRecordTrackZone(m_traceTrack, frame.scopeNames[scope], traceStart + static_cast<double>(startTicks) * microsecondsPerTick,
+                duration);
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "vulkanData.h"
+
+// When this is 0, no queries are created or written and the scopes do nothing
+#define BLITZEN_VULKAN_GPU_PROFILER                 1
+// Scopes that can be opened in one frame, including the one that the profiler opens around the whole frame
+#define BLITZEN_VULKAN_GPU_PROFILER_MAX_SCOPES      32
+// A frame's timestamps are read this many frames after it was recorded. Must be at least BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT,
+// so that the frame has always completed by then and reading it never waits for the GPU
+#define BLITZEN_VULKAN_GPU_PROFILER_LATENCY         3
+
+namespace BlitzenVulkan
+{
+    // Marks the scope that could not be opened because the frame had no more room
+    #define BLITZEN_VULKAN_GPU_PROFILER_INVALID_SCOPE   UINT32_MAX
+
+    struct GpuProfilerFrame
+    {
+        // 2 queries for each scope, the begin timestamp followed by the end timestamp
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        const char* scopeNames[BLITZEN_VULKAN_GPU_PROFILER_MAX_SCOPES];
+        uint32_t scopeCount = 0;
+
+        // Profiler time (in microseconds) when the frame was submitted. The GPU timestamps are placed relative to it in the trace
+        double submitTime = 0.0;
+        uint8_t bSubmitted = 0;
+    };
+
+    // Measures named regions of a frame's command buffer with timestamp queries. Each frame's results are read back
+    // BLITZEN_VULKAN_GPU_PROFILER_LATENCY frames later and go to the frame statistics and to the "GPU" track of the CPU profiler's trace
+    class GpuProfiler
+    {
+    public:
+
+        // Returns 0 if the device cannot write timestamps on the graphics queue, in which case all other functions do nothing
+        uint8_t Init(VkDevice device, VkPhysicalDevice gpu, uint32_t graphicsQueueFamilyIndex);
+
+        void Cleanup(VkDevice device);
+
+        // Moves to the next frame, reading the results of the frame that used it before, and opens the scope around the whole frame.
+        // The command buffer should have just started recording
+        void BeginFrame(VkDevice device, VkCommandBuffer commandBuffer);
+        // Closes the frame's scope. Should be called right before the command buffer stops recording and is submitted
+        void EndFrame(VkCommandBuffer commandBuffer);
+
+        // The name must outlive the profiler, string literals are expected
+        uint32_t BeginScope(VkCommandBuffer commandBuffer, const char* name);
+        void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+    private:
+
+        void ReadFrameResults(VkDevice device, GpuProfilerFrame& frame);
+
+    private:
+
+        GpuProfilerFrame m_frames[BLITZEN_VULKAN_GPU_PROFILER_LATENCY];
+        uint32_t m_currentFrame = 0;
+
+        // Nanoseconds per timestamp tick, taken from the device limits at init
+        double m_timestampPeriod = 0.0;
+        // Timestamps only have this many valid bits on the graphics queue
+        uint64_t m_timestampMask = 0;
+
+        uint32_t m_traceTrack = 0;
+        // Where the last frame ended in the trace, frames are kept from overlapping
+        double m_lastTraceEnd = 0.0;
+        uint8_t m_bTraceTrack = 0;
+
+        uint8_t m_bEnabled = 0;
+
+        // Frames whose results were not available when they were read
+        uint64_t m_droppedFrames = 0;
+    };
+}
@@ -1,4 +1,13 @@
+#define BLIT_LOG_CHANNEL    Vulkan
+
 #include "vulkanRenderer.h"
+#include "Core/blitProfiler.h"
+#include "Core/blitFrameStats.h"
+#include "Core/blitFlightRecorder.h"
+#include "Core/blitParallel.h"
+#include "Platform/blitPlatform.h"
+
+#include <algorithm>
 
 #define VMA_IMPLEMENTATION
 #include "vma/vk_mem_alloc.h"
@@ -39,18 +48,18 @@ namespace BlitzenVulkan
         vkAllocateCommandBuffers(m_device, &commandBufferInfo, &m_commands.commandBuffer);
     }
 
-    void VulkanRenderer::UploadDataToGPU()
+    void VulkanRenderer::UploadDataToGPU(const BlitzenCore::SceneManifest& manifest)
     {
         //Setup rendering attachments(depth and color image)
         AllocateImage(m_drawingAttachment, 
-        VkExtent3D{static_cast<uint32_t>(*m_pWindowWidth), static_cast<uint32_t>(*m_pWindowHeight), 1}, 
+        VkExtent3D{m_windowWidth, m_windowHeight, 1}, 
         VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | 
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT, BlitzenCore::GpuMemoryCategory::RenderTargets);
         AllocateImage(m_depthAttachment, 
-        VkExtent3D{static_cast<uint32_t>(*m_pWindowWidth), static_cast<uint32_t>(*m_pWindowHeight), 1}, 
-        VK_FORMAT_D32_SFLOAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
-        m_drawExtent.width = *m_pWindowWidth;
-        m_drawExtent.height = *m_pWindowHeight;
+        VkExtent3D{m_windowWidth, m_windowHeight, 1}, 
+        VK_FORMAT_D32_SFLOAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, BlitzenCore::GpuMemoryCategory::RenderTargets);
+        m_drawExtent.width = m_windowWidth;
+        m_drawExtent.height = m_windowHeight;
 
         InitPlaceholderTextures();
 
@@ -64,31 +73,31 @@ namespace BlitzenVulkan
         std::vector<MaterialConstants> materialConstants;
         //Temporarily holds all material resources, once every scene and asset is loaded, it will all written to two uniform buffer arrays
         std::vector<MaterialResources> materialResources;
-        std::string testScene = "Assets/structure.glb";
-        std::string testScene2 = "Assets/Highpoly.glb";
-        LoadScene(testScene, "structure", vertices, indices, materialConstants, materialResources);
-        LoadScene(testScene2, "city", vertices, indices, materialConstants, materialResources);
-        //Update every node in the scene to be included in the draw context
-        m_scenes["structure"].AddToDrawContext(glm::mat4(1.f), m_mainDrawContext);
-        m_scenes["city"].AddToDrawContext(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0)), m_mainDrawContext);
-        #ifdef NDEBUG
-        float iter = 1;
-        for (float f = 0.f; f < 100.f; f += 1.f)
+        for(ParsedScene& parsedScene : m_parsedScenes)
         {
-            iter *= -1;
-            m_scenes["city"].AddToDrawContext(glm::translate(glm::mat4(1.f), glm::vec3(-iter, iter, -f)), m_mainDrawContext);
+            LoadScene(parsedScene, vertices, indices, materialConstants, materialResources);
         }
-        for (float f = 0.f; f < 100.f; f += 1.f)
+        m_parsedScenes.clear();
+        // Scenes that were not loaded stay null, instead of being added to the map empty
+        m_manifestScenes.resize(manifest.scenes.size());
+        for(size_t i = 0; i < manifest.scenes.size(); ++i)
         {
-            iter *= -1;
-            m_scenes["city"].AddToDrawContext(glm::translate(glm::mat4(1.f), glm::vec3(iter, f, -iter)), m_mainDrawContext);
+            auto found = m_scenes.find(manifest.scenes[i].name);
+            m_manifestScenes[i] = found != m_scenes.end() ? &found->second : nullptr;
         }
-        for (float f = 0.f; f < 100.f; f += 1.f)
+        //Update every node in the scene to be included in the draw context
+        for(const BlitzenCore::ManifestInstance& instance : manifest.instances)
         {
-            iter *= -1;
-            m_scenes["city"].AddToDrawContext(glm::translate(glm::mat4(1.f), glm::vec3(f, -iter, iter)), m_mainDrawContext);
+            LoadedScene* pScene = m_manifestScenes[instance.scene];
+            if(!pScene)
+            {
+                BLIT_LOG(Loader, Warn, "Scene %s was not loaded, its instance is left out", manifest.scenes[instance.scene].name.c_str())
+                continue;
+            }
+            pScene->m_instances.push_back(static_cast<uint32_t>(m_sceneInstances.size()));
+            m_sceneInstances.push_back({pScene, instance.transform, static_cast<uint32_t>(m_mainDrawContext.opaqueRenderObjects.size())});
+            pScene->AddToDrawContext(instance.transform, m_mainDrawContext);
         }
-        #endif
 
         #if BLITZEN_START_VULKAN_WITH_INDIRECT
             InitComputePipelines();
@@ -108,6 +117,235 @@ namespace BlitzenVulkan
         #endif
         //Write all material resources to the global descriptor set
         UploadMaterialResourcesToGPU(materialResources);
+
+        // Every pipeline has been created
+        ClearShaderCodeCache();
+    }
+
+    // Decodes an image of the asset to RGBA8 (uses stbi image). Images in their own files come from the read with the given handle
+    static void DecodeGltfImage(fastgltf::Asset& gltfAsset, fastgltf::Image& gltfImage, BlitzenPlatform::IoHandle fileRead, 
+    DecodedImage& decoded)
+    {
+        int width = 0; 
+        int height = 0;
+        int nrChannels;
+        stbi_uc* data = nullptr;
+
+        std::visit(
+            fastgltf::visitor {
+                [](auto& arg) {},
+                [&](fastgltf::sources::URI& filePath) {
+                    assert(filePath.fileByteOffset == 0); 
+                    assert(filePath.uri.isLocalPath());                                                         
+                    // Read here if the batch had no room for it
+                    std::string imagePath(filePath.uri.path());
+                    BlitzenPlatform::IoReadRequest request;
+                    request.filepath = imagePath.c_str();
+                    void* pFileData;
+                    uint64_t fileSize;
+                    if (BlitzenPlatform::AsyncIoTakeOrRead(fileRead, request, pFileData, fileSize) != BlitzenPlatform::IoStatus::Complete) {
+                        BLIT_LOG(Loader, Error, "Failed to read image %s", imagePath.c_str())
+                        return;
+                    }
+                    data = stbi_load_from_memory(reinterpret_cast<stbi_uc*>(pFileData), static_cast<int>(fileSize),
+                        &width, &height, &nrChannels, 4);
+                    BlitzenPlatform::PlatformFree(pFileData, 0);
+                },
+                [&](fastgltf::sources::Vector& vector) {
+                    data = stbi_load_from_memory(vector.bytes.data(), static_cast<int>(vector.bytes.size()),
+                        &width, &height, &nrChannels, 4);
+                },
+                [&](fastgltf::sources::BufferView& view) {
+                    auto& bufferView = gltfAsset.bufferViews[view.bufferViewIndex];
+                    auto& buffer = gltfAsset.buffers[bufferView.bufferIndex];
+
+                    std::visit(fastgltf::visitor { 
+                                   [](auto& arg) {},
+                                   [&](fastgltf::sources::Vector& vector) {
+                                       data = stbi_load_from_memory(vector.bytes.data() + bufferView.byteOffset,
+                                           static_cast<int>(bufferView.byteLength),
+                                           &width, &height, &nrChannels, 4);
+                                   } },
+                        buffer.data);
+                },
+            },
+            gltfImage.data);
+
+        decoded.pPixels = data;
+        decoded.width = static_cast<uint32_t>(width);
+        decoded.height = static_cast<uint32_t>(height);
+    }
+
+    // Parses the file that the read brought in and decodes every image of the asset
+    static void ParseScene(ParsedScene& parsedScene, BlitzenPlatform::IoHandle fileRead)
+    {
+        BLIT_PROFILE_SCOPE("ParseScene")
+        const std::string& filepath = parsedScene.filepath;
+        BLIT_LOG(Loader, Info, "Loading GLTF: %s", filepath.c_str())
+
+        fastgltf::Parser parser {};
+
+        constexpr auto gltfOptions = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble 
+        | fastgltf::Options::LoadGLBBuffers | fastgltf::Options::LoadExternalBuffers;
+        // fastgltf::Options::LoadExternalImages;
+
+        BlitzenPlatform::IoReadRequest request;
+        request.filepath = filepath.c_str();
+        request.padding = fastgltf::getGltfBufferPadding();
+        void* pFileData;
+        uint64_t fileSize;
+        if(BlitzenPlatform::AsyncIoTakeOrRead(fileRead, request, pFileData, fileSize) != BlitzenPlatform::IoStatus::Complete)
+        {
+            BLIT_LOG(Loader, Error, "Failed to read %s, GLTF loading abandoned", filepath.c_str())
+            return;
+        }
+
+        BLIT_LOG(Loader, Trace, "%s: read %i bytes", filepath.c_str(), static_cast<uint32_t>(fileSize))
+
+        // The read left room for the parser's padding, so the file is parsed where it was read
+        fastgltf::GltfDataBuffer data;
+        if(!data.fromByteView(reinterpret_cast<uint8_t*>(pFileData), static_cast<size_t>(fileSize), 
+        static_cast<size_t>(fileSize) + fastgltf::getGltfBufferPadding()))
+        {
+            BLIT_LOG(Loader, Error, "%s is empty, GLTF loading abandoned", filepath.c_str())
+            BlitzenPlatform::PlatformFree(pFileData, 0);
+            return;
+        }
+
+        fastgltf::Asset& gltf = parsedScene.asset;
+
+        std::filesystem::path path = filepath;
+
+        auto type = fastgltf::determineGltfFileType(&data);
+        if (type == fastgltf::GltfType::glTF) 
+        {
+            auto load = parser.loadGLTF(&data, path.parent_path(), gltfOptions);
+            if (load) 
+            {
+                gltf = std::move(load.get());
+                parsedScene.bParsed = 1;
+            } 
+            else 
+            {
+                BLIT_LOG(Loader, Error, "Failed to load glTF: %i", fastgltf::to_underlying(load.error()))
+            }
+        } 
+        else if (type == fastgltf::GltfType::GLB) 
+        {
+            auto load = parser.loadBinaryGLTF(&data, path.parent_path(), gltfOptions);
+            if (load) 
+            {
+                gltf = std::move(load.get());
+                parsedScene.bParsed = 1;
+            } 
+            else 
+            {
+                BLIT_LOG(Loader, Error, "Failed to load glTF: %i", fastgltf::to_underlying(load.error()))
+            }
+        } 
+        else 
+        {
+            BLIT_LOG(Loader, Error, "Failed to determine glTF container")
+        }
+
+        // The asset keeps copies of the buffers that it needs
+        BlitzenPlatform::PlatformFree(pFileData, 0);
+        if(!parsedScene.bParsed)
+        {
+            return;
+        }
+
+        // Images in their own files are all read in one batch and each one is decoded as soon as its read is done. Reads that did not
+        // fit in the free slots are done by the decoding job itself
+        std::vector<std::string> imagePaths;
+        std::vector<size_t> imageReadIndices;
+        for(size_t i = 0; i < gltf.images.size(); ++i)
+        {
+            fastgltf::sources::URI* pUri = std::get_if<fastgltf::sources::URI>(&gltf.images[i].data);
+            if(pUri && pUri->uri.isLocalPath())
+            {
+                imagePaths.emplace_back(pUri->uri.path());
+                imageReadIndices.push_back(i);
+            }
+        }
+        std::vector<BlitzenPlatform::IoReadRequest> imageReads(imagePaths.size());
+        for(size_t r = 0; r < imagePaths.size(); ++r)
+        {
+            imageReads[r].filepath = imagePaths[r].c_str();
+        }
+        std::vector<BlitzenPlatform::IoHandle> imageReadHandles(gltf.images.size());
+        if(imageReads.size())
+        {
+            std::vector<BlitzenPlatform::IoHandle> batchHandles(imageReads.size());
+            BlitzenPlatform::AsyncIoSubmitReads(imageReads.data(), static_cast<uint32_t>(imageReads.size()), batchHandles.data());
+            for(size_t r = 0; r < imageReads.size(); ++r)
+            {
+                imageReadHandles[imageReadIndices[r]] = batchHandles[r];
+            }
+        }
+
+        // Each image decodes on its own, so they are spread between the job threads
+        parsedScene.images.resize(gltf.images.size());
+        BlitzenCore::ParallelFor(gltf.images.size(), 1, [&](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; ++i)
+            {
+                DecodeGltfImage(gltf, gltf.images[i], imageReadHandles[i], parsedScene.images[i]);
+            }
+        });
+    }
+
+    uint8_t VulkanRenderer::ParseScenes(const BlitzenCore::SceneManifest& manifest)
+    {
+        m_parsedScenes.clear();
+        m_parsedScenes.resize(manifest.scenes.size());
+
+        // Every scene file is read in one batch, so the later ones come off the disk while the first ones are parsed
+        std::vector<BlitzenPlatform::IoReadRequest> sceneReads(manifest.scenes.size());
+        for(size_t i = 0; i < manifest.scenes.size(); ++i)
+        {
+            m_parsedScenes[i].name = manifest.scenes[i].name;
+            m_parsedScenes[i].filepath = manifest.scenes[i].filepath;
+            sceneReads[i].filepath = m_parsedScenes[i].filepath.c_str();
+            sceneReads[i].padding = fastgltf::getGltfBufferPadding();
+            sceneReads[i].priority = BlitzenPlatform::IoPriority::High;
+        }
+        std::vector<BlitzenPlatform::IoHandle> sceneReadHandles(sceneReads.size());
+        BlitzenPlatform::AsyncIoSubmitReads(sceneReads.data(), static_cast<uint32_t>(sceneReads.size()), sceneReadHandles.data());
+
+        BlitzenCore::ParallelFor(m_parsedScenes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; ++i)
+            {
+                ParseScene(m_parsedScenes[i], sceneReadHandles[i]);
+            }
+        });
+
+        // A scene that could not be parsed fails the startup task, so that the upload that needs it is skipped and reported
+        uint8_t bParsed = 1;
+        for(const ParsedScene& scene : m_parsedScenes)
+        {
+            if(!scene.bParsed)
+            {
+                BLIT_LOG(Loader, Error, "Scene %s could not be parsed from %s", scene.name.c_str(), scene.filepath.c_str())
+                bParsed = 0;
+            }
+        }
+        return bParsed;
+    }
+
+    uint8_t VulkanRenderer::ReadShaders()
+    {
+        const char* shaderFilepaths[] = 
+        {
+            "VulkanShaders/MainGeometryShader.vert.glsl.spv",
+            "VulkanShaders/MainGeometryShader.frag.glsl.spv",
+            #if BLITZEN_START_VULKAN_WITH_INDIRECT
+                "VulkanShaders/IndirectCulling.comp.glsl.spv",
+                "VulkanShaders/IndirectDrawShader.vert.glsl.spv",
+            #endif
+        };
+        return PreloadShaderCode(shaderFilepaths, static_cast<uint32_t>(sizeof(shaderFilepaths) / sizeof(shaderFilepaths[0])));
     }
 
     void VulkanRenderer::StartRecordingCommands()
@@ -196,7 +434,7 @@ namespace BlitzenVulkan
         //At this point, if the allocation does not succeed, something is wrong and the application should stop
         if(allocationResult != VK_SUCCESS)
         {
-            __debugbreak();
+            BDB_BREAK
         }
     }
 
@@ -238,13 +476,6 @@ namespace BlitzenVulkan
         VkSemaphoreCreateInfo semaphoreInfo{};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        //#ifndef NDEBUG
-            VkQueryPoolCreateInfo queryPoolInfo{};
-            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-            queryPoolInfo.queryCount = 2;
-            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
-        //#endif
-
         for(size_t i = 0; i < m_frameTools.size(); ++i)
         {
             vkCreateCommandPool(m_device, &commandPoolsInfo, nullptr, &(m_frameTools[i].graphicsCommandPool));
@@ -256,10 +487,6 @@ namespace BlitzenVulkan
             vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &(m_frameTools[i].imageAcquiredSemaphore));
             vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &(m_frameTools[i].readyToPresentSemaphore));
 
-            //#ifndef NDEBUG
-                vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &(m_frameTools[i].timestampQueryPool));
-            //#endif
-
             VkDescriptorPoolSize sceneDataDescriptorPoolSize{};
             #if BLITZEN_START_VULKAN_WITH_INDIRECT
                 sceneDataDescriptorPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -270,17 +497,24 @@ namespace BlitzenVulkan
             #endif
             m_frameTools[i].sceneDataDescriptroAllocator.Init(&m_device);
             AllocateBuffer(m_frameTools[i].sceneDataUniformBuffer, sizeof(SceneData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-            VMA_MEMORY_USAGE_CPU_TO_GPU);
+            VMA_MEMORY_USAGE_CPU_TO_GPU, BlitzenCore::GpuMemoryCategory::PerFrame);
             //The indirect version of Vulkan does frustum culling in the compute shader and needs the frustum data to be passed
             #if BLITZEN_START_VULKAN_WITH_INDIRECT
                 AllocateBuffer(m_frameTools[i].indirectFrustumDataUniformBuffer, sizeof(glm::vec4) * 6, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                VMA_MEMORY_USAGE_CPU_TO_GPU);
+                VMA_MEMORY_USAGE_CPU_TO_GPU, BlitzenCore::GpuMemoryCategory::PerFrame);
+                AllocateBuffer(m_frameTools[i].objectUploadStagingBuffer, sizeof(IndirectRenderObject) * BLITZEN_VULKAN_MAX_OBJECT_UPLOADS, 
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, BlitzenCore::GpuMemoryCategory::PerFrame);
             #endif
         }
+
+        // The profiler keeps its own query pools, since its frames are read back later than the frame tools are reused
+        static_assert(BLITZEN_VULKAN_GPU_PROFILER_LATENCY >= BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT, 
+        "GPU profiler results would be read before their frame is guaranteed to be complete");
+        m_gpuProfiler.Init(m_device, m_bootstrapObjects.chosenGPU, m_queues.graphicsIndex);
     }
 
     void VulkanRenderer::AllocateImage(AllocatedImage& imageToAllocate, VkExtent3D extent, VkFormat format, VkImageUsageFlags usage,
-    bool bMipMapped /* =false */)
+    BlitzenCore::GpuMemoryCategory category, bool bMipMapped /* =false */)
     {
         imageToAllocate.extent = extent;
         imageToAllocate.format = format;
@@ -304,9 +538,11 @@ namespace BlitzenVulkan
         VmaAllocationCreateInfo imageAllocationInfo{};
         imageAllocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
         imageAllocationInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        imageAllocationInfo.pUserData = GpuMemoryCategoryToUserData(category);
 
         vmaCreateImage(m_allocator, &imageToAllocateInfo, &imageAllocationInfo, &(imageToAllocate.image), &(imageToAllocate.allocation), 
         nullptr);
+        TrackGpuAllocation(m_allocator, imageToAllocate.allocation);
 
         VkImageViewCreateInfo imageViewInfo{};
         imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -329,13 +565,15 @@ namespace BlitzenVulkan
         //Create a buffer to use as a way to transfer the data to the image
         VkDeviceSize bufferSize = extent.width * extent.height * extent.depth * 4;
         AllocatedBuffer stagingBuffer;
-        AllocateBuffer(stagingBuffer, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+        AllocateBuffer(stagingBuffer, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, 
+        BlitzenCore::GpuMemoryCategory::Staging);
 
         //Pass the image data to the buffer
         memcpy(stagingBuffer.allocationInfo.pMappedData, dataToCopy, bufferSize);
+        BlitzenCore::MetricAdd(m_metrics.uploadedBytes, static_cast<int64_t>(bufferSize));
 
-        //Allocate the image with the original function
-        AllocateImage(imageToAllocate, extent, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, bMipMapped);
+        //Allocate the image with the original function, images that are created from data are always textures
+        AllocateImage(imageToAllocate, extent, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, BlitzenCore::GpuMemoryCategory::Textures, bMipMapped);
 
         StartRecordingCommands();
         //Transition the image to accept the transfer operation
@@ -368,11 +606,11 @@ namespace BlitzenVulkan
 
         SubmitCommands();
 
-        vmaDestroyBuffer(m_allocator, stagingBuffer.buffer, stagingBuffer.allocation);
+        stagingBuffer.CleanupResources(m_allocator);
     }
 
     void VulkanRenderer::AllocateBuffer(AllocatedBuffer& bufferToAllocate, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage, 
-    VmaMemoryUsage memoryUsage)
+    VmaMemoryUsage memoryUsage, BlitzenCore::GpuMemoryCategory category)
     {
         VkBufferCreateInfo bufferToAllocateInfo{};
         bufferToAllocateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -382,9 +620,39 @@ namespace BlitzenVulkan
         VmaAllocationCreateInfo allocationInfo{};
         allocationInfo.usage = memoryUsage;
         allocationInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        allocationInfo.pUserData = GpuMemoryCategoryToUserData(category);
 
         vmaCreateBuffer(m_allocator, &bufferToAllocateInfo, &allocationInfo, &bufferToAllocate.buffer, &bufferToAllocate.allocation, 
         &bufferToAllocate.allocationInfo);
+        TrackGpuAllocation(m_allocator, bufferToAllocate.allocation);
+    }
+
+    void VulkanRenderer::FillMemoryReport(BlitzenCore::MemoryReport& report)
+    {
+        const VkPhysicalDeviceMemoryProperties* pMemoryProperties = nullptr;
+        vmaGetMemoryProperties(m_allocator, &pMemoryProperties);
+        uint32_t heapCount = pMemoryProperties->memoryHeapCount < BLITZEN_MEMORY_REPORT_MAX_HEAPS ? 
+        pMemoryProperties->memoryHeapCount : BLITZEN_MEMORY_REPORT_MAX_HEAPS;
+
+        // Without VK_EXT_memory_budget the budgets are VMA's estimates from the heap sizes
+        VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(m_allocator, budgets);
+        // Walks every block, which is why memory is only reported every few seconds
+        VmaTotalStatistics statistics;
+        vmaCalculateStatistics(m_allocator, &statistics);
+
+        for(uint32_t i = 0; i < heapCount; ++i)
+        {
+            BlitzenCore::GpuHeapReport& heap = report.gpuHeaps[i];
+            heap.usage = budgets[i].usage;
+            heap.budget = budgets[i].budget;
+            heap.blockBytes = statistics.memoryHeap[i].statistics.blockBytes;
+            heap.allocationBytes = statistics.memoryHeap[i].statistics.allocationBytes;
+            heap.blockCount = statistics.memoryHeap[i].statistics.blockCount;
+            heap.allocationCount = statistics.memoryHeap[i].statistics.allocationCount;
+            heap.bDeviceLocal = (pMemoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        }
+        report.gpuHeapCount = heapCount;
     }
 
     void VulkanRenderer::TransitionImageLayout(const VkCommandBuffer& recordingCDB, VkImage& imageToTransition, VkImageLayout oldLayout, 
@@ -613,10 +881,13 @@ namespace BlitzenVulkan
     void VulkanRenderer::UploadGlobalBuffersToGPU(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, 
     std::vector<MaterialConstants>& materialConstants, std::vector<DrawIndirectData>& drawIndirectCommands)
     {
+        BLIT_PROFILE_SCOPE("UploadGlobalBuffersToGPU")
+
         //Allocates the vertex buffer as a storage buffer that can accept data transfers and can retrive a device address
         VkDeviceSize vertexBufferSize = static_cast<VkDeviceSize>(vertices.size() * sizeof(Vertex));
         AllocateBuffer(m_globalIndexAndVertexBuffer.vertexBuffer, vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | 
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY, 
+        BlitzenCore::GpuMemoryCategory::Geometry);
         //Retrieving the address of the vertex buffer so that it can be accessed in the shader
         VkBufferDeviceAddressInfo vertexBufferAddressInfo{};
         vertexBufferAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -626,12 +897,13 @@ namespace BlitzenVulkan
         //Allocates the index buffer as an index buffer that can accept data transfers
         VkDeviceSize indexBufferSize = static_cast<VkDeviceSize>(indices.size() * sizeof(uint32_t));
         AllocateBuffer(m_globalIndexAndVertexBuffer.indexBuffer, indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | 
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, BlitzenCore::GpuMemoryCategory::Geometry);
 
         //Allocates the buffer that will hold all the material constant data of the objects that have been loaded
         VkDeviceSize materialBufferSize = static_cast<VkDeviceSize>(materialConstants.size() * sizeof(MaterialConstants));
         AllocateBuffer(m_globalMaterialConstantsBuffer, materialBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | 
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY, 
+        BlitzenCore::GpuMemoryCategory::SceneData);
         //Store the address of the material buffer to the scene data so that it can be passed to the shaders every frame
         VkBufferDeviceAddressInfo materialBufferAddressInfo{};
         materialBufferAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -643,7 +915,7 @@ namespace BlitzenVulkan
             VkDeviceSize indirectBufferSize = sizeof(DrawIndirectData) * drawIndirectCommands.size();
             AllocateBuffer(m_drawIndirectDataBuffer, indirectBufferSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | 
             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
-            VMA_MEMORY_USAGE_GPU_ONLY);
+            VMA_MEMORY_USAGE_GPU_ONLY, BlitzenCore::GpuMemoryCategory::SceneData);
             //Store the device address of the indirect buffer, so that it can be passed to the shaders every frame
             VkBufferDeviceAddressInfo indirectBufferAddressInfo{};
             indirectBufferAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -652,7 +924,7 @@ namespace BlitzenVulkan
 
             AllocateBuffer(m_finalIndirectBuffer, indirectBufferSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
+            VMA_MEMORY_USAGE_GPU_ONLY, BlitzenCore::GpuMemoryCategory::SceneData);
             //Store the device address of the indirect buffer, so that it can be passed to the shaders every frame
             VkBufferDeviceAddressInfo finalIndirectAddressInfo{};
             finalIndirectAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -662,7 +934,8 @@ namespace BlitzenVulkan
             //Allocate the buffer that will hold the data used for frustum culling
             VkDeviceSize renderObjectBufferSize = sizeof(IndirectRenderObject) * m_mainDrawContext.renderObjects.size();
             AllocateBuffer(m_surfaceFrustumCollisionBuffer, renderObjectBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY, 
+            BlitzenCore::GpuMemoryCategory::SceneData);
             //Store the device address of the frustum culling buffer, so that it can be passed to the shaders every frame
             VkBufferDeviceAddressInfo renderObjectBufferAddressInfo{};
             renderObjectBufferAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -674,10 +947,10 @@ namespace BlitzenVulkan
         AllocatedBuffer stagingBuffer;
         #if BLITZEN_START_VULKAN_WITH_INDIRECT
             AllocateBuffer(stagingBuffer, vertexBufferSize + indexBufferSize + materialBufferSize + indirectBufferSize + renderObjectBufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, BlitzenCore::GpuMemoryCategory::Staging);
         #else
             AllocateBuffer(stagingBuffer, vertexBufferSize + indexBufferSize + materialBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VMA_MEMORY_USAGE_CPU_TO_GPU);
+            VMA_MEMORY_USAGE_CPU_TO_GPU, BlitzenCore::GpuMemoryCategory::Staging);
         #endif
         void* allBuffersData = stagingBuffer.allocation->GetMappedData();
         //Copy all the necessary data to the staging buffer at the right offsets
@@ -692,6 +965,7 @@ namespace BlitzenVulkan
             memcpy(reinterpret_cast<char*>(allBuffersData) + static_cast<size_t>(vertexBufferSize + indexBufferSize + materialBufferSize + 
             indirectBufferSize), m_mainDrawContext.renderObjects.data(), static_cast<size_t>(renderObjectBufferSize));
         #endif
+        BlitzenCore::MetricAdd(m_metrics.uploadedBytes, static_cast<int64_t>(stagingBuffer.allocationInfo.size));
 
         //Start recording commands for copying the staging buffer into the GPU buffers
         StartRecordingCommands();
@@ -780,7 +1054,7 @@ namespace BlitzenVulkan
 
         SubmitCommands();
 
-        vmaDestroyBuffer(m_allocator, stagingBuffer.buffer, stagingBuffer.allocation);
+        stagingBuffer.CleanupResources(m_allocator);
     }
 
     void VulkanRenderer::WriteMaterialData(MaterialInstance& materialInstance, MaterialPass pass)
@@ -826,65 +1100,20 @@ namespace BlitzenVulkan
         vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
     }
 
-    void VulkanRenderer::LoadScene(std::string& filepath, const char* sceneName, std::vector<Vertex>& vertices, 
+    void VulkanRenderer::LoadScene(ParsedScene& parsedScene, std::vector<Vertex>& vertices, 
     std::vector<uint32_t>& indices, std::vector<MaterialConstants>& materialConstants, std::vector<MaterialResources>& materialResources)
     {
-        BLIT_INFO("Loading GLTF: %s", filepath.c_str())
-
-        m_scenes[sceneName] = LoadedScene();
-        LoadedScene& scene = m_scenes[sceneName];
-        scene.m_pRenderer = this;
-
-        fastgltf::Parser parser {};
-
-        constexpr auto gltfOptions = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble 
-        | fastgltf::Options::LoadGLBBuffers | fastgltf::Options::LoadExternalBuffers;
-        // fastgltf::Options::LoadExternalImages;
-
-        fastgltf::GltfDataBuffer data;
-        if(!data.loadFromFile(filepath))
-        {
-            BLIT_ERROR("Failed to find filepath, GLTF loading abandoned")
-            return;
-        }
-
-        fastgltf::Asset gltf;
-
-        std::filesystem::path path = filepath;
-
-        auto type = fastgltf::determineGltfFileType(&data);
-        if (type == fastgltf::GltfType::glTF) 
-        {
-            auto load = parser.loadGLTF(&data, path.parent_path(), gltfOptions);
-            if (load) 
-            {
-                gltf = std::move(load.get());
-            } 
-            else 
-            {
-                BLIT_ERROR("Failed to load glTF: %i", fastgltf::to_underlying(load.error()))
-                return;
-            }
-        } 
-        else if (type == fastgltf::GltfType::GLB) 
+        BLIT_PROFILE_SCOPE("LoadScene")
+        if(!parsedScene.bParsed)
         {
-            auto load = parser.loadBinaryGLTF(&data, path.parent_path(), gltfOptions);
-            if (load) 
-            {
-                gltf = std::move(load.get());
-            } 
-            else 
-            {
-                BLIT_ERROR("Failed to load glTF: %i", fastgltf::to_underlying(load.error()))
-                return;
-            }
-        } 
-        else 
-        {
-            BLIT_ERROR("Failed to determine glTF container")
             return;
         }
+        const std::string& filepath = parsedScene.filepath;
+        fastgltf::Asset& gltf = parsedScene.asset;
 
+        m_scenes[parsedScene.name] = LoadedScene();
+        LoadedScene& scene = m_scenes[parsedScene.name];
+        scene.m_pRenderer = this;
 
         /*
         Extracting the samplers for all textures in the gltf scene
@@ -935,25 +1164,30 @@ namespace BlitzenVulkan
             vkCreateSampler(m_device, &vulkanSamplerInfo, nullptr, &(scene.m_samplers.back()));
         }
 
+        BLIT_LOG(Loader, Trace, "%s: %i samplers, %i images, %i materials, %i meshes, %i nodes", filepath.c_str(), 
+        static_cast<uint32_t>(gltf.samplers.size()), static_cast<uint32_t>(gltf.images.size()), static_cast<uint32_t>(gltf.materials.size()), 
+        static_cast<uint32_t>(gltf.meshes.size()), static_cast<uint32_t>(gltf.nodes.size()))
+
         //Since fastgltf uses indices, each part of the scene will be temporarily referenced by an array
         std::vector<MeshAsset*> meshAssets;
-        std::vector<Node*> nodes;
         std::vector<AllocatedImage*> textureImages;
         std::vector<MaterialInstance*> materials;
 
         //Loading textures, only the renderer's default for now
-        for(fastgltf::Image image : gltf.images)
+        for(size_t imageIndex = 0; imageIndex < gltf.images.size(); ++imageIndex)
         {
+            fastgltf::Image& image = gltf.images[imageIndex];
             if(image.name != "")
             {
                 scene.m_textures[image.name.c_str()] = AllocatedImage();
-                LoadGltfImage(scene.m_textures[image.name.c_str()], gltf, image);
+                UploadDecodedImage(scene.m_textures[image.name.c_str()], parsedScene.images[imageIndex]);
                 if (scene.m_textures[image.name.c_str()].image != VK_NULL_HANDLE)
                 {
                     textureImages.push_back(&(scene.m_textures[image.name.c_str()]));
                 }
                 else
                 {
+                    BLIT_LOG(Loader, Trace, "%s: image %s failed to load, using the error texture", filepath.c_str(), image.name.c_str())
                     scene.m_textures[image.name.c_str()].CleanupResources(m_device, m_allocator);
                     scene.m_textures.erase(image.name.c_str());
                     textureImages.push_back(&(m_placeholderErrorTexture));
@@ -964,13 +1198,14 @@ namespace BlitzenVulkan
                 //Because some dirtbags don't name their textures, I have to do this crap
                 std::string makeshiftName = std::to_string(static_cast<uint32_t>(textureImages.size()));
                 scene.m_textures[makeshiftName] = AllocatedImage();
-                LoadGltfImage(scene.m_textures[makeshiftName], gltf, image);
+                UploadDecodedImage(scene.m_textures[makeshiftName], parsedScene.images[imageIndex]);
                 if (scene.m_textures[makeshiftName].image != VK_NULL_HANDLE)
                 {
                     textureImages.push_back(&(scene.m_textures[makeshiftName]));
                 }
                 else
                 {
+                    BLIT_LOG(Loader, Trace, "%s: unnamed image %s failed to load, using the error texture", filepath.c_str(), makeshiftName.c_str())
                     scene.m_textures[makeshiftName].CleanupResources(m_device, m_allocator);
                     scene.m_textures.erase(makeshiftName);
                     textureImages.push_back(&(m_placeholderErrorTexture));
@@ -1054,78 +1289,70 @@ namespace BlitzenVulkan
 
                 /* Load indices */
                 fastgltf::Accessor& indexaccessor = gltf.accessors[primitive.indicesAccessor.value()];
-                indices.reserve(indices.size() + indexaccessor.count);
-
-                fastgltf::iterateAccessor<std::uint32_t>(gltf, indexaccessor, [&](std::uint32_t idx) {
-                    indices.push_back(idx + static_cast<uint32_t>(initialVertex));
+                size_t firstIndex = indices.size();
+                indices.resize(firstIndex + indexaccessor.count);
+                uint32_t* pIndices = indices.data() + firstIndex;
+                // Accessor elements can be read in any order, so the attributes are split between the job threads
+                BlitzenCore::ParallelFor(indexaccessor.count, 0, [&](size_t begin, size_t end)
+                {
+                    for(size_t i = begin; i < end; ++i)
+                    {
+                        pIndices[i] = fastgltf::getAccessorElement<std::uint32_t>(gltf, indexaccessor, i) + static_cast<uint32_t>(initialVertex);
+                    }
                 });
 
-                /* Load vertex positions */
+                /* Load vertices */
                 fastgltf::Accessor& posAccessor = gltf.accessors[primitive.findAttribute("POSITION")->second];
-                size_t previousVerticesSize = vertices.size();
                 vertices.resize(vertices.size() + posAccessor.count);
+                Vertex* pVertices = vertices.data() + initialVertex;
 
-                glm::vec3 center(0);
-                float radius = 0.f;
-                fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, posAccessor, [&](glm::vec3 v, size_t index) {
-                    Vertex& newVertex = vertices[initialVertex + index];
-                    newVertex.position = v;
-                    newVertex.normal = { 1, 0, 0 };
-                    newVertex.color = glm::vec4{ 1.f };
-                    newVertex.uvMapX = 0;
-                    newVertex.uvMapY = 0;
-
-                    center += newVertex.position;
-                });
-
-                center /= static_cast<float>(posAccessor.count);
+                // Normals, uv maps and vertex colors are optional
+                auto normals = primitive.findAttribute("NORMAL");
+                const fastgltf::Accessor* pNormalAccessor = normals != primitive.attributes.end() ? &gltf.accessors[(*normals).second] : nullptr;
+                auto uv = primitive.findAttribute("TEXCOORD_0");
+                const fastgltf::Accessor* pUvAccessor = uv != primitive.attributes.end() ? &gltf.accessors[(*uv).second] : nullptr;
+                auto colors = primitive.findAttribute("COLOR_0");
+                const fastgltf::Accessor* pColorAccessor = colors != primitive.attributes.end() ? &gltf.accessors[(*colors).second] : nullptr;
 
-                fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, posAccessor, [&](glm::vec3 v, size_t index) {
-                    Vertex& newVertex = vertices[initialVertex + index];
-                    radius = std::max(radius, glm::distance(center, newVertex.position));
+                BlitzenCore::ParallelFor(posAccessor.count, 0, [&](size_t begin, size_t end)
+                {
+                    for(size_t v = begin; v < end; ++v)
+                    {
+                        Vertex& newVertex = pVertices[v];
+                        newVertex.position = fastgltf::getAccessorElement<glm::vec3>(gltf, posAccessor, v);
+                        newVertex.normal = pNormalAccessor ? fastgltf::getAccessorElement<glm::vec3>(gltf, *pNormalAccessor, v) : glm::vec3{ 1, 0, 0 };
+                        glm::vec2 uvMap = pUvAccessor ? fastgltf::getAccessorElement<glm::vec2>(gltf, *pUvAccessor, v) : glm::vec2{ 0 };
+                        newVertex.uvMapX = uvMap.x;
+                        newVertex.uvMapY = uvMap.y;
+                        newVertex.color = pColorAccessor ? fastgltf::getAccessorElement<glm::vec4>(gltf, *pColorAccessor, v) : glm::vec4{ 1.f };
+                    }
                 });
 
-                currentSurface.center = center;
-                currentSurface.radius = radius;
-                
-
-                
+                // The bounding sphere, its sums are combined in the same order on every run, so the center does not change between machines
+                glm::vec3 center = BlitzenCore::ParallelReduce(posAccessor.count, 0, glm::vec3(0), [pVertices](size_t begin, size_t end)
+                {
+                    glm::vec3 sum(0);
+                    for(size_t v = begin; v < end; ++v)
+                    {
+                        sum += pVertices[v].position;
+                    }
+                    return sum;
+                }, [](const glm::vec3& a, const glm::vec3& b) { return a + b; });
+                center /= static_cast<float>(posAccessor.count);
 
-                /* Load normals */
-                auto normals = primitive.findAttribute("NORMAL");
-                if (normals != primitive.attributes.end()) 
+                float radius = BlitzenCore::ParallelReduce(posAccessor.count, 0, 0.f, [pVertices, center](size_t begin, size_t end)
                 {
-                
-                    fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, gltf.accessors[(*normals).second],
-                    [&](glm::vec3 v, size_t index) 
+                    float chunkRadius = 0.f;
+                    for(size_t v = begin; v < end; ++v)
                     {
-                        vertices[initialVertex + index].normal = v;
-                    });
-                }
+                        chunkRadius = std::max(chunkRadius, glm::distance(center, pVertices[v].position));
+                    }
+                    return chunkRadius;
+                }, [](float a, float b) { return std::max(a, b); });
 
-                /* Load uv maps */
-                auto uv = primitive.findAttribute("TEXCOORD_0");
-                if (uv != primitive.attributes.end()) {
-                
-                    fastgltf::iterateAccessorWithIndex<glm::vec2>(gltf, gltf.accessors[(*uv).second],
-                        [&](glm::vec2 v, size_t index) 
-                        {
-                            vertices[initialVertex + index].uvMapX = v.x;
-                            vertices[initialVertex + index].uvMapY = v.y;
-                        });
-                }
+                currentSurface.center = center;
+                currentSurface.radius = radius;
 
-                /* Load vertex colors */
-                auto colors = primitive.findAttribute("COLOR_0");
-                if (colors != primitive.attributes.end())
-                {
-                
-                    fastgltf::iterateAccessorWithIndex<glm::vec4>(gltf, gltf.accessors[(*colors).second],
-                        [&](glm::vec4 v, size_t index) 
-                        {
-                            vertices[initialVertex + index].color = v;
-                        });
-                }
                 //If the primitive has a material, it retrieves its index and saves it, otherwise it get the first material
                 if (primitive.materialIndex.has_value())
                 {
@@ -1140,15 +1367,14 @@ namespace BlitzenVulkan
         }
 
         /* Load each node in the gltf scene */
-        for (fastgltf::Node& node : gltf.nodes)
+        std::vector<glm::mat4> localTransforms(gltf.nodes.size());
+        std::vector<uint8_t> hasParent(gltf.nodes.size(), 0);
+        for (size_t i = 0; i < gltf.nodes.size(); ++i)
         {
-            //Add a new entry to the scene's hash map and add a pointer to it in the nodes array
-            scene.m_nodes[node.name.c_str()] = Node();
-            nodes.push_back(&(scene.m_nodes[node.name.c_str()]));
-            //Find the nodes with a mesh, and give them their mesh asset
-            if(node.meshIndex.has_value())
+            fastgltf::Node& node = gltf.nodes[i];
+            for(size_t child : node.children)
             {
-                nodes.back()->pMesh = meshAssets[*node.meshIndex];
+                hasParent[child] = 1;
             }
 
             //Takes a variant (node.transform) and calls the correct function to derive the local transform of each mesh
@@ -1156,7 +1382,7 @@ namespace BlitzenVulkan
             fastgltf::visitor 
             { 
                 [&](fastgltf::Node::TransformMatrix matrix) {
-                    memcpy(&(nodes.back()->localTransform), matrix.data(), sizeof(matrix));
+                    memcpy(&(localTransforms[i]), matrix.data(), sizeof(matrix));
                 },
                 [&](fastgltf::Node::TRS transform) {
                     //Get the translation vector to create the translation matrix
@@ -1170,119 +1396,223 @@ namespace BlitzenVulkan
                     glm::mat4 rotationMatrix = glm::toMat4(rotation);
                     glm::mat4 scaleMatrix = glm::scale(glm::mat4(1.f), scale);
                     //Derive the local transform
-                    nodes.back()->localTransform = translationMatrix * rotationMatrix * scaleMatrix;
+                    localTransforms[i] = translationMatrix * rotationMatrix * scaleMatrix;
                  } 
             }
             , node.transform);
-
         }
 
-        //Having loaded all the nodes, iterate through them to update their parent-children relationships
-        for (int i = 0; i < gltf.nodes.size(); ++i)
+        //Walks down from every node without a parent, so that each node is added after its parent.
+        //A node that is reached a second time (a broken file) is only added the first time
+        TransformHierarchy& hierarchy = scene.m_hierarchy;
+        hierarchy.parents.reserve(gltf.nodes.size());
+        hierarchy.localTransforms.reserve(gltf.nodes.size());
+        hierarchy.worldTransforms.reserve(gltf.nodes.size());
+        hierarchy.meshes.reserve(gltf.nodes.size());
+        std::vector<uint8_t> added(gltf.nodes.size(), 0);
+        std::vector<std::pair<size_t, uint32_t>> stack;
+        for(size_t root = 0; root < gltf.nodes.size(); ++root)
         {
-            Node* pParent = nodes[i];
-            for (auto& child : gltf.nodes[i].children)
+            if(hasParent[root])
+            {
+                continue;
+            }
+            stack.push_back({root, BLITZEN_TRANSFORM_NO_PARENT});
+            while(!stack.empty())
             {
-                //Add each child to the parent node
-                pParent->m_children.push_back(nodes[child]);
-                //Give every child a pointer to the parent node
-                pParent->m_children.back()->pParent = pParent;
+                auto [gltfIndex, parent] = stack.back();
+                stack.pop_back();
+                if(added[gltfIndex])
+                {
+                    continue;
+                }
+                added[gltfIndex] = 1;
+
+                fastgltf::Node& node = gltf.nodes[gltfIndex];
+                uint32_t index = hierarchy.AddNode(parent, localTransforms[gltfIndex], 
+                node.meshIndex.has_value() ? meshAssets[*node.meshIndex] : nullptr);
+                //Pushed in reverse so that the children keep the file's order
+                for(size_t c = node.children.size(); c > 0; --c)
+                {
+                    stack.push_back({node.children[c - 1], index});
+                }
             }
         }
+        if(hierarchy.parents.size() != gltf.nodes.size())
+        {
+            BLIT_LOG(Loader, Warn, "%s: %i nodes are part of a cycle and were left out", filepath.c_str(), 
+            static_cast<int32_t>(gltf.nodes.size() - hierarchy.parents.size()))
+        }
 
-        //Iterates through them once more to find the no-parent nodes and update the transform of their children
-        for(Node* node : nodes)
+        hierarchy.UpdateWorldTransforms();
+    }
+
+    void VulkanRenderer::UploadDecodedImage(AllocatedImage& imageToLoad, DecodedImage& decoded)
+    {
+        if(!decoded.pPixels)
         {
-            if(!(node->pParent))
-            {
-                //Add every node that does not have a parent to the top nodes and refresh its children's transform
-                scene.m_pureParentNodes.push_back(node);
-                node->UpdateTransform(glm::mat4(1.f));
-            }
+            return;
         }
+
+        VkExtent3D imagesize;
+        imagesize.width = decoded.width;
+        imagesize.height = decoded.height;
+        imagesize.depth = 1;
+        AllocateImage(decoded.pPixels, imageToLoad, imagesize, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT, false);
+
+        stbi_image_free(decoded.pPixels);
+        decoded.pPixels = nullptr;
     }
+    
 
-    void VulkanRenderer::LoadGltfImage(AllocatedImage& imageToLoad, fastgltf::Asset& gltfAsset, fastgltf::Image& gltfImage)
+    uint8_t VulkanRenderer::GetNodeLocalTransform(uint32_t scene, uint32_t node, glm::mat4& localTransform) const
     {
-        int width; 
-        int height;
-        int nrChannels;
+        if(scene >= m_manifestScenes.size() || !m_manifestScenes[scene] || node >= m_manifestScenes[scene]->m_hierarchy.parents.size())
+        {
+            return 0;
+        }
+        localTransform = m_manifestScenes[scene]->m_hierarchy.localTransforms[node];
+        return 1;
+    }
 
-        std::visit(
-            fastgltf::visitor {
-                [](auto& arg) {},
-                [&](fastgltf::sources::URI& filePath) {
-                    assert(filePath.fileByteOffset == 0); 
-                    assert(filePath.uri.isLocalPath());                                                         
-                    const std::string path(filePath.uri.path().begin(),
-                        filePath.uri.path().end()); 
-                    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
-                    if (data) {
-                        VkExtent3D imagesize;
-                        imagesize.width = width;
-                        imagesize.height = height;
-                        imagesize.depth = 1;
-
-                        AllocateImage(data, imageToLoad, imagesize, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT, false);
-
-                        stbi_image_free(data);
-                    }
-                },
-                [&](fastgltf::sources::Vector& vector) {
-                    unsigned char* data = stbi_load_from_memory(vector.bytes.data(), static_cast<int>(vector.bytes.size()),
-                        &width, &height, &nrChannels, 4);
-                    if (data) {
-                        VkExtent3D imagesize;
-                        imagesize.width = width;
-                        imagesize.height = height;
-                        imagesize.depth = 1;
+    void VulkanRenderer::UpdateNodeTransforms(const RenderContext& context)
+    {
+        BLIT_PROFILE_SCOPE("Update node transforms")
+        for(uint32_t i = 0; i < context.nodeUpdateCount; ++i)
+        {
+            const NodeTransformUpdate& update = context.nodeUpdates[i];
+            if(update.scene >= m_manifestScenes.size() || !m_manifestScenes[update.scene] || 
+            update.node >= m_manifestScenes[update.scene]->m_hierarchy.parents.size())
+            {
+                BLIT_WARN("Node %u of scene %u does not exist, its transform was not changed", update.node, update.scene)
+                continue;
+            }
+            m_manifestScenes[update.scene]->m_hierarchy.SetLocalTransform(update.node, update.localTransform);
+        }
 
-                        AllocateImage(data, imageToLoad, imagesize, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT,false);
+        // Scenes where nothing moved cost one check
+        for(LoadedScene* pScene : m_manifestScenes)
+        {
+            if(!pScene)
+            {
+                continue;
+            }
+            TransformHierarchy& hierarchy = pScene->m_hierarchy;
+            if(hierarchy.dirtyNodes.empty())
+            {
+                continue;
+            }
 
-                        stbi_image_free(data);
+            m_changedMeshNodes.clear();
+            hierarchy.PropagateDirtyTransforms(m_changedMeshNodes);
+            for(uint32_t instanceIndex : pScene->m_instances)
+            {
+                const SceneInstance& instance = m_sceneInstances[instanceIndex];
+                for(uint32_t node : m_changedMeshNodes)
+                {
+                    glm::mat4 finalMatrix = instance.transform * hierarchy.worldTransforms[node];
+                    uint32_t firstObject = instance.firstObject + hierarchy.objectOffsets[node];
+                    uint32_t surfaceCount = static_cast<uint32_t>(hierarchy.meshes[node]->surfaces.size());
+                    for(uint32_t object = firstObject; object < firstObject + surfaceCount; ++object)
+                    {
+                        m_mainDrawContext.opaqueRenderObjects[object].modelMatrix = finalMatrix;
+                        #if BLITZEN_START_VULKAN_WITH_INDIRECT
+                            m_mainDrawContext.renderObjects[object].worldMatrix = finalMatrix;
+                            m_changedObjects.push_back(object);
+                        #endif
                     }
-                },
-                [&](fastgltf::sources::BufferView& view) {
-                    auto& bufferView = gltfAsset.bufferViews[view.bufferViewIndex];
-                    auto& buffer = gltfAsset.buffers[bufferView.bufferIndex];
+                }
+            }
+        }
+    }
 
-                    std::visit(fastgltf::visitor { 
-                                   [](auto& arg) {},
-                                   [&](fastgltf::sources::Vector& vector) {
-                                       unsigned char* data = stbi_load_from_memory(vector.bytes.data() + bufferView.byteOffset,
-                                           static_cast<int>(bufferView.byteLength),
-                                           &width, &height, &nrChannels, 4);
-                                       if (data) {
-                                           VkExtent3D imagesize;
-                                           imagesize.width = width;
-                                           imagesize.height = height;
-                                           imagesize.depth = 1;
+    #if BLITZEN_START_VULKAN_WITH_INDIRECT
+    void VulkanRenderer::UploadChangedObjects(VkCommandBuffer commandBuffer)
+    {
+        if(m_changedObjects.empty())
+        {
+            return;
+        }
 
-                                           AllocateImage(data, imageToLoad, imagesize, VK_FORMAT_R8G8B8A8_UNORM,
-                                               VK_IMAGE_USAGE_SAMPLED_BIT,false);
+        // Objects that moved again before they were uploaded only go once, and neighbouring objects share a copy region
+        std::sort(m_changedObjects.begin(), m_changedObjects.end());
+        m_changedObjects.erase(std::unique(m_changedObjects.begin(), m_changedObjects.end()), m_changedObjects.end());
+        uint32_t uploadCount = static_cast<uint32_t>(m_changedObjects.size());
+        if(uploadCount > BLITZEN_VULKAN_MAX_OBJECT_UPLOADS)
+        {
+            uploadCount = BLITZEN_VULKAN_MAX_OBJECT_UPLOADS;
+        }
 
-                                           stbi_image_free(data);
-                                       }
-                                   } },
-                        buffer.data);
-                },
-            },
-            gltfImage.data);
+        // The frame's fence was waited on, so the GPU is done with the staging buffer's previous contents
+        IndirectRenderObject* pStaging = reinterpret_cast<IndirectRenderObject*>(m_frameTools[m_currentFrame].
+        objectUploadStagingBuffer.allocation->GetMappedData());
+        std::vector<VkBufferCopy2> regions;
+        for(uint32_t i = 0; i < uploadCount; ++i)
+        {
+            uint32_t object = m_changedObjects[i];
+            pStaging[i] = m_mainDrawContext.renderObjects[object];
+            if(i && m_changedObjects[i - 1] + 1 == object)
+            {
+                regions.back().size += sizeof(IndirectRenderObject);
+                continue;
+            }
+            VkBufferCopy2 region{};
+            region.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
+            region.srcOffset = sizeof(IndirectRenderObject) * i;
+            region.dstOffset = sizeof(IndirectRenderObject) * object;
+            region.size = sizeof(IndirectRenderObject);
+            regions.push_back(region);
+        }
+        BlitzenCore::MetricAdd(m_metrics.uploadedBytes, static_cast<int64_t>(sizeof(IndirectRenderObject) * uploadCount));
+
+        // The previous frame's shaders might still read the objects that are about to be overwritten
+        VkMemoryBarrier2 objectBufferBarrier{};
+        objectBufferBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        objectBufferBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+        objectBufferBarrier.srcAccessMask = 0;
+        objectBufferBarrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        objectBufferBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        VkDependencyInfo objectBufferDependency{};
+        objectBufferDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        objectBufferDependency.memoryBarrierCount = 1;
+        objectBufferDependency.pMemoryBarriers = &objectBufferBarrier;
+        vkCmdPipelineBarrier2(commandBuffer, &objectBufferDependency);
+
+        VkCopyBufferInfo2 objectCopy{};
+        objectCopy.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
+        objectCopy.srcBuffer = m_frameTools[m_currentFrame].objectUploadStagingBuffer.buffer;
+        objectCopy.dstBuffer = m_surfaceFrustumCollisionBuffer.buffer;
+        objectCopy.regionCount = static_cast<uint32_t>(regions.size());
+        objectCopy.pRegions = regions.data();
+        vkCmdCopyBuffer2(commandBuffer, &objectCopy);
+
+        // Culling and the vertex shader read the new transforms
+        objectBufferBarrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        objectBufferBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        objectBufferBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+        objectBufferBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+        vkCmdPipelineBarrier2(commandBuffer, &objectBufferDependency);
+
+        m_changedObjects.erase(m_changedObjects.begin(), m_changedObjects.begin() + uploadCount);
     }
-    
+    #endif
 
     /*!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     This is where all rendering commands during the game loop occur.
     !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*/
-    void VulkanRenderer::DrawFrame(RenderContext& context)
+    void VulkanRenderer::DrawFrame(const RenderContext& context)
     {
+        BLIT_PROFILE_SCOPE("DrawFrame")
+
         // No way to know this for now, since I removed GLFW
         if(context.bResize)
         {
+            m_windowWidth = context.windowWidth;
+            m_windowHeight = context.windowHeight;
             BootstrapRecreateSwapchain();
         }
 
-        BlitzenEngine::Camera* pCamera = reinterpret_cast<BlitzenEngine::Camera*>(context.pCamera);
+        UpdateNodeTransforms(context);
 
         /*-------------------------------
         Setting up the global scene data
@@ -1290,7 +1620,7 @@ namespace BlitzenVulkan
         //Setup the projection and view matrix
         m_globalSceneData.viewMatrix = context.viewMatrix;
         //Invert the projection matrix so that it matches glm and objects are not drawn upside down
-        m_globalSceneData.projectionViewMatrix = pCamera->GetProjectionView();
+        m_globalSceneData.projectionViewMatrix = context.projectionView;
 
 
         //Default lighting parameters
@@ -1307,27 +1637,34 @@ namespace BlitzenVulkan
         /*
         Initializing frustum culling data
         */
-        m_globalSceneData.frustumData[0] = pCamera->m_projectionTranspose[3] + pCamera->m_projectionTranspose[0];
-        m_globalSceneData.frustumData[1] = pCamera->m_projectionTranspose[3] - pCamera->m_projectionTranspose[0];
-        m_globalSceneData.frustumData[2] = pCamera->m_projectionTranspose[3] + pCamera->m_projectionTranspose[1];
-        m_globalSceneData.frustumData[3] = pCamera->m_projectionTranspose[3] - pCamera->m_projectionTranspose[1];
-        m_globalSceneData.frustumData[4] = pCamera->m_projectionTranspose[3] - pCamera->m_projectionTranspose[2];
+        m_globalSceneData.frustumData[0] = context.projectionTranspose[3] + context.projectionTranspose[0];
+        m_globalSceneData.frustumData[1] = context.projectionTranspose[3] - context.projectionTranspose[0];
+        m_globalSceneData.frustumData[2] = context.projectionTranspose[3] + context.projectionTranspose[1];
+        m_globalSceneData.frustumData[3] = context.projectionTranspose[3] - context.projectionTranspose[1];
+        m_globalSceneData.frustumData[4] = context.projectionTranspose[3] - context.projectionTranspose[2];
         m_globalSceneData.frustumData[5] = glm::vec4(0, 0, -1, 10000.f);
         //If indirect mode is not active frustum culling is done on the cpu
         if(!context.bDrawIndirect)
         {
-            for(RenderObject& object : m_mainDrawContext.opaqueRenderObjects)
+            BLIT_PROFILE_SCOPE("CPU frustum culling")
+            BLIT_FRAME_PHASE(Culling)
+            // Every object only writes its own visibility, so they can be split between the job threads freely
+            RenderObject* pObjects = m_mainDrawContext.opaqueRenderObjects.data();
+            BlitzenCore::ParallelFor(m_mainDrawContext.opaqueRenderObjects.size(), 0, [this, pObjects](size_t begin, size_t end)
             {
-                bool visible = true;
-                for(size_t i = 0; i < 6; ++i)
+                for(size_t o = begin; o < end; ++o)
                 {
+                    RenderObject& object = pObjects[o];
                     glm::vec3 center = object.modelMatrix * glm::vec4((object.center), 1.f);
                     center = m_globalSceneData.viewMatrix * glm::vec4(center, 1.f);
-                    float radius = object.radius;
-                    visible = visible && (glm::dot(m_globalSceneData.frustumData[i], glm::vec4(center, 1)) > -radius);
+                    bool visible = true;
+                    for(size_t i = 0; i < 6; ++i)
+                    {
+                        visible = visible && (glm::dot(m_globalSceneData.frustumData[i], glm::vec4(center, 1)) > -object.radius);
+                    }
+                    object.bVisible = visible;
                 }
-                object.bVisible = visible;
-            }
+            });
         }
 
         //Getting the tools that will be used this frame
@@ -1336,28 +1673,14 @@ namespace BlitzenVulkan
         VkSemaphore& currentImageAcquiredSemaphore = m_frameTools[m_currentFrame].imageAcquiredSemaphore;
         VkSemaphore& currentReadyToPresentSemaphore = m_frameTools[m_currentFrame].readyToPresentSemaphore;
         DescriptorAllocator& frameDescriptorAllocator = m_frameTools[m_currentFrame].sceneDataDescriptroAllocator;
-        //#ifndef NDEBUG
-            VkQueryPool& currentTimestampQueryPool = m_frameTools[m_currentFrame].timestampQueryPool;
-        //#endif
 
         //Wait for queue submition to signal the fence with a timeout of 1 second
-        vkWaitForFences(m_device, 1, &currentFrameCompleteFence, VK_TRUE, 1000000000);
-        vkResetFences(m_device, 1, &currentFrameCompleteFence);
-
-
-        //Read the timestamp of the previous frame
-        //#ifndef NDEBUG
-            uint64_t queryResults[2];
-            vkGetQueryPoolResults(m_device, m_frameTools[m_currentFrame].timestampQueryPool, 
-            0, 2, sizeof(queryResults), queryResults, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
-            VkPhysicalDeviceProperties props;
-            vkGetPhysicalDeviceProperties(m_bootstrapObjects.chosenGPU, &props);
-            double gpuStart = static_cast<double>(queryResults[0]) * props.limits.timestampPeriod * 1e-6;
-            double gpuEnd = static_cast<double>(queryResults[1]) * props.limits.timestampPeriod * 1e-6;
-            double frameGPU = gpuEnd - gpuStart;
-            char title[256];
-            sprintf_s(title, "GPU: %lf", frameGPU);
-        //#endif
+        {
+            BLIT_PROFILE_SCOPE("Wait for frame fence")
+            BLIT_FRAME_PHASE(Wait)
+            vkWaitForFences(m_device, 1, &currentFrameCompleteFence, VK_TRUE, 1000000000);
+            vkResetFences(m_device, 1, &currentFrameCompleteFence);
+        }
 
 
         //Passing global scene data to the shaders
@@ -1366,6 +1689,7 @@ namespace BlitzenVulkan
         SceneData* pSceneData = reinterpret_cast<SceneData*>(m_frameTools[m_currentFrame].
         sceneDataUniformBuffer.allocation->GetMappedData());
         *pSceneData = m_globalSceneData;
+        BlitzenCore::MetricAdd(m_metrics.uploadedBytes, sizeof(SceneData));
         VkDescriptorSet sceneDataDescriptorSet;
         m_frameTools[m_currentFrame].sceneDataDescriptroAllocator.AllocateDescriptorSet(&m_globalSceneDescriptorSetLayout, 
         1, &sceneDataDescriptorSet);
@@ -1389,19 +1713,23 @@ namespace BlitzenVulkan
         //VK_CHECK(vkAcquireNextImageKHR(m_device, m_bootstrapObjects.swapchain, 1000000000, 
         //m_frameTools[m_currentFrame].imageAcquiredSemaphore,VK_NULL_HANDLE, &swapchainImageIndex));
 
-        VkResult rese = vkAcquireNextImageKHR(m_device, m_bootstrapObjects.swapchain, 1000000000, m_frameTools[m_currentFrame].imageAcquiredSemaphore,
+        VkResult rese;
+        {
+            BLIT_PROFILE_SCOPE("Acquire swapchain image")
+            BLIT_FRAME_PHASE(Wait)
+            rese = vkAcquireNextImageKHR(m_device, m_bootstrapObjects.swapchain, 1000000000, m_frameTools[m_currentFrame].imageAcquiredSemaphore,
             VK_NULL_HANDLE, &swapchainImageIndex);
+        }
 
-        //Reset the timestamp before recording commands
-        //#ifndef NDEBUG
-            vkResetQueryPool(m_device, currentTimestampQueryPool, 0, 2);
-        //#endif
         //Return the command buffer to the initial state and then put it in the recording state
+        BlitzenCore::FlightRecorderBeginPhase(BlitzenCore::FramePhase::Record);
         vkResetCommandBuffer(frameCommandBuffer, 0);
         VkCommandBufferBeginInfo commandBufferBeginInfo{};
         commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         vkBeginCommandBuffer(frameCommandBuffer, &commandBufferBeginInfo);
+        // Also reads the timestamps of an earlier frame, which has finished by now
+        m_gpuProfiler.BeginFrame(m_device, frameCommandBuffer);
 
         /*--------------------------------------------------------------------------------------------
         After this point and until vkEndCommandBuffer is called, all graphics commands that need to be 
@@ -1432,6 +1760,9 @@ namespace BlitzenVulkan
         -----------------------------------------------------*/
 
         #if BLITZEN_START_VULKAN_WITH_INDIRECT
+            UploadChangedObjects(frameCommandBuffer);
+
+            uint32_t cullingScope = m_gpuProfiler.BeginScope(frameCommandBuffer, "Culling dispatch");
             vkCmdBindDescriptorSets(frameCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_indirectCullingComputePipelineData.layout,
             0, 1, &sceneDataDescriptorSet, 0, nullptr);
             vkCmdBindPipeline(frameCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_indirectCullingComputePipelineData.pipeline);
@@ -1454,6 +1785,7 @@ namespace BlitzenVulkan
             indirectBufferReadyDependency.imageMemoryBarrierCount = 0;
             indirectBufferReadyDependency.pImageMemoryBarriers = nullptr;
             vkCmdPipelineBarrier2(frameCommandBuffer, &indirectBufferReadyDependency);
+            m_gpuProfiler.EndScope(frameCommandBuffer, cullingScope);
         #endif
 
 
@@ -1502,6 +1834,7 @@ namespace BlitzenVulkan
         /*--------------------------------------------------------------------------------------------
         After this point and until vkCmdEndRendring is called, all rendering commands are recorded
         ---------------------------------------------------------------------------------------------*/
+        uint32_t mainPassScope = m_gpuProfiler.BeginScope(frameCommandBuffer, "Main pass");
         vkCmdBeginRendering(frameCommandBuffer, &mainRenderingInfo); 
 
         //Bind the index buffer, it's the same for both the indirect and traditional version of the pipeline
@@ -1549,16 +1882,16 @@ namespace BlitzenVulkan
         scissor.offset.y = 0;
         vkCmdSetScissor(frameCommandBuffer, 0, 1, &scissor);
 
-        //Start a timestamp 
-        //#ifndef NDEBUG
-            vkCmdWriteTimestamp2(frameCommandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, currentTimestampQueryPool, 0);
-        //#endif 
+        // Counted locally and reported once, instead of touching the metrics for every draw
+        int64_t drawCount = 0;
+        int64_t triangleCount = 0;
         #if BLITZEN_START_VULKAN_WITH_INDIRECT
             if(context.bDrawIndirect)
             {
                 //This is just beatiful
                 vkCmdDrawIndexedIndirect(frameCommandBuffer, m_finalIndirectBuffer.buffer, offsetof(DrawIndirectData, indirectDraws), 
                 static_cast<uint32_t>(m_mainDrawContext.indirectData.size()), sizeof(DrawIndirectData));
+                drawCount = 1;
             }
             //Go with the traditional method if draw indirect is inactive
             else
@@ -1573,6 +1906,8 @@ namespace BlitzenVulkan
                         vkCmdPushConstants(frameCommandBuffer, opaque.pMaterial->pPipeline->pipelineLayout,
                             VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawDataPushConstant), &pushConstant);
                         vkCmdDrawIndexed(frameCommandBuffer, opaque.indexCount, 1, opaque.firstIndex, 0, 0);
+                        ++drawCount;
+                        triangleCount += opaque.indexCount / 3;
                     }
                 }
             }
@@ -1587,20 +1922,27 @@ namespace BlitzenVulkan
                     vkCmdPushConstants(frameCommandBuffer, opaque.pMaterial->pPipeline->pipelineLayout,
                         VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawDataPushConstant), &pushConstant);
                     vkCmdDrawIndexed(frameCommandBuffer, opaque.indexCount, 1, opaque.firstIndex, 0, 0);
+                    ++drawCount;
+                    triangleCount += opaque.indexCount / 3;
                 }
             }
         #endif
-        //End the timestamp when drawing commands end
-        //#ifndef NDEBUG
-            vkCmdWriteTimestamp2(frameCommandBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, currentTimestampQueryPool, 1);
-        //#endif
+        BlitzenCore::MetricAdd(m_metrics.drawCalls, drawCount);
+        // Every object drawn on the CPU path passed culling, the indirect path only knows how many objects it sent to the GPU
+        if(!context.bDrawIndirect)
+        {
+            BlitzenCore::MetricAdd(m_metrics.visibleObjects, drawCount);
+            BlitzenCore::MetricAdd(m_metrics.triangles, triangleCount);
+        }
         /*-------------------------------
         End of rendering commands
         ---------------------------------*/
         vkCmdEndRendering(frameCommandBuffer);
+        m_gpuProfiler.EndScope(frameCommandBuffer, mainPassScope);
 
 
         //After the color attachment is done being used for rendering, it transition for a data transfer to the swapchain image, which will be presented to the surface
+        uint32_t blitScope = m_gpuProfiler.BeginScope(frameCommandBuffer, "Blit to swapchain");
         TransitionImageLayout(frameCommandBuffer, m_drawingAttachment.image, 
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_2_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, 
         VK_ACCESS_2_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_2_BLIT_BIT);
@@ -1614,11 +1956,14 @@ namespace BlitzenVulkan
         TransitionImageLayout(frameCommandBuffer, m_bootstrapObjects.swapchainImages[swapchainImageIndex],
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR , VK_ACCESS_2_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_2_BLIT_BIT, 
         VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE);
+        m_gpuProfiler.EndScope(frameCommandBuffer, blitScope);
+        m_gpuProfiler.EndFrame(frameCommandBuffer);
         /*------------------------------------------------------------------------------------------------------------------------------
         All commands end here, and the command buffer will be put to the executable state and will be submitted to the graphics queue, 
         so that the graphics commands of this frame can be executed
         --------------------------------------------------------------------------------------------------------------------------------*/
         vkEndCommandBuffer(frameCommandBuffer);
+        BlitzenCore::FlightRecorderEndPhase(BlitzenCore::FramePhase::Record);
 
 
         /*------------------------------------------------------------------------------------------------------
@@ -1652,7 +1997,11 @@ namespace BlitzenVulkan
         graphicsCommandsSubmit.pSignalSemaphoreInfos = &signalSemaphoreInfo;
         graphicsCommandsSubmit.commandBufferInfoCount = 1;
         graphicsCommandsSubmit.pCommandBufferInfos = &graphicsCommandBufferInfo;
-        vkQueueSubmit2(m_queues.graphicsQueue, 1, &graphicsCommandsSubmit, currentFrameCompleteFence);
+        {
+            BLIT_PROFILE_SCOPE("Queue submit")
+            BLIT_FRAME_PHASE(Submit)
+            vkQueueSubmit2(m_queues.graphicsQueue, 1, &graphicsCommandsSubmit, currentFrameCompleteFence);
+        }
         /*------------------------------------------------------
         Graphics command buffer submitted to graphics queue
         --------------------------------------------------------*/
@@ -1666,7 +2015,18 @@ namespace BlitzenVulkan
         presentInfo.swapchainCount = 1;
         presentInfo.pSwapchains = &(m_bootstrapObjects.swapchain);
         presentInfo.pImageIndices = &swapchainImageIndex;
-        vkQueuePresentKHR(m_queues.presentQueue, &presentInfo);
+        {
+            BLIT_PROFILE_SCOPE("Queue present")
+            BLIT_FRAME_PHASE(Present)
+            vkQueuePresentKHR(m_queues.presentQueue, &presentInfo);
+        }
+
+        double presentTime = BlitzenPlatform::GetAbsoluteTime();
+        if(m_lastPresentTime > 0.0)
+        {
+            BlitzenCore::FrameStatsRecord(BlitzenCore::FrameStatType::PresentInterval, (presentTime - m_lastPresentTime) * 1000.0);
+        }
+        m_lastPresentTime = presentTime;
 
         //The current frame gets incremented but does not go above the max frames in flight macro
         m_currentFrame = (m_currentFrame + 1) % BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT;
@@ -1689,12 +2049,12 @@ namespace BlitzenVulkan
         }
         vkDestroySwapchainKHR(m_device, m_bootstrapObjects.swapchain, nullptr);
 
-        CreateSwapchain(m_pWindowWidth, m_pWindowHeight);
+        CreateSwapchain(&m_windowWidth, &m_windowHeight);
 
         //The draw extent should also be updated depending on if the swapchain got bigger or smaller
-        m_drawExtent.width = std::min(static_cast<uint32_t>(*m_pWindowWidth), 
+        m_drawExtent.width = std::min(m_windowWidth, 
         static_cast<uint32_t>(m_drawingAttachment.extent.width));
-        m_drawExtent.height = std::min(static_cast<uint32_t>(*m_pWindowHeight), 
+        m_drawExtent.height = std::min(m_windowHeight, 
         static_cast<uint32_t>(m_drawingAttachment.extent.height));
     }
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include "vulkanData.h"
 #include "vulkanPipelines.h"
+#include "vulkanProfiler.h"
+#include "Core/blitMetrics.h"
+#include "Platform/blitAsyncIO.h"
+#include "Core/blitSceneManifest.h"
 
 //I really don't like including gameplay elements in the renderer, I want to fix this in the future
 #include "Input/controller.h"
@@ -17,6 +21,9 @@ namespace BlitzenVulkan
 {
     #define BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT  2
 
+    // Render objects whose transform can be copied to the GPU in one frame, the rest wait for the next frame
+    #define BLITZEN_VULKAN_MAX_OBJECT_UPLOADS    1024
+
     //Everything that uses VkBootstrap for initalization (except for the VkDevice which is a frequently used component)
     struct VkBootstrapObjects
     {
@@ -78,24 +85,71 @@ namespace BlitzenVulkan
 
         #if BLITZEN_START_VULKAN_WITH_INDIRECT
             AllocatedBuffer indirectFrustumDataUniformBuffer;
+
+            // Holds the render objects that moved, until the frame copies them to the render object buffer
+            AllocatedBuffer objectUploadStagingBuffer;
         #endif
 
-        //#ifndef NDEBUG
-            VkQueryPool timestampQueryPool;
-        //#endif
+    };
+
+    // Handles of the metrics that the renderer reports every frame
+    struct RendererMetrics
+    {
+        uint32_t drawCalls = BLITZEN_INVALID_METRIC;
+        // Only known on the CPU when culling is done there, with draw indirect the GPU decides
+        uint32_t visibleObjects = BLITZEN_INVALID_METRIC;
+        uint32_t triangles = BLITZEN_INVALID_METRIC;
+        // Bytes written to buffers that the GPU reads, including staging buffers
+        uint32_t uploadedBytes = BLITZEN_INVALID_METRIC;
+    };
+
+    // An image of a parsed scene in RGBA8, the pixels are null if it could not be read or decoded
+    struct DecodedImage
+    {
+        uint8_t* pPixels = nullptr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    // A scene file that was read and parsed, with nothing on the GPU yet
+    struct ParsedScene
+    {
+        std::string name;
+        std::string filepath;
+        fastgltf::Asset asset;
+        uint8_t bParsed = 0;
+        // One for every image of the asset
+        std::vector<DecodedImage> images;
     };
 
     class VulkanRenderer
     {
     public:
-        void Init(void* pState, uint32_t* pWidth, uint32_t* pHeight);
+        // Initialization is split into stages, so that the engine can run each one as soon as what it needs is ready.
+        // The instance does not need the window, the device needs the window for its surface
+        uint8_t InitInstance();
+        uint8_t InitDevice(void* pState);
+        uint8_t InitSwapchain(uint32_t* pWidth, uint32_t* pHeight);
+
+        // Reads and parses the manifest's scenes and decodes their images. Only the CPU is used, so it can run before the device exists
+        uint8_t ParseScenes(const BlitzenCore::SceneManifest& manifest);
+        // Reads the SPIR-V of every pipeline ahead of pipeline creation. Does not need the device either
+        uint8_t ReadShaders();
+
+        // Uploads the parsed scenes and places the manifest's instances. Needs the swapchain, the parsed scenes and the shaders
+        void UploadDataToGPU(const BlitzenCore::SceneManifest& manifest);
 
-        void UploadDataToGPU();
+        // The transform that a node of one of the manifest's scenes was loaded with. Returns 0 if the scene was not loaded or has no
+        // such node. Reads what the render thread writes, so it is only called before that starts
+        uint8_t GetNodeLocalTransform(uint32_t scene, uint32_t node, glm::mat4& localTransform) const;
 
-        void DrawFrame(RenderContext& context);
+        void DrawFrame(const RenderContext& context);
 
         void CleanupResources();
 
+        // Adds the budget and usage of every device memory heap to a report that already holds the engine's numbers
+        void FillMemoryReport(BlitzenCore::MemoryReport& report);
+
     private:
 
         void CreateSwapchain(uint32_t* pWidth, uint32_t* pHeight);
@@ -113,14 +167,16 @@ namespace BlitzenVulkan
         void InitFrameTools();
 
         //This function allocates an image using vma and the allocatedImage struct from vulkanData.h
-        void AllocateImage(AllocatedImage& imageToAllocate, VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, bool bMipMapped = false);
+        void AllocateImage(AllocatedImage& imageToAllocate, VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, 
+        BlitzenCore::GpuMemoryCategory category, bool bMipMapped = false);
 
         //This function does the same as the above, but also uploads data to a buffer and copies it to the allocated image
         void AllocateImage(void* dataToCopy, AllocatedImage& imageToAllocate, VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, 
         bool bMipMapped = false);
 
         //Allocates a buffer using VMA and the AllocatedBuffer struct
-        void AllocateBuffer(AllocatedBuffer& bufferToAllocate, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage, VmaMemoryUsage memoryUsage);
+        void AllocateBuffer(AllocatedBuffer& bufferToAllocate, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage, VmaMemoryUsage memoryUsage, 
+        BlitzenCore::GpuMemoryCategory category);
 
         //Reocrds commands to change the layout of an image, to suit the next operation that should be excecuted on it
         void TransitionImageLayout(const VkCommandBuffer& recordingCDB, VkImage& imageToTransition, VkImageLayout oldLayout, VkImageLayout newLayout, 
@@ -148,15 +204,23 @@ namespace BlitzenVulkan
         //Passes the material resources to the descriptor set that will allow access to them on the shader through render object index
         void UploadMaterialResourcesToGPU(std::vector<MaterialResources>& materialResources);
 
-        //Takes a filepath to a gltf scene and loads its data using fastglft library
-        void LoadScene(std::string& filepath, const char* sceneName, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, 
-        std::vector<MaterialConstants>& MaterialConstants, std::vector<MaterialResources>& resources);
-        //Called from inside load scene, to load textures(uses stbi image)
-        void LoadGltfImage(AllocatedImage& imageToLoad, fastgltf::Asset& gltfAsset, fastgltf::Image& gltfImage);
+        //Takes a scene that ParseScenes read and creates its samplers, textures, materials, meshes and nodes
+        void LoadScene(ParsedScene& parsedScene, std::vector<Vertex>& vertices, 
+        std::vector<uint32_t>& indices, std::vector<MaterialConstants>& MaterialConstants, std::vector<MaterialResources>& resources);
+        //Creates a sampled texture from an image that ParseScenes decoded and frees its pixels
+        void UploadDecodedImage(AllocatedImage& imageToLoad, DecodedImage& decoded);
 
         //This is called so that when the window is resized, the swapchain can be recreated to fit the new size
         void BootstrapRecreateSwapchain();
 
+        // Applies the context's node transforms, then recomputes the subtrees that changed and the render objects of their meshes
+        void UpdateNodeTransforms(const RenderContext& context);
+
+        #if BLITZEN_START_VULKAN_WITH_INDIRECT
+            // Records copies of the render objects that moved, before anything on the GPU reads them
+            void UploadChangedObjects(VkCommandBuffer commandBuffer);
+        #endif
+
 
 
         //Cleans up vulkan objects contained in frame tools struct
@@ -167,8 +231,9 @@ namespace BlitzenVulkan
 
     public:
 
-        uint32_t* m_pWindowWidth;
-        uint32_t* m_pWindowHeight;
+        // The renderer's own copy of the window size, only changed by a RenderContext that asks for a resize
+        uint32_t m_windowWidth;
+        uint32_t m_windowHeight;
 
         //Holds some variables that change the way the renderer works
         VulkanStats stats;
@@ -186,6 +251,9 @@ namespace BlitzenVulkan
         //Used to indicate which index of the frame tools list should be used
         uint32_t m_currentFrame = 0;
 
+        // Platform time of the last present, 0 before the first one
+        double m_lastPresentTime = 0.0;
+
         // Might use this later
         VkAllocationCallbacks* m_pCustomAllocator = nullptr;
 
@@ -197,6 +265,11 @@ namespace BlitzenVulkan
 
         std::array<FrameTools, BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT> m_frameTools;
 
+        // Times the regions of each frame on the GPU
+        GpuProfiler m_gpuProfiler;
+
+        RendererMetrics m_metrics;
+
         //The main rendering attachments
         AllocatedImage m_drawingAttachment;
         AllocatedImage m_depthAttachment;
@@ -232,10 +305,24 @@ namespace BlitzenVulkan
         AllocatedBuffer m_globalMaterialConstantsBuffer;
         AllocatedBuffer m_surfaceFrustumCollisionBuffer;
 
+        // Filled in by ParseScenes, emptied once UploadDataToGPU is done with them
+        std::vector<ParsedScene> m_parsedScenes;
+
         //Holds all the scenes that have been loaded from a glb file
         std::unordered_map<std::string, LoadedScene> m_scenes;
 
         //Holds all the render objects that will be drawn each frame
         DrawContext m_mainDrawContext;
+
+        // The loaded scene of each of the manifest's scenes, node transform updates refer to scenes by manifest index
+        std::vector<LoadedScene*> m_manifestScenes;
+        std::vector<SceneInstance> m_sceneInstances;
+
+        // Reused every frame by UpdateNodeTransforms
+        std::vector<uint32_t> m_changedMeshNodes;
+        #if BLITZEN_START_VULKAN_WITH_INDIRECT
+            // Render objects that changed on the CPU and are not on the GPU yet
+            std::vector<uint32_t> m_changedObjects;
+        #endif
     };
 }
\ No newline at end of file
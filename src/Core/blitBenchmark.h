@@ -0,0 +1,24 @@
+#pragma once
+
+#include "blitSceneManifest.h"
+
+// Every scenario adds one line for each frame statistic that has samples. Leave this undefined to only log the results
+#define BLITZEN_BENCHMARK_FILE                      "BlitzenBenchmark.csv"
+// Samples of each statistic that are dropped once a scenario starts measuring. Frames that were in flight by then record theirs late,
+// at most the render context ring plus the GPU profiler's latency later
+#define BLITZEN_BENCHMARK_SKIPPED_FRAMES            5
+
+namespace BlitzenCore
+{
+    // Takes the manifest's scenarios and starts the first one. Returns 0 if there are none, in which case nothing else does anything
+    uint8_t BenchmarkInit(const SceneManifest& manifest);
+
+    uint8_t BenchmarkIsRunning();
+
+    // Moves the benchmark forward by one simulation step, so that scenarios take the same steps on every run whatever the frame rate.
+    // The camera is set when the scenario has a camera path. Returns 0 once the last scenario has finished
+    uint8_t BenchmarkStep(double step, CameraPathPoint& camera, uint8_t& bHasCamera);
+
+    // Writes the results of a scenario that was cut short and closes the file
+    void BenchmarkShutdown();
+}
@@ -34,7 +34,9 @@ namespace BlitzenCore
         MouseMoved = 5,
         MouseWheel = 6,
         WindowResize = 7,
-        MaxTypes = 8
+        // ui32[0] is 1 when the window gained focus and 0 when it lost it
+        WindowFocus = 8,
+        MaxTypes = 9
     };
 
     typedef uint8_t (*pfnOnEvent)(BlitEventType type, void* pSender, void* pListener, EventContext eventData);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "blitLogger.h"
+
+// When this is 0, the flight recorder compiles to nothing
+#define BLITZEN_FLIGHT_RECORDER                     1
+// Frames and events that are kept (must be powers of 2)
+#define BLITZEN_FLIGHT_RECORDER_FRAMES              256
+#define BLITZEN_FLIGHT_RECORDER_EVENTS              1024
+// A frame is a hitch when it takes this many times longer than the median of the frames before it, and at least the minimum
+#define BLITZEN_FLIGHT_RECORDER_HITCH_FACTOR        2.0
+#define BLITZEN_FLIGHT_RECORDER_MIN_HITCH_MS        8.0
+#define BLITZEN_FLIGHT_RECORDER_MEDIAN_FRAMES       64
+// The frames around a hitch that are written to its trace
+#define BLITZEN_FLIGHT_RECORDER_FRAMES_BEFORE       120
+#define BLITZEN_FLIGHT_RECORDER_FRAMES_AFTER        10
+// Traces that a single run may write, so that a bad run does not fill the disk. The %u is replaced by the frame of the hitch
+#define BLITZEN_FLIGHT_RECORDER_MAX_DUMPS           16
+#define BLITZEN_FLIGHT_RECORDER_FILE                "BlitzenHitch_%u.json"
+// Where the whole recording is written when it is asked for
+#define BLITZEN_FLIGHT_RECORDER_DUMP_FILE           "BlitzenFlightRecorder.json"
+
+namespace BlitzenCore
+{
+    // Parts of the main loop that are timed on every frame
+    enum class FramePhase : uint8_t
+    {
+        Pump = 0,
+        Camera = 1,
+        Culling = 2,
+        // Waiting for the frame's fence and the swapchain image
+        Wait = 3,
+        Record = 4,
+        Submit = 5,
+        Present = 6,
+        // The main thread waiting for the render thread to take the frame's context
+        RenderWait = 7,
+
+        MaxPhases = 8
+    };
+
+    #if BLITZEN_FLIGHT_RECORDER
+        // The flight recorder is only used by the main thread, except for FlightRecorderCountAllocation and the phases, which the render thread
+        // times as well. A phase counts towards the main thread's frame that it ends in
+        void FlightRecorderBeginFrame(uint32_t frameIndex);
+        // Checks the frame for a hitch and writes the trace of an earlier hitch once enough frames have followed it
+        void FlightRecorderEndFrame();
+
+        void FlightRecorderBeginPhase(FramePhase phase);
+        void FlightRecorderEndPhase(FramePhase phase);
+
+        void FlightRecorderRecordEvent(uint16_t type);
+        void FlightRecorderCountAllocation(size_t size);
+
+        // Writes every frame that is still held as a Chrome trace
+        uint8_t FlightRecorderDump(const char* filepath);
+
+        class FramePhaseScope
+        {
+        public:
+            inline FramePhaseScope(FramePhase phase) :m_phase{phase} { FlightRecorderBeginPhase(phase); }
+            inline ~FramePhaseScope() { FlightRecorderEndPhase(m_phase); }
+
+        private:
+            FramePhase m_phase;
+        };
+
+        #define BLIT_FRAME_PHASE_CONCAT_INTERNAL(a, b)      a##b
+        #define BLIT_FRAME_PHASE_CONCAT(a, b)               BLIT_FRAME_PHASE_CONCAT_INTERNAL(a, b)
+        // Times the rest of the enclosing scope as a phase of the frame
+        #define BLIT_FRAME_PHASE(phase)                     BlitzenCore::FramePhaseScope BLIT_FRAME_PHASE_CONCAT(blitFramePhase, __LINE__)(BlitzenCore::FramePhase::phase);
+    #else
+        inline void FlightRecorderBeginFrame(uint32_t) {}
+        inline void FlightRecorderEndFrame() {}
+        inline void FlightRecorderBeginPhase(FramePhase) {}
+        inline void FlightRecorderEndPhase(FramePhase) {}
+        inline void FlightRecorderRecordEvent(uint16_t) {}
+        inline void FlightRecorderCountAllocation(size_t) {}
+        inline uint8_t FlightRecorderDump(const char*) { return 0; }
+
+        #define BLIT_FRAME_PHASE(phase)
+    #endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "blitLogger.h"
+
+// The pacer sleeps until this close to the deadline and spins for the rest. The margin follows the oversleeps that it measures,
+// these only bound it
+#define BLITZEN_FRAME_PACER_MIN_SPIN_MS             0.2
+#define BLITZEN_FRAME_PACER_MAX_SPIN_MS             4.0
+// How quickly the worst oversleep is forgotten, once per sleep
+#define BLITZEN_FRAME_PACER_OVERSLEEP_DECAY         0.98
+
+namespace BlitzenCore
+{
+    // Target frame time in seconds, 0 lets frames run as fast as they can
+    void FramePacerInit(double targetFrameTime);
+
+    void FramePacerSetTarget(double targetFrameTime);
+    double FramePacerGetTarget();
+
+    // Waits until the next frame is due. Should be called once per frame, before the frame samples its input.
+    // A frame that is late by more than a whole target starts a new schedule, instead of the next frames rushing to catch up
+    void FramePacerWait();
+
+    // Starts a new schedule from the next frame, which is neither counted as late nor measured for its pacing error. For a gap in the
+    // frames that was meant to be there, like the time that the engine spent suspended
+    void FramePacerReset();
+
+    // Logs how late the pacer woke up and how much time it spent sleeping and spinning
+    void FramePacerLogSummary();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "blitLogger.h"
+
+// Samples of each statistic that are kept, summaries only look at these
+#define BLITZEN_FRAME_STATS_WINDOW                  1024
+// A sample counts as a hitch when it takes this many times longer than usual (the median for the window, a running average for the run)
+#define BLITZEN_FRAME_STATS_HITCH_FACTOR            2.0
+// Samples before the running average is trusted for hitches
+#define BLITZEN_FRAME_STATS_WARMUP_SAMPLES          16
+// The summary that is logged on shutdown is written here too, since release builds strip Core's info messages. Leave it undefined
+// to only log it
+#define BLITZEN_FRAME_STATS_FILE                    "BlitzenFrameStats.csv"
+
+namespace BlitzenCore
+{
+    enum class FrameStatType : uint8_t
+    {
+        // Time from the start of a frame on the main thread until its context is handed to the render thread, or until the renderer
+        // has submitted and presented it when there is no render thread
+        CpuFrame = 0,
+        // Time between the first and last GPU timestamp of a frame
+        GpuFrame = 1,
+        // Time between two presents, which is what the user actually sees
+        PresentInterval = 2,
+        // How far the time between two paced frames was from the pacer's target, only recorded while a target is set
+        PacingError = 3,
+
+        MaxTypes = 4
+    };
+
+    // All times are in milliseconds
+    struct FrameStatSummary
+    {
+        uint32_t sampleCount;
+        double min;
+        double average;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+        // Hitches among the samples in the window
+        uint32_t windowHitches;
+
+        // Over the whole run
+        uint64_t totalSamples;
+        uint64_t totalHitches;
+    };
+
+    // Safe to call from any thread
+    void FrameStatsRecord(FrameStatType type, double milliseconds);
+
+    // Fills the summary of the current window. Returns 0 if the statistic has no samples yet
+    uint8_t FrameStatsGetSummary(FrameStatType type, FrameStatSummary& summary);
+
+    // Logs the summary of every statistic
+    void FrameStatsLogSummary();
+
+    // Writes the summary of every statistic to BLITZEN_FRAME_STATS_FILE, one line each. Does nothing when it is undefined
+    void FrameStatsWriteSummary();
+
+    const char* FrameStatsGetName(FrameStatType type);
+
+    // Clears every window and the totals, e.g. after loading, so that the numbers only describe the part that is measured
+    void FrameStatsReset();
+
+    // Keeps every sample from now on, beside the windows, until the capture ends. The first skipped samples of each statistic are
+    // dropped, for frames that were already in flight when the capture began
+    void FrameStatsBeginCapture(uint32_t skippedSamples);
+
+    // Fills the summary of every sample captured so far, the window hitches count the hitches among them. Returns 0 if there are none
+    uint8_t FrameStatsGetCaptureSummary(FrameStatType type, FrameStatSummary& summary);
+
+    // Stops capturing and frees the samples
+    void FrameStatsEndCapture();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "blitEvents.h"
+
+// "BINP" in little endian, written at the start of every recording so that random files are not replayed
+#define BLITZEN_INPUT_RECORDING_MAGIC               0x504E4942
+#define BLITZEN_INPUT_RECORDING_VERSION             1
+
+// Recorded events are held here and written to the file in batches, so that recording does not write to disk for every event
+#define BLITZEN_INPUT_RECORDING_BATCH_SIZE          1024
+
+namespace BlitzenCore
+{
+    enum class InputRecordingMode : uint8_t
+    {
+        Inactive = 0,
+        Record = 1,
+        Replay = 2
+    };
+
+    enum class RecordedInputType : uint8_t
+    {
+        Key = 0,
+        MouseButton = 1,
+        MouseMove = 2,
+        MouseWheel = 3,
+
+        MaxTypes = 4
+    };
+
+    // A single input event as it reached the input system, tagged with the frame that it arrived on
+    struct RecordedInputEvent
+    {
+        uint32_t frameIndex;
+        RecordedInputType type;
+        // Holds the pressed state for keys and buttons and the wheel direction for the mouse wheel
+        int8_t state;
+        // Holds the key or the button
+        uint16_t code;
+        // Mouse position for mouse moves
+        int16_t x;
+        int16_t y;
+    };
+
+    // Written at the start of the file. The fixed delta time is the one that the engine will use when it replays the file, the frames
+    // were recorded at whatever the live frame time was
+    struct InputRecordingHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        double fixedDeltaTime;
+        uint32_t eventCount;
+        uint32_t frameCount;
+    };
+
+    // Opens the file for writing or reads the whole of it for replay. Returns 0 if the file could not be used.
+    // The delta time is saved when recording, a replay uses the one saved in the file
+    uint8_t InputRecordingInit(InputRecordingMode mode, const char* filepath, double replayDeltaTime);
+    // Writes any leftover events and the final header when recording, frees the replay events when replaying
+    void InputRecordingShutdown();
+
+    InputRecordingMode GetInputRecordingMode();
+
+    // The delta time that the engine should use every frame while replaying
+    double GetInputReplayDeltaTime();
+
+    // Returns 1 once every frame of the replay has been fed to the input system
+    uint8_t InputReplayFinished();
+
+    // Called by the engine before messages are pumped each frame. When replaying, this feeds the events recorded for the frame
+    void InputRecordingBeginFrame(uint32_t frameIndex);
+
+    // Called by the input system for every event that reaches it. Returns 0 if the event should be ignored (live input during replay)
+    uint8_t InputRecordEvent(RecordedInputType type, uint16_t code, int8_t state, int16_t x, int16_t y);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "blitLogger.h"
+
+#include <atomic>
+
+// Worker threads that can be started. The main thread runs jobs as well and is not counted
+#define BLITZEN_JOBS_MAX_WORKERS                    31
+// Jobs that each thread can have queued (must be a power of 2). A job that does not fit runs right away on the thread that submitted it
+#define BLITZEN_JOBS_DEQUE_SIZE                     4096
+// Rounds of looking for work that an idle worker spends before it goes to sleep
+#define BLITZEN_JOBS_SPIN_ROUNDS                    64
+
+namespace BlitzenCore
+{
+    // Marks threads that were not started by the job system (or the main thread that started it)
+    #define BLITZEN_JOBS_INVALID_THREAD             UINT32_MAX
+
+    typedef void (*pfnJob)(void* pData);
+
+    // Counts the jobs of a batch that have not finished yet. Work that depends on a batch waits for its counter to reach 0
+    struct JobCounter
+    {
+        std::atomic<uint32_t> value{0};
+    };
+
+    struct JobDecl
+    {
+        pfnJob pfnFunction;
+        // Must stay alive until the job's counter reaches 0
+        void* pData;
+    };
+
+    // Starts the workers and makes the calling thread a job thread with index 0. A worker count of 0 starts one worker for every
+    // hardware thread except the caller's. External threads are ones that the engine starts itself (the render thread), they get a deque
+    // each after the workers' once they register
+    uint8_t JobSystemInit(uint32_t workerCount = 0, uint32_t externalThreadCount = 0);
+    // Makes the calling thread the external job thread with the given index (from 0), so that the jobs it runs are spread to the workers.
+    // It should stop running jobs before the job system shuts down
+    uint8_t JobSystemRegisterThread(uint32_t externalIndex);
+    // Stops the workers once they are idle. Every counter should have been waited on by now
+    void JobSystemShutdown();
+
+    // Threads that run jobs, the caller of JobSystemInit included. 1 when the job system is not running
+    uint32_t JobSystemGetThreadCount();
+    // Index of the calling thread, in [0, JobSystemGetThreadCount()), or BLITZEN_JOBS_INVALID_THREAD
+    uint32_t JobSystemGetThreadIndex();
+
+    // Adds the job count to the counter (it can be null) and queues the jobs on the calling thread, where idle workers steal them from.
+    // Threads that are not job threads run the jobs before returning
+    void RunJobs(const JobDecl* pJobs, uint32_t jobCount, JobCounter* pCounter);
+
+    inline void RunJob(pfnJob pfnFunction, void* pData, JobCounter* pCounter)
+    {
+        JobDecl job{pfnFunction, pData};
+        RunJobs(&job, 1, pCounter);
+    }
+
+    // Runs queued jobs (anyone's) until the counter drops to the value, so a job can wait on the jobs it started without blocking a worker
+    void WaitForCounter(JobCounter* pCounter, uint32_t value = 0);
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Layout of the binary log, shared by the logger that writes it and the decoder that turns it back into text.
+// The file is the header followed by records. A format record appears once for each call site, before its first message
+#define BLITZEN_BINARY_LOG_MAGIC            0x474F4C42 // "BLOG" in little endian
+#define BLITZEN_BINARY_LOG_VERSION          2
+
+// Longest output of a single conversion when a message is rendered, anything longer is cut short
+#define BLITZEN_LOG_FORMAT_CONVERSION_SIZE  512
+
+namespace BlitzenCore
+{
+    struct BinaryLogFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    enum class BinaryLogRecordType : uint8_t
+    {
+        // The payload is the line (uint32_t) followed by the null terminated format string and the null terminated file name
+        Format = 0,
+        // The payload is the encoded arguments of a message that uses the format with the record's id
+        Message = 1,
+        // The payload is a message that was already formatted (levels that are not deferred)
+        Text = 2,
+
+        MaxTypes = 3
+    };
+
+    struct BinaryLogRecordHeader
+    {
+        BinaryLogRecordType type;
+        uint8_t level;
+        // Bytes of payload that follow the header
+        uint16_t size;
+        // Format id for format and message records, 0 for text
+        uint32_t id;
+    };
+
+    // Every argument is a tag followed by the raw value. Strings are a tag, a uint16_t length and the characters without a terminator
+    enum class LogArgType : uint8_t
+    {
+        Int32 = 0,
+        UInt32 = 1,
+        Int64 = 2,
+        UInt64 = 3,
+        Double = 4,
+        String = 5,
+        Pointer = 6,
+
+        MaxTypes = 7
+    };
+
+    // Encodes arguments into a fixed buffer. Arguments that do not fit are dropped and strings are cut short
+    struct LogArgWriter
+    {
+        uint8_t* pData;
+        uint32_t size;
+        uint32_t capacity;
+    };
+
+    inline void WriteLogArg(LogArgWriter& writer, LogArgType type, const void* pValue, uint32_t valueSize)
+    {
+        // Once an argument is dropped, the ones after it are dropped as well
+        if(writer.size + 1 + valueSize > writer.capacity)
+        {
+            writer.capacity = writer.size;
+            return;
+        }
+        writer.pData[writer.size] = static_cast<uint8_t>(type);
+        memcpy(writer.pData + writer.size + 1, pValue, valueSize);
+        writer.size += 1 + valueSize;
+    }
+
+    inline void WriteLogString(LogArgWriter& writer, const char* string)
+    {
+        if(!string)
+        {
+            string = "(null)";
+        }
+
+        if(writer.size + 1 + sizeof(uint16_t) > writer.capacity)
+        {
+            writer.capacity = writer.size;
+            return;
+        }
+        size_t length = strlen(string);
+        size_t space = writer.capacity - writer.size - 1 - sizeof(uint16_t);
+        uint16_t stored = static_cast<uint16_t>(length < space ? length : space);
+
+        writer.pData[writer.size] = static_cast<uint8_t>(LogArgType::String);
+        memcpy(writer.pData + writer.size + 1, &stored, sizeof(uint16_t));
+        memcpy(writer.pData + writer.size + 1 + sizeof(uint16_t), string, stored);
+        writer.size += 1 + sizeof(uint16_t) + stored;
+    }
+
+    // Arguments are stored with the same promotions that printf would apply to them, so the format string means the same thing when decoded
+    template<typename T>
+    void EncodeLogArg(LogArgWriter& writer, const T& value)
+    {
+        using Type = std::decay_t<T>;
+        if constexpr(std::is_same_v<Type, char*> || std::is_same_v<Type, const char*>)
+        {
+            WriteLogString(writer, value);
+        }
+        else if constexpr(std::is_floating_point_v<Type>)
+        {
+            double converted = static_cast<double>(value);
+            WriteLogArg(writer, LogArgType::Double, &converted, sizeof(double));
+        }
+        else if constexpr(std::is_enum_v<Type>)
+        {
+            EncodeLogArg(writer, static_cast<std::underlying_type_t<Type>>(value));
+        }
+        else if constexpr(std::is_integral_v<Type> && sizeof(Type) <= sizeof(int32_t))
+        {
+            if constexpr(std::is_signed_v<Type>)
+            {
+                int32_t converted = static_cast<int32_t>(value);
+                WriteLogArg(writer, LogArgType::Int32, &converted, sizeof(int32_t));
+            }
+            else
+            {
+                uint32_t converted = static_cast<uint32_t>(value);
+                WriteLogArg(writer, LogArgType::UInt32, &converted, sizeof(uint32_t));
+            }
+        }
+        else if constexpr(std::is_integral_v<Type>)
+        {
+            if constexpr(std::is_signed_v<Type>)
+            {
+                int64_t converted = static_cast<int64_t>(value);
+                WriteLogArg(writer, LogArgType::Int64, &converted, sizeof(int64_t));
+            }
+            else
+            {
+                uint64_t converted = static_cast<uint64_t>(value);
+                WriteLogArg(writer, LogArgType::UInt64, &converted, sizeof(uint64_t));
+            }
+        }
+        else if constexpr(std::is_pointer_v<Type>)
+        {
+            uint64_t converted = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+            WriteLogArg(writer, LogArgType::Pointer, &converted, sizeof(uint64_t));
+        }
+        else
+        {
+            static_assert(sizeof(Type) == 0, "This type cannot be passed to a binary log message");
+        }
+    }
+
+    // Formats a message from its format string and encoded arguments, the same way that snprintf would have. Returns the length written
+    uint32_t RenderLogMessage(const char* format, const uint8_t* pArgs, uint32_t argsSize, char* pOut, uint32_t outSize);
+}
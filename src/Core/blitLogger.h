@@ -1,70 +1,210 @@
 #pragma once 
 #include <iostream>
+#include <atomic>
+#include "blitLogFormat.h"
 
 namespace BlitzenCore
 {
-    #define BLITZEN_LOG_FATAL               1
-    #define BLITZEN_LOG_ERROR               1
-
+    // The most verbose level compiled in for each channel, messages past it are stripped entirely.
+    // Release builds keep loader tracing, so that it can be turned on at runtime without paying for the other channels
     #ifndef NDEBUG
-        #define BLITZEN_LOG_INFO            1
-        #define BLITZEN_LOG_WARNINGS        1
-        #define BLITZEN_LOG_DEBUG           1
-        #define BLITZEN_LOG_TRACE           1
+        #define BLITZEN_LOG_COMPILED_LEVEL_CORE         Trace
+        #define BLITZEN_LOG_COMPILED_LEVEL_EVENTS       Trace
+        #define BLITZEN_LOG_COMPILED_LEVEL_VULKAN       Trace
+        #define BLITZEN_LOG_COMPILED_LEVEL_LOADER       Trace
+        #define BLITZEN_LOG_COMPILED_LEVEL_PLATFORM     Trace
+        // Every channel starts at this level or at its compiled level, whichever is less verbose
+        #define BLITZEN_LOG_DEFAULT_LEVEL               Trace
     #else
-        #define BLITZEN_LOG_INFO            0
-        #define BLITZEN_LOG_WARNINGS        0
-        #define BLITZEN_LOG_DEBUG           0
-        #define BLITZEN_LOG_TRACE           0
+        #define BLITZEN_LOG_COMPILED_LEVEL_CORE         Error
+        #define BLITZEN_LOG_COMPILED_LEVEL_EVENTS       Error
+        #define BLITZEN_LOG_COMPILED_LEVEL_VULKAN       Error
+        #define BLITZEN_LOG_COMPILED_LEVEL_LOADER       Trace
+        #define BLITZEN_LOG_COMPILED_LEVEL_PLATFORM     Error
+        #define BLITZEN_LOG_DEFAULT_LEVEL               Error
     #endif
 
+    // Overrides the starting levels, for example "Loader=Trace,Vulkan=Error" or "All=Info"
+    #define BLITZEN_LOG_LEVELS_ENVIRONMENT_VARIABLE     "BLITZEN_LOG_LEVELS"
+
+    // Messages that a single call site may log in each window, the rest are counted and reported as repeats. 0 removes the limit.
+    // BLIT_LOG_LIMITED sets a different limit for one call site
+    #define BLITZEN_LOG_SITE_LIMIT                      5
+    #define BLITZEN_LOG_SITE_WINDOW_SECONDS             1.0
+    // Call sites that can have repeats waiting to be reported, the repeats of any others are lost
+    #define BLITZEN_LOG_MAX_LIMITED_SITES               512
+
+    // When this is set, messages are formatted into a ring owned by the calling thread and written out by a background thread
+    #define BLITZEN_LOG_ASYNC               1
+    // Every message is also written to this file, leave it undefined to only log to the console
+    #define BLITZEN_LOG_FILE                "BlitzenLog.txt"
+    // Longer messages are truncated
+    #define BLITZEN_LOG_MESSAGE_SIZE        512
+    // Messages that each thread can have waiting for the background writer (must be a power of 2)
+    #define BLITZEN_LOG_RING_SIZE           256
+    // Threads past this number log synchronously
+    #define BLITZEN_LOG_MAX_THREADS         32
+    // How long the background writer sleeps when it finds nothing to write
+    #define BLITZEN_LOG_WRITER_SLEEP_MS     2
+
+    // When this is set, messages less severe than errors are stored as the id of their format string and their raw arguments.
+    // They are written to the binary file only and turned into text offline by BlitzenLogDecoder. Requires BLITZEN_LOG_ASYNC
+    #define BLITZEN_LOG_BINARY              0
+    #define BLITZEN_LOG_BINARY_FILE         "BlitzenLog.blog"
+    // Call sites past this number are formatted on the calling thread like normal messages
+    #define BLITZEN_LOG_MAX_FORMATS         4096
+
+    #if BLITZEN_LOG_BINARY && !BLITZEN_LOG_ASYNC
+        #error "Binary logging needs the background writer, set BLITZEN_LOG_ASYNC"
+    #endif
+
+    // Ordered from most to least severe, a channel shows every message up to its level
     enum class LogLevel : uint8_t
     {
         Fatal = 0,
         Error = 1, 
-        Info = 2, 
-        Warn = 3, 
+        Warn = 2, 
+        Info = 3, 
         Debug = 4, 
         Trace = 5,
 
         MaxLevel = 6
     };
 
-    void BlitLog(LogLevel level, const char* message, ...);
+    // Each subsystem logs to its own channel, which has its own level. Source files pick theirs by defining BLIT_LOG_CHANNEL before any include
+    enum class LogChannel : uint8_t
+    {
+        Core = 0,
+        Events = 1,
+        Vulkan = 2,
+        Loader = 3,
+        Platform = 4,
 
-    #if BLITZEN_LOG_FATAL
-        #define BLIT_FATAL(message, ...)     BlitzenCore::BlitLog(BlitzenCore::LogLevel::Fatal, message, ##__VA_ARGS__);
-    #else
-        #define BLIT_FATAL(message, ...)    ;
-    #endif
+        MaxChannels = 5
+    };
 
-    #if BLITZEN_LOG_ERROR
-        #define BLIT_ERROR(message, ...)     BlitzenCore::BlitLog(BlitzenCore::LogLevel::Error, message, ##__VA_ARGS__);
-    #else
-        #define BLIT_ERROR(message, ...)    ;
+    #ifndef BLIT_LOG_CHANNEL
+        #define BLIT_LOG_CHANNEL    Core
     #endif
 
-    #if BLITZEN_LOG_INFO
-        #define BLIT_INFO(message, ...)      BlitzenCore::BlitLog(BlitzenCore::LogLevel::Info, message, ##__VA_ARGS__);
-    #else
-        #define BLIT_INFO(message, ...)      ;
-    #endif
+    constexpr LogLevel logCompiledLevels[static_cast<size_t>(LogChannel::MaxChannels)] = 
+    {
+        LogLevel::BLITZEN_LOG_COMPILED_LEVEL_CORE, 
+        LogLevel::BLITZEN_LOG_COMPILED_LEVEL_EVENTS, 
+        LogLevel::BLITZEN_LOG_COMPILED_LEVEL_VULKAN, 
+        LogLevel::BLITZEN_LOG_COMPILED_LEVEL_LOADER, 
+        LogLevel::BLITZEN_LOG_COMPILED_LEVEL_PLATFORM
+    };
 
-    #if BLITZEN_LOG_WARNINGS
-        #define BLIT_WARN(message, ...)     BlitzenCore::BlitLog(BlitzenCore::LogLevel::Warn, message, ##__VA_ARGS__);
-    #else
-        #define BLIT_WARN(message, ...)     ;
-    #endif
+    // Runtime level of each channel. Defined in blitzenLogger.cpp
+    extern std::atomic<uint8_t> logChannelLevels[static_cast<size_t>(LogChannel::MaxChannels)];
 
-    #if BLITZEN_LOG_DEBUG
-        #define BLIT_DBLOG(message, ...)     BlitzenCore::BlitLog(BlitzenCore::LogLevel::Debug, message, __VA_ARGS__);
-    #else
-        #define BLIT_DBLOG(message, ...)    ;
-    #endif
+    constexpr uint8_t IsLogLevelCompiled(LogChannel channel, LogLevel level)
+    {
+        return level <= logCompiledLevels[static_cast<uint8_t>(channel)];
+    }
+
+    // The only check that a message pays for when its level is turned off
+    inline uint8_t IsLogLevelEnabled(LogChannel channel, LogLevel level)
+    {
+        return static_cast<uint8_t>(level) <= logChannelLevels[static_cast<uint8_t>(channel)].load(std::memory_order_relaxed);
+    }
+
+    // Levels past the channel's compiled level are clamped, since those messages no longer exist
+    void SetLogLevel(LogChannel channel, LogLevel level);
+    LogLevel GetLogLevel(LogChannel channel);
+
+    // State of a single call site, so that one hot message is limited without the others being affected
+    struct LogSite
+    {
+        constexpr LogSite(const char* siteFormat, const char* siteFile, uint32_t siteLine, LogLevel siteLevel, uint32_t siteLimit)
+            :format{siteFormat}, file{siteFile}, line{siteLine}, level{siteLevel}, limit{siteLimit}
+        {}
+
+        const char* format;
+        const char* file;
+        uint32_t line;
+        LogLevel level;
+        uint32_t limit;
+
+        // The window that count belongs to
+        std::atomic<uint64_t> window{0};
+        std::atomic<uint32_t> count{0};
+        // Messages dropped since the last report
+        std::atomic<uint32_t> suppressed{0};
+        std::atomic<uint8_t> bRegistered{0};
+    };
+
+    // Returns 0 if the call site has used up its messages for the current window. Fatal messages are always allowed
+    uint8_t LogSiteAllow(LogSite& site);
+
+    // Starts the background writer and opens the file sink. Messages logged before this are written synchronously
+    uint8_t LoggingInit();
+    // Writes every pending message and stops the background writer. Logging afterwards goes back to being synchronous
+    void LoggingShutdown();
+    // Blocks until every message logged before the call has reached the sinks
+    void LogFlush();
 
-    #if BLITZEN_LOG_TRACE
-        #define BLIT_TRACE(message, ...)     BlitzenCore::BlitLog(BlitzenCore::LogLevel::Trace, message, __VA_ARGS__);
+    void BlitLog(LogLevel level, const char* message, ...);
+
+    // Called once by every binary log call site. Returns the id of the format string, or 0 if there is no room for it
+    uint32_t RegisterLogFormat(LogLevel level, const char* format, const char* file, uint32_t line);
+
+    // Queues a message whose arguments were already encoded. The format string is only used if the message cannot be deferred
+    void BlitLogEncoded(LogLevel level, uint32_t formatId, const char* format, const uint8_t* pArgs, uint32_t argsSize);
+
+    template<typename... Args>
+    void BlitLogBinary(LogLevel level, uint32_t formatId, const char* format, const Args&... args)
+    {
+        uint8_t data[BLITZEN_LOG_MESSAGE_SIZE];
+        LogArgWriter writer{data, 0, BLITZEN_LOG_MESSAGE_SIZE};
+        (EncodeLogArg(writer, args), ...);
+        BlitLogEncoded(level, formatId, format, data, writer.size);
+    }
+
+    // The format is registered the first time that the call site is reached, every message after that only copies its arguments
+    #define BLIT_LOG_DEFERRED(level, message, ...)  { static const uint32_t blitLogFormatId = BlitzenCore::RegisterLogFormat(level, message, \
+                                                    __FILE__, __LINE__); BlitzenCore::BlitLogBinary(level, blitLogFormatId, message, ##__VA_ARGS__); }
+
+    // Fatal and error messages are always formatted immediately. Everything else is deferred when binary logging is on
+    #if BLITZEN_LOG_BINARY
+        #define BLIT_LOG_EMIT(level, message, ...)  if constexpr(level <= BlitzenCore::LogLevel::Error)                        \
+                                                    {                                                                           \
+                                                        BlitzenCore::BlitLog(level, message, ##__VA_ARGS__);                    \
+                                                    }                                                                           \
+                                                    else                                                                        \
+                                                    {                                                                           \
+                                                        BLIT_LOG_DEFERRED(level, message, ##__VA_ARGS__)                        \
+                                                    }
     #else
-        #define BLIT_TRACE(message, ...)    ;
+        #define BLIT_LOG_EMIT(level, message, ...)  BlitzenCore::BlitLog(level, message, ##__VA_ARGS__);
     #endif
+
+    // Logs to a specific channel with a specific limit of messages per window for the call site
+    #define BLIT_LOG_LIMITED(channel, level, limit, message, ...)                                                               \
+    {                                                                                                                           \
+        constexpr BlitzenCore::LogChannel blitLogChannel = BlitzenCore::LogChannel::channel;                                    \
+        constexpr BlitzenCore::LogLevel blitLogLevel = BlitzenCore::LogLevel::level;                                            \
+        if constexpr(BlitzenCore::IsLogLevelCompiled(blitLogChannel, blitLogLevel))                                             \
+        {                                                                                                                       \
+            if(BlitzenCore::IsLogLevelEnabled(blitLogChannel, blitLogLevel))                                                    \
+            {                                                                                                                   \
+                static BlitzenCore::LogSite blitLogSite{message, __FILE__, __LINE__, blitLogLevel, limit};                      \
+                if(!(limit) || BlitzenCore::LogSiteAllow(blitLogSite))                                                          \
+                {                                                                                                               \
+                    BLIT_LOG_EMIT(blitLogLevel, message, ##__VA_ARGS__)                                                         \
+                }                                                                                                               \
+            }                                                                                                                   \
+        }                                                                                                                       \
+    }
+
+    // Logs to a specific channel, for code that does not belong to its file's channel. E.g. BLIT_LOG(Loader, Info, "Loading %s", path)
+    #define BLIT_LOG(channel, level, message, ...)  BLIT_LOG_LIMITED(channel, level, BLITZEN_LOG_SITE_LIMIT, message, ##__VA_ARGS__)
+
+    #define BLIT_FATAL(message, ...)    BLIT_LOG(BLIT_LOG_CHANNEL, Fatal, message, ##__VA_ARGS__)
+    #define BLIT_ERROR(message, ...)    BLIT_LOG(BLIT_LOG_CHANNEL, Error, message, ##__VA_ARGS__)
+    #define BLIT_INFO(message, ...)     BLIT_LOG(BLIT_LOG_CHANNEL, Info, message, ##__VA_ARGS__)
+    #define BLIT_WARN(message, ...)     BLIT_LOG(BLIT_LOG_CHANNEL, Warn, message, ##__VA_ARGS__)
+    #define BLIT_DBLOG(message, ...)    BLIT_LOG(BLIT_LOG_CHANNEL, Debug, message, ##__VA_ARGS__)
+    #define BLIT_TRACE(message, ...)    BLIT_LOG(BLIT_LOG_CHANNEL, Trace, message, ##__VA_ARGS__)
 }
\ No newline at end of file
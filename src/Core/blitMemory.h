@@ -2,6 +2,13 @@
 
 #include "blitAssert.h"
 
+// Memory reports are appended to this file as one JSON object per line, leave it undefined to only keep them in memory
+#define BLITZEN_MEMORY_REPORT_FILE                  "BlitzenMemory.jsonl"
+#define BLITZEN_MEMORY_REPORT_INTERVAL_SECONDS      5.0
+// A warning is logged when a GPU heap uses more than this much of its budget, since the driver starts evicting past it
+#define BLITZEN_MEMORY_BUDGET_WARNING_RATIO         0.9
+#define BLITZEN_MEMORY_REPORT_MAX_HEAPS             16
+
 namespace BlitzenCore
 {
     enum class AllocationType : uint8_t
@@ -27,6 +34,46 @@ namespace BlitzenCore
         size_t typesAllocated[static_cast<size_t>(AllocationType::MaxTypes)];
     };
 
+    // What GPU allocations are used for. The renderer tags each of its allocations with one of these
+    enum class GpuMemoryCategory : uint8_t
+    {
+        Geometry = 0,
+        Textures = 1,
+        RenderTargets = 2,
+        // Buffers that have a copy for each frame in flight
+        PerFrame = 3,
+        // Materials, draw commands and other scene data that is not geometry
+        SceneData = 4,
+        Staging = 5,
+
+        MaxCategories = 6
+    };
+
+    // The renderer's view of one of the device's memory heaps
+    struct GpuHeapReport
+    {
+        // Bytes used by the whole process and the bytes it can use before the driver starts evicting
+        uint64_t usage;
+        uint64_t budget;
+        // Bytes in device memory blocks and the part of them that is actually allocated
+        uint64_t blockBytes;
+        uint64_t allocationBytes;
+        uint32_t blockCount;
+        uint32_t allocationCount;
+        uint8_t bDeviceLocal;
+    };
+
+    struct MemoryReport
+    {
+        AllocationData cpu;
+
+        size_t gpuCategories[static_cast<size_t>(GpuMemoryCategory::MaxCategories)];
+        size_t gpuCategoryPeaks[static_cast<size_t>(GpuMemoryCategory::MaxCategories)];
+
+        GpuHeapReport gpuHeaps[BLITZEN_MEMORY_REPORT_MAX_HEAPS];
+        uint32_t gpuHeapCount;
+    };
+
     void MemoryManagementInit();
     void MemoryManagementShutdown();
 
@@ -35,4 +82,13 @@ namespace BlitzenCore
     void BlitMemoryCopy(void* pDst, void* pSrc, size_t size);
     void BlitMemorySet(void* pDst, int32_t value, size_t size);
     void BlitMemoryZero(void* pDst, size_t size);
+
+    // Called by the renderer with the size that was actually allocated for a resource
+    void GpuMemoryTrackAllocation(GpuMemoryCategory category, size_t size);
+    void GpuMemoryTrackFree(GpuMemoryCategory category, size_t size);
+
+    // Fills the CPU allocations and the GPU categories. The GPU heaps are left empty for the renderer to fill
+    void GetMemoryReport(MemoryReport& report);
+    // Appends the report to BLITZEN_MEMORY_REPORT_FILE and warns about heaps that are close to their budget
+    uint8_t WriteMemoryReport(const MemoryReport& report, uint32_t frameIndex, double time);
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "blitLogger.h"
+
+#define BLITZEN_METRICS_FORMAT_CSV                  0
+#define BLITZEN_METRICS_FORMAT_JSON_LINES           1
+
+// Metrics that can be registered, their samples are stored for this many frames and then written out together
+#define BLITZEN_METRICS_MAX                         64
+#define BLITZEN_METRICS_FLUSH_FRAMES                120
+#define BLITZEN_METRICS_FORMAT                      BLITZEN_METRICS_FORMAT_CSV
+// Leave this undefined to keep the metrics from being written. The extension follows the format
+#define BLITZEN_METRICS_FILE_NAME                   "BlitzenMetrics"
+
+#ifdef BLITZEN_METRICS_FILE_NAME
+    #if BLITZEN_METRICS_FORMAT == BLITZEN_METRICS_FORMAT_CSV
+        #define BLITZEN_METRICS_FILE                BLITZEN_METRICS_FILE_NAME ".csv"
+    #else
+        #define BLITZEN_METRICS_FILE                BLITZEN_METRICS_FILE_NAME ".jsonl"
+    #endif
+#endif
+
+namespace BlitzenCore
+{
+    // Marks a metric that failed to register, adding to it or setting it does nothing
+    #define BLITZEN_INVALID_METRIC                  UINT32_MAX
+
+    enum class MetricType : uint8_t
+    {
+        // Added to during a frame and back to 0 after the frame is sampled
+        Counter = 0,
+        // Keeps its value until it is set again
+        Gauge = 1
+    };
+
+    // The name must outlive the metrics system. Metrics can only be registered before the first frame is sampled,
+    // so that every row of the file has the same columns
+    uint8_t MetricsRegister(const char* name, MetricType type, uint32_t& metric);
+
+    // Safe to call from any thread
+    void MetricAdd(uint32_t metric, int64_t value = 1);
+    void MetricSet(uint32_t metric, int64_t value);
+
+    // Takes the value of every metric for the frame and writes the stored frames once there are BLITZEN_METRICS_FLUSH_FRAMES of them
+    void MetricsSampleFrame(uint32_t frameIndex);
+
+    // Writes the frames that are left and closes the file
+    void MetricsShutdown();
+}
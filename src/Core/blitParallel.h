@@ -0,0 +1,130 @@
+#pragma once
+
+#include "blitJobs.h"
+
+// Fewest iterations that a chunk gets when the grain is picked automatically
+#define BLITZEN_PARALLEL_MIN_GRAIN                  64
+// Chunks that an automatic grain aims for, enough of them that stealing evens out uneven work
+#define BLITZEN_PARALLEL_TARGET_CHUNKS              64
+// A reduction keeps one partial result per chunk on the stack, a grain that would make more chunks than this is raised
+#define BLITZEN_PARALLEL_MAX_CHUNKS                 256
+
+namespace BlitzenCore
+{
+    // How [0, count) is split into chunks. It only depends on the count and the grain, never on the number of threads,
+    // so that a reduction combines its partial results the same way on every machine. A grain of 0 is picked automatically
+    inline size_t GetParallelChunkSize(size_t count, size_t grain)
+    {
+        size_t chunkSize = grain;
+        if(!chunkSize)
+        {
+            chunkSize = (count + BLITZEN_PARALLEL_TARGET_CHUNKS - 1) / BLITZEN_PARALLEL_TARGET_CHUNKS;
+            if(chunkSize < BLITZEN_PARALLEL_MIN_GRAIN)
+            {
+                chunkSize = BLITZEN_PARALLEL_MIN_GRAIN;
+            }
+        }
+        size_t minChunkSize = (count + BLITZEN_PARALLEL_MAX_CHUNKS - 1) / BLITZEN_PARALLEL_MAX_CHUNKS;
+        return chunkSize > minChunkSize ? chunkSize : (minChunkSize ? minChunkSize : 1);
+    }
+
+    template<typename F>
+    struct ParallelChunkData
+    {
+        const F* pFunction;
+        size_t count;
+        size_t chunkSize;
+        // Chunks are claimed in order by whichever thread is free, instead of being split between threads up front
+        std::atomic<size_t> nextChunk{0};
+    };
+
+    template<typename F>
+    void ParallelChunkJob(void* pData)
+    {
+        ParallelChunkData<F>& data = *reinterpret_cast<ParallelChunkData<F>*>(pData);
+        for(;;)
+        {
+            size_t chunk = data.nextChunk.fetch_add(1, std::memory_order_relaxed);
+            size_t begin = chunk * data.chunkSize;
+            if(begin >= data.count)
+            {
+                return;
+            }
+            size_t end = begin + data.chunkSize < data.count ? begin + data.chunkSize : data.count;
+            (*data.pFunction)(begin, end, chunk);
+        }
+    }
+
+    // Calls function(begin, end, chunkIndex) for every chunk of [0, count). The calling thread works on the chunks as well
+    template<typename F>
+    void ParallelForChunks(size_t count, size_t grain, const F& function)
+    {
+        size_t chunkSize = GetParallelChunkSize(count, grain);
+        size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+        uint32_t threadCount = JobSystemGetThreadCount();
+
+        if(chunkCount <= 1 || threadCount <= 1 || JobSystemGetThreadIndex() == BLITZEN_JOBS_INVALID_THREAD)
+        {
+            for(size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                size_t begin = chunk * chunkSize;
+                function(begin, begin + chunkSize < count ? begin + chunkSize : count, chunk);
+            }
+            return;
+        }
+
+        ParallelChunkData<F> data;
+        data.pFunction = &function;
+        data.count = count;
+        data.chunkSize = chunkSize;
+
+        // One job per helping thread, each of them keeps claiming chunks until there are none left
+        // External threads (the render thread) count towards the threads but not the workers, more helpers than that would not fit
+        uint32_t helperCount = static_cast<uint32_t>(chunkCount < threadCount ? chunkCount : threadCount) - 1;
+        JobDecl jobs[BLITZEN_JOBS_MAX_WORKERS];
+        if(helperCount > BLITZEN_JOBS_MAX_WORKERS)
+        {
+            helperCount = BLITZEN_JOBS_MAX_WORKERS;
+        }
+        for(uint32_t i = 0; i < helperCount; ++i)
+        {
+            jobs[i] = JobDecl{ParallelChunkJob<F>, &data};
+        }
+        JobCounter counter;
+        RunJobs(jobs, helperCount, &counter);
+        ParallelChunkJob<F>(&data);
+        WaitForCounter(&counter);
+    }
+
+    // Calls function(begin, end) over [0, count) in parallel. Outputs that are written by index end up in the same order as a plain loop
+    template<typename F>
+    void ParallelFor(size_t count, size_t grain, const F& function)
+    {
+        ParallelForChunks(count, grain, [&function](size_t begin, size_t end, size_t /*chunk*/)
+        {
+            function(begin, end);
+        });
+    }
+
+    // map(begin, end) returns the result of a chunk and combine(a, b) merges two results. The chunks' results are combined in chunk order
+    // on the calling thread, so the result is the same on every run even when combine is not associative (e.g. floating point sums)
+    template<typename T, typename MapF, typename CombineF>
+    T ParallelReduce(size_t count, size_t grain, const T& identity, const MapF& map, const CombineF& combine)
+    {
+        T partials[BLITZEN_PARALLEL_MAX_CHUNKS];
+        size_t chunkSize = GetParallelChunkSize(count, grain);
+        size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+        ParallelForChunks(count, chunkSize, [&partials, &map](size_t begin, size_t end, size_t chunk)
+        {
+            partials[chunk] = map(begin, end);
+        });
+
+        T result = identity;
+        for(size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            result = combine(result, partials[chunk]);
+        }
+        return result;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "blitLogger.h"
+#include "blitJobs.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#else
+    #include <chrono>
+#endif
+
+// When this is 0, the profiling macros compile to nothing
+#define BLITZEN_PROFILER                        1
+// Zones that each thread keeps, the oldest are overwritten when it fills up (must be a power of 2)
+#define BLITZEN_PROFILER_RING_SIZE              65536
+// Threads that are not job workers: the main thread, the render thread, the async I/O threads and the log writer, with room to spare
+#define BLITZEN_PROFILER_EXTRA_THREADS          8
+// Threads past this number are not profiled, the first one that is left out is reported
+#define BLITZEN_PROFILER_MAX_THREADS            (BLITZEN_JOBS_MAX_WORKERS + BLITZEN_PROFILER_EXTRA_THREADS)
+// Tracks for timelines that are not CPU threads (e.g. the GPU), and the zones that each of them keeps (must be a power of 2)
+#define BLITZEN_PROFILER_MAX_TRACKS             4
+#define BLITZEN_PROFILER_TRACK_SIZE             16384
+// The trace is written here on shutdown, it can be opened with chrome://tracing or ui.perfetto.dev
+#define BLITZEN_PROFILER_TRACE_FILE             "BlitzenTrace.json"
+
+namespace BlitzenCore
+{
+    // Starts the clock that zones are measured against. Zones recorded before this are still kept
+    uint8_t ProfilerInit();
+    // Exports the trace to BLITZEN_PROFILER_TRACE_FILE and frees the rings. Threads that record zones should have stopped by now
+    void ProfilerShutdown();
+
+    // Names the calling thread in the trace
+    void ProfilerSetThreadName(const char* name);
+
+    // Writes every zone that is still held by the threads' rings and the tracks as Chrome trace event JSON
+    uint8_t ProfilerExportTrace(const char* filepath);
+
+    // Microseconds since ProfilerInit on the platform clock, which is what track zones are measured in
+    double ProfilerGetTime();
+
+    // Creates a timeline that is shown as its own thread in the trace. Returns 0 if there is no room for it
+    uint8_t ProfilerCreateTrack(const char* name, uint32_t& track);
+    // Zones of a track are placed by the caller, so that timings that come from another clock can be lined up with the CPU zones.
+    // Each track should only be written to by one thread at a time
+    void ProfilerRecordTrackZone(uint32_t track, const char* name, double startMicroseconds, double durationMicroseconds);
+
+    #if BLITZEN_PROFILER
+        // Reads the timestamp counter where the CPU has one. Ticks are only converted to time when the trace is exported
+        inline uint64_t GetProfilerTicks()
+        {
+            #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+                return __rdtsc();
+            #elif defined(__x86_64__) || defined(__i386__)
+                return __rdtsc();
+            #else
+                return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            #endif
+        }
+
+        // The name must outlive the profiler, string literals are expected
+        void ProfilerRecordZone(const char* name, uint64_t startTicks, uint64_t endTicks);
+
+        class ProfileScope
+        {
+        public:
+            inline ProfileScope(const char* name) :m_name{name}, m_startTicks{GetProfilerTicks()} {}
+            inline ~ProfileScope() { ProfilerRecordZone(m_name, m_startTicks, GetProfilerTicks()); }
+
+        private:
+            const char* m_name;
+            uint64_t m_startTicks;
+        };
+
+        #define BLIT_PROFILE_CONCAT_INTERNAL(a, b)      a##b
+        #define BLIT_PROFILE_CONCAT(a, b)               BLIT_PROFILE_CONCAT_INTERNAL(a, b)
+        // Measures the rest of the enclosing scope
+        #define BLIT_PROFILE_SCOPE(name)                BlitzenCore::ProfileScope BLIT_PROFILE_CONCAT(blitProfileScope, __LINE__)(name);
+    #else
+        #define BLIT_PROFILE_SCOPE(name)
+    #endif
+}
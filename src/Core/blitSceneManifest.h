@@ -0,0 +1,87 @@
+#pragma once
+
+#include "blitLogger.h"
+#include "math.h"
+
+#include <string>
+#include <vector>
+
+// Read at startup. When it cannot be opened, the scenes that the engine always loaded are used, without any benchmark
+#define BLITZEN_SCENE_MANIFEST_FILE                 "Assets/Scenes.manifest"
+
+/*
+    The manifest is a text file with one entry on each line. Anything after a # is a comment, names cannot contain spaces
+
+    scene <name> <gltf path>
+    instance <scene name> <x> <y> <z> [scale]
+        Places one copy of the scene
+    array <scene name> <count> <x> <y> <z> <dx> <dy> <dz>
+        Places count copies of the scene, starting at x y z and moving by dx dy dz for each one
+    scenario <name> <duration> [warmup]
+        Starts a benchmark scenario that lasts for the duration (in seconds). Statistics are only kept after the warmup
+    camera <time> <x> <y> <z> <yaw> <pitch>
+        Adds a point to the camera path of the last scenario, in order of time. The camera moves in a straight line between points
+        and stays at the last one. Yaw and pitch are in radians
+    spin <scene name> <node> <x> <y> <z> <speed>
+        Turns a node of the scene around the axis, at the speed in radians per simulated second, in every instance of the scene.
+        Nodes are counted depth first from the scene's roots, every node after its parent, so 0 is the first root
+*/
+
+namespace BlitzenCore
+{
+    struct ManifestScene
+    {
+        std::string name;
+        std::string filepath;
+    };
+
+    struct ManifestInstance
+    {
+        // Index in the manifest's scenes
+        uint32_t scene;
+        glm::mat4 transform;
+    };
+
+    struct ManifestSpin
+    {
+        // Index in the manifest's scenes
+        uint32_t scene;
+        uint32_t node;
+        glm::vec3 axis;
+        float speed;
+    };
+
+    struct CameraPathPoint
+    {
+        double time;
+        glm::vec3 position;
+        float yaw;
+        float pitch;
+    };
+
+    struct BenchmarkScenario
+    {
+        std::string name;
+        double duration;
+        double warmup;
+        std::vector<CameraPathPoint> cameraPath;
+    };
+
+    struct SceneManifest
+    {
+        std::vector<ManifestScene> scenes;
+        std::vector<ManifestInstance> instances;
+        std::vector<BenchmarkScenario> scenarios;
+        std::vector<ManifestSpin> spins;
+    };
+
+    // Returns 0 if the file could not be opened or had an error, the manifest is left empty then. Errors are logged with their line
+    uint8_t LoadSceneManifest(const char* filepath, SceneManifest& manifest);
+
+    // The two scenes that the engine loaded before manifests existed, each placed once at the origin. Release builds add the 300 copies
+    // of the city that they always drew, Assets/StressTest.manifest places the same ones
+    void GetDefaultSceneManifest(SceneManifest& manifest);
+
+    // Position and rotation of the scenario's camera at the given time. Returns 0 if the scenario has no camera path
+    uint8_t GetCameraPathPoint(const BenchmarkScenario& scenario, double time, CameraPathPoint& point);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "blitJobs.h"
+
+#include <initializer_list>
+#include <mutex>
+
+// Tasks that a startup graph can hold
+#define BLITZEN_STARTUP_MAX_TASKS                   32
+// Tasks that one task can wait for
+#define BLITZEN_STARTUP_MAX_DEPENDENCIES            8
+// The startup report is written here as well as logged, since release builds strip Core's info messages. Leave it undefined to only log it
+#define BLITZEN_STARTUP_REPORT_FILE                 "BlitzenStartup.txt"
+
+namespace BlitzenCore
+{
+    // Returns 0 if the task failed, the tasks that wait for it are skipped then
+    typedef uint8_t (*pfnStartupTask)(void* pData);
+
+    enum class StartupTaskStatus : uint8_t
+    {
+        Pending,
+        Complete,
+        Failed,
+        // A task that it waited for failed or was skipped
+        Skipped
+    };
+
+    struct StartupTask
+    {
+        // Must outlive the profiler, string literals are expected
+        const char* name;
+        pfnStartupTask pfnFunction;
+        void* pData;
+        // Platform work (the window) that has to stay on the thread that runs the graph
+        uint8_t bMainThread;
+
+        uint32_t dependencies[BLITZEN_STARTUP_MAX_DEPENDENCIES];
+        uint32_t dependencyCount;
+
+        // Filled in while the graph runs
+        std::atomic<uint32_t> remainingDependencies;
+        StartupTaskStatus status;
+        uint32_t threadIndex;
+        // Milliseconds since the graph started
+        double startTime;
+        double endTime;
+
+        struct StartupGraph* pGraph;
+    };
+
+    // Tasks are added in an order where everything that a task waits for comes before it
+    struct StartupGraph
+    {
+        StartupTask tasks[BLITZEN_STARTUP_MAX_TASKS];
+        uint32_t taskCount = 0;
+
+        // Used while the graph runs. The start is in GetAbsoluteTime's seconds
+        double startTime = 0.0;
+        std::atomic<uint32_t> finishedTasks{0};
+        JobCounter jobs;
+        // Is 0 while the thread that runs the graph has something to do (a main thread task or the end of the graph)
+        JobCounter mainThreadIdle;
+        std::mutex mainThreadMutex;
+        uint32_t mainThreadQueue[BLITZEN_STARTUP_MAX_TASKS];
+        uint32_t mainThreadQueueCount = 0;
+    };
+
+    // Returns the index that later tasks wait for it with, or BLITZEN_STARTUP_MAX_TASKS if the task could not be added
+    uint32_t StartupAddTask(StartupGraph& graph, const char* name, pfnStartupTask pfnFunction, void* pData,
+    std::initializer_list<uint32_t> dependencies = {}, uint8_t bMainThread = 0);
+
+    // Runs every task on the job threads as soon as what it waits for is done, the calling thread helps until the graph is done.
+    // Reports how long each task took and the chain of tasks that the total waited on. Returns 0 if any task failed or was skipped
+    uint8_t StartupRun(StartupGraph& graph);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "blitLogger.h"
+
+#define BLITZEN_THREAD_AFFINITY_NONE                0
+// Each engine thread gets a physical core of its own, SMT siblings are left alone. The fastest cores go first,
+// and the main and render threads get the first ones
+#define BLITZEN_THREAD_AFFINITY_PHYSICAL_CORES      1
+// Every engine thread may run on any processor that shares the main thread's last level cache (CCX on multi-CCX parts)
+#define BLITZEN_THREAD_AFFINITY_CACHE_GROUP         2
+
+#define BLITZEN_THREAD_AFFINITY_POLICY              BLITZEN_THREAD_AFFINITY_PHYSICAL_CORES
+// When this is 0, the physical cores policy leaves out efficiency cores on hybrid machines, so workers only run on the fast ones
+#define BLITZEN_THREAD_AFFINITY_USE_EFFICIENCY_CORES 1
+
+namespace BlitzenCore
+{
+    enum class ThreadRole : uint8_t
+    {
+        Main = 0,
+        Render = 1,
+        Worker = 2
+    };
+
+    // Finds the processor topology and decides where each thread goes. Called before any of the threads is pinned.
+    // A core is only kept for the render thread if there is going to be one
+    uint8_t ThreadAffinityInit(uint8_t bRenderThread, uint8_t policy = BLITZEN_THREAD_AFFINITY_POLICY);
+
+    // Workers that fit the policy without sharing a core with each other, the main thread or the render thread.
+    // 0 when the policy leaves placement to the OS
+    uint32_t ThreadAffinityGetWorkerCount();
+
+    // Pins the calling thread. Workers are numbered from 0. Does nothing for the none policy or before initialization
+    void ThreadAffinityPinCurrentThread(ThreadRole role, uint32_t index = 0);
+}
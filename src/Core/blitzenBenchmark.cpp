@@ -0,0 +1,160 @@
+#include "blitBenchmark.h"
+#include "blitFrameStats.h"
+
+#include <stdio.h>
+
+namespace BlitzenCore
+{
+    struct BenchmarkState
+    {
+        std::vector<BenchmarkScenario> scenarios;
+        uint32_t currentScenario = 0;
+        // Simulated time since the scenario started
+        double scenarioTime = 0.0;
+        uint8_t bMeasuring = 0;
+        uint8_t bRunning = 0;
+
+        FILE* pFile = nullptr;
+    };
+
+    static BenchmarkState benchmarkState;
+
+    // The statistics are reset when measuring starts, so that the warmup and the scenarios before do not count. The scenario keeps
+    // every sample of its own, since a long one would not fit in the windows
+    static void StartMeasuring()
+    {
+        FrameStatsReset();
+        FrameStatsBeginCapture(BLITZEN_BENCHMARK_SKIPPED_FRAMES);
+        benchmarkState.bMeasuring = 1;
+    }
+
+    static void StartScenario(uint32_t index)
+    {
+        BenchmarkState& state = benchmarkState;
+        state.currentScenario = index;
+        state.scenarioTime = 0.0;
+        state.bMeasuring = 0;
+
+        const BenchmarkScenario& scenario = state.scenarios[index];
+        BLIT_LOG_LIMITED(Core, Info, 0, "Benchmark scenario %s started (%.1fs)", scenario.name.c_str(), scenario.duration)
+        if(scenario.warmup <= 0.0)
+        {
+            StartMeasuring();
+        }
+    }
+
+    static void FinishScenario()
+    {
+        BenchmarkState& state = benchmarkState;
+        const BenchmarkScenario& scenario = state.scenarios[state.currentScenario];
+
+        #ifdef BLITZEN_BENCHMARK_FILE
+            if(!state.pFile)
+            {
+                state.pFile = fopen(BLITZEN_BENCHMARK_FILE, "w");
+                if(state.pFile)
+                {
+                    fputs("scenario,statistic,samples,min,avg,p50,p95,p99,max,hitches\n", state.pFile);
+                }
+                else
+                {
+                    BLIT_ERROR("Failed to open %s for the benchmark results", BLITZEN_BENCHMARK_FILE)
+                }
+            }
+        #endif
+
+        for(uint8_t i = 0; i < static_cast<uint8_t>(FrameStatType::MaxTypes); ++i)
+        {
+            FrameStatType type = static_cast<FrameStatType>(i);
+            FrameStatSummary summary;
+            if(!FrameStatsGetCaptureSummary(type, summary))
+            {
+                continue;
+            }
+
+            BLIT_LOG_LIMITED(Core, Info, 0, "%s, %s (%u): avg %.3fms, p50 %.3fms, p95 %.3fms, p99 %.3fms, max %.3fms", scenario.name.c_str(),
+            FrameStatsGetName(type), summary.sampleCount, summary.average, summary.p50, summary.p95, summary.p99, summary.max)
+            if(state.pFile)
+            {
+                fprintf(state.pFile, "%s,%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%u\n", scenario.name.c_str(), FrameStatsGetName(type),
+                summary.sampleCount, summary.min, summary.average, summary.p50, summary.p95, summary.p99, summary.max, summary.windowHitches);
+            }
+        }
+
+        FrameStatsEndCapture();
+        if(state.pFile)
+        {
+            fflush(state.pFile);
+        }
+    }
+
+    uint8_t BenchmarkInit(const SceneManifest& manifest)
+    {
+        BenchmarkState& state = benchmarkState;
+        if(manifest.scenarios.empty())
+        {
+            return 0;
+        }
+
+        state.scenarios = manifest.scenarios;
+        state.bRunning = 1;
+        StartScenario(0);
+        return 1;
+    }
+
+    uint8_t BenchmarkIsRunning()
+    {
+        return benchmarkState.bRunning;
+    }
+
+    uint8_t BenchmarkStep(double step, CameraPathPoint& camera, uint8_t& bHasCamera)
+    {
+        BenchmarkState& state = benchmarkState;
+        bHasCamera = 0;
+        if(!state.bRunning)
+        {
+            return 0;
+        }
+
+        state.scenarioTime += step;
+        if(state.scenarioTime >= state.scenarios[state.currentScenario].duration)
+        {
+            FinishScenario();
+            if(state.currentScenario + 1 == state.scenarios.size())
+            {
+                BLIT_INFO("Benchmark finished after %u scenarios", static_cast<uint32_t>(state.scenarios.size()))
+                state.bRunning = 0;
+                return 0;
+            }
+            StartScenario(state.currentScenario + 1);
+        }
+
+        const BenchmarkScenario& scenario = state.scenarios[state.currentScenario];
+        if(!state.bMeasuring && state.scenarioTime >= scenario.warmup)
+        {
+            StartMeasuring();
+        }
+        bHasCamera = GetCameraPathPoint(scenario, state.scenarioTime, camera);
+        return 1;
+    }
+
+    void BenchmarkShutdown()
+    {
+        BenchmarkState& state = benchmarkState;
+        if(state.bRunning)
+        {
+            BLIT_WARN("Benchmark stopped during scenario %s", state.scenarios[state.currentScenario].name.c_str())
+            if(state.bMeasuring)
+            {
+                FinishScenario();
+            }
+            state.bRunning = 0;
+        }
+
+        if(state.pFile)
+        {
+            fclose(state.pFile);
+            state.pFile = nullptr;
+        }
+    }
+}
@@ -2,6 +2,8 @@
 
 #include "blitMemory.h"
 
+#include <atomic>
+
 #define BLIT_DYNAMIC_ARRAY_CAPACITY_MULTIPLIER      2
 
 namespace BlitCL
@@ -48,7 +50,7 @@ namespace BlitCL
             if(newSize > m_capacity)
             {
                 RearrangeCapacity(newSize);
-                BlitzenCore::BlitZeroMemory(m_pBlock, (m_capacity * sizeof(T)) - (m_size * sizeof(T)));
+                BlitzenCore::BlitMemoryZero(m_pBlock, (m_capacity * sizeof(T)) - (m_size * sizeof(T)));
             }
 
             m_size = newSize;
@@ -89,7 +91,7 @@ namespace BlitCL
         {
             if(m_size)
             {
-                BlitzenCore::BlitZeroMemory(m_pBlock, m_size * sizeof(T));
+                BlitzenCore::BlitMemoryZero(m_pBlock, m_size * sizeof(T));
                 m_size = 0;
             }
         }
@@ -126,4 +128,87 @@ namespace BlitCL
             BLIT_WARN("DynamicArray rearranged, this means that a memory allocation has taken place")
         }
     };
+
+
+
+    /*---------------------------------------------------------------------------------------------------------
+        Lock free queue for exactly one producer thread and one consumer thread. 
+        The capacity is fixed, so pushing never allocates, and it needs to be a power of 2
+    ----------------------------------------------------------------------------------------------------------*/
+    template<typename T, size_t Capacity>
+    class SpscRingBuffer
+    {
+        static_assert(Capacity && !(Capacity & (Capacity - 1)), "SpscRingBuffer capacity must be a power of 2");
+    public:
+
+        // Called by the producer. Returns 0 if the queue is full
+        uint8_t Push(const T& element)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if(head - m_tail.load(std::memory_order_acquire) == Capacity)
+            {
+                return 0;
+            }
+
+            m_elements[head & (Capacity - 1)] = element;
+            m_head.store(head + 1, std::memory_order_release);
+            return 1;
+        }
+
+        // Called by the consumer. Returns 0 if the queue is empty
+        uint8_t Pop(T& element)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if(tail == m_head.load(std::memory_order_acquire))
+            {
+                return 0;
+            }
+
+            element = m_elements[tail & (Capacity - 1)];
+            m_tail.store(tail + 1, std::memory_order_release);
+            return 1;
+        }
+
+        // Lets the producer write an element in place, instead of copying it in with Push. Returns nullptr if the queue is full
+        T* BeginPush()
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if(head - m_tail.load(std::memory_order_acquire) == Capacity)
+            {
+                return nullptr;
+            }
+            return &m_elements[head & (Capacity - 1)];
+        }
+        // Publishes the element returned by BeginPush to the consumer
+        void EndPush()
+        {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Lets the consumer read the oldest element in place. Returns nullptr if the queue is empty
+        T* Front()
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if(tail == m_head.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &m_elements[tail & (Capacity - 1)];
+        }
+        // Releases the element returned by Front back to the producer
+        void PopFront()
+        {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        inline size_t GetSize() { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+
+    private:
+
+        // The producer and the consumer each write one of these, so they are kept on separate cache lines
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) std::atomic<size_t> m_tail{0};
+
+        T m_elements[Capacity];
+    };
 }
\ No newline at end of file
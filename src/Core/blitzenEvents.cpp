@@ -1,4 +1,7 @@
+#define BLIT_LOG_CHANNEL    Events
+
 #include "blitEvents.h"
+#include "blitInputRecorder.h"
 #include "mainEngine.h"
 
 namespace BlitzenCore
@@ -99,6 +102,8 @@ namespace BlitzenCore
 
     uint8_t FireEvent(BlitEventType type, void* pSender, EventContext eventData)
     {
+        FlightRecorderRecordEvent(static_cast<uint16_t>(type));
+
         BlitCL::DynamicArray<RegisteredEvent>& events = pEventSystemState->registeredEvents[static_cast<size_t>(type)];
         if(!events.GetSize())
         {
@@ -168,6 +173,11 @@ namespace BlitzenCore
 
     void InputProcessKey(BlitKey key, uint8_t bPressed) 
     {
+        if(!InputRecordEvent(RecordedInputType::Key, static_cast<uint16_t>(key), bPressed, 0, 0))
+        {
+            return;
+        }
+
         // Check If the key has not already been flagged as the value of bPressed
         if (inputState.currentKeyboard.keys[static_cast<size_t>(key)] != bPressed) 
         {
@@ -183,6 +193,11 @@ namespace BlitzenCore
 
     void InputProcessButton(MouseButton button, uint8_t bPressed) 
     {
+        if(!InputRecordEvent(RecordedInputType::MouseButton, static_cast<uint16_t>(button), bPressed, 0, 0))
+        {
+            return;
+        }
+
         // If the state changed, fire an event.
         if (inputState.currentMouse.buttons[static_cast<size_t>(button)] != bPressed) 
         {
@@ -196,6 +211,11 @@ namespace BlitzenCore
 
     void InputProcessMouseMove(int16_t x, int16_t y) 
     {
+        if(!InputRecordEvent(RecordedInputType::MouseMove, 0, 0, x, y))
+        {
+            return;
+        }
+
         // Only process if actually different
         if (inputState.currentMouse.x != x || inputState.currentMouse.y != y) 
         {
@@ -213,6 +233,11 @@ namespace BlitzenCore
     
     void InputProcessMouseWheel(int8_t zDelta) 
     {
+        if(!InputRecordEvent(RecordedInputType::MouseWheel, 0, zDelta, 0, 0))
+        {
+            return;
+        }
+
         // No internal state to update, simply fires an event
         EventContext context;
         context.data.ui8[0] = zDelta;
@@ -0,0 +1,278 @@
+#include "blitFlightRecorder.h"
+#include "blitEvents.h"
+#include "Platform/blitPlatform.h"
+
+#include <stdio.h>
+// The median is found with a partial sort of the last frames
+#include <algorithm>
+
+namespace BlitzenCore
+{
+    #if BLITZEN_FLIGHT_RECORDER
+        static const char* framePhaseNames[static_cast<size_t>(FramePhase::MaxPhases)] =
+        {
+            "Pump messages", "Camera", "Culling", "Wait", "Record", "Submit", "Present", "Render wait"
+        };
+
+        static const char* eventTypeNames[] =
+        {
+            "EngineShutdown", "KeyPressed", "KeyReleased", "MouseButtonPressed", "MouseButtonReleased", "MouseMoved", "MouseWheel", "WindowResize",
+            "WindowFocus"
+        };
+        static_assert(sizeof(eventTypeNames) / sizeof(eventTypeNames[0]) == static_cast<size_t>(BlitEventType::MaxTypes), 
+        "Every event type needs a name in flight recorder dumps");
+
+        // Times are in seconds on the platform clock, durations in milliseconds
+        struct RecordedFrame
+        {
+            uint32_t frameIndex;
+            double startTime;
+            double duration;
+
+            double phaseStarts[static_cast<size_t>(FramePhase::MaxPhases)];
+            double phaseDurations[static_cast<size_t>(FramePhase::MaxPhases)];
+
+            uint32_t allocationCount;
+            uint64_t allocatedBytes;
+            uint32_t eventCount;
+        };
+
+        struct RecordedEvent
+        {
+            double time;
+            uint32_t frameIndex;
+            uint16_t type;
+        };
+
+        struct FlightRecorderState
+        {
+            RecordedFrame frames[BLITZEN_FLIGHT_RECORDER_FRAMES];
+            uint64_t frameCount = 0;
+
+            RecordedEvent events[BLITZEN_FLIGHT_RECORDER_EVENTS];
+            uint64_t eventCount = 0;
+
+            RecordedFrame currentFrame;
+            uint8_t bInFrame = 0;
+
+            // Phases are timed outside the current frame, since the render thread may end one while the main thread starts the next frame.
+            // Each phase is only ever timed by one thread
+            std::atomic<double> phaseStarts[static_cast<size_t>(FramePhase::MaxPhases)];
+            std::atomic<double> phaseDurations[static_cast<size_t>(FramePhase::MaxPhases)];
+
+            // Allocations can come from any thread
+            std::atomic<uint32_t> allocationCount{0};
+            std::atomic<uint64_t> allocatedBytes{0};
+
+            // Frames left until the trace of the last hitch is written, 0 when there is none waiting
+            uint32_t framesUntilDump = 0;
+            uint32_t hitchFrameIndex = 0;
+            // Hitches are ignored for a while after a dump, both because writing it is slow and because the trace already covers them
+            uint32_t cooldownFrames = 0;
+            uint32_t dumpCount = 0;
+
+            double medianScratch[BLITZEN_FLIGHT_RECORDER_MEDIAN_FRAMES];
+        };
+
+        static FlightRecorderState flightRecorderState;
+
+        void FlightRecorderBeginFrame(uint32_t frameIndex)
+        {
+            RecordedFrame& frame = flightRecorderState.currentFrame;
+            frame = RecordedFrame{};
+            frame.frameIndex = frameIndex;
+            frame.startTime = BlitzenPlatform::GetAbsoluteTime();
+            flightRecorderState.allocationCount.store(0, std::memory_order_relaxed);
+            flightRecorderState.allocatedBytes.store(0, std::memory_order_relaxed);
+            flightRecorderState.bInFrame = 1;
+        }
+
+        void FlightRecorderBeginPhase(FramePhase phase)
+        {
+            flightRecorderState.phaseStarts[static_cast<uint8_t>(phase)].store(BlitzenPlatform::GetAbsoluteTime(), std::memory_order_relaxed);
+        }
+
+        void FlightRecorderEndPhase(FramePhase phase)
+        {
+            FlightRecorderState& state = flightRecorderState;
+            uint8_t index = static_cast<uint8_t>(phase);
+            // A phase that happens more than once in a frame is added up, it is shown where it started the last time
+            double duration = (BlitzenPlatform::GetAbsoluteTime() - state.phaseStarts[index].load(std::memory_order_relaxed)) * 1000.0;
+            // Added with a CAS, since the main thread may be taking the durations for its frame at the same time
+            double current = state.phaseDurations[index].load(std::memory_order_relaxed);
+            while(!state.phaseDurations[index].compare_exchange_weak(current, current + duration, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void FlightRecorderRecordEvent(uint16_t type)
+        {
+            RecordedEvent& event = flightRecorderState.events[flightRecorderState.eventCount & (BLITZEN_FLIGHT_RECORDER_EVENTS - 1)];
+            event.time = BlitzenPlatform::GetAbsoluteTime();
+            event.frameIndex = flightRecorderState.currentFrame.frameIndex;
+            event.type = type;
+            ++flightRecorderState.eventCount;
+            ++flightRecorderState.currentFrame.eventCount;
+        }
+
+        void FlightRecorderCountAllocation(size_t size)
+        {
+            flightRecorderState.allocationCount.fetch_add(1, std::memory_order_relaxed);
+            flightRecorderState.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        // Median of the frames before the current one, or 0 if there are not enough of them yet
+        static double GetMedianFrameTime()
+        {
+            uint64_t frameCount = flightRecorderState.frameCount;
+            if(frameCount < BLITZEN_FLIGHT_RECORDER_MEDIAN_FRAMES / 2)
+            {
+                return 0.0;
+            }
+
+            uint32_t count = static_cast<uint32_t>(frameCount < BLITZEN_FLIGHT_RECORDER_MEDIAN_FRAMES ? frameCount : BLITZEN_FLIGHT_RECORDER_MEDIAN_FRAMES);
+            double* pScratch = flightRecorderState.medianScratch;
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                pScratch[i] = flightRecorderState.frames[(frameCount - 1 - i) & (BLITZEN_FLIGHT_RECORDER_FRAMES - 1)].duration;
+            }
+            std::nth_element(pScratch, pScratch + count / 2, pScratch + count);
+            return pScratch[count / 2];
+        }
+
+        static uint8_t WriteFrames(const char* filepath, uint64_t firstFrame, uint64_t endFrame)
+        {
+            FILE* pFile = fopen(filepath, "w");
+            if(!pFile)
+            {
+                BLIT_ERROR("Failed to open %s for the flight recorder", filepath)
+                return 0;
+            }
+
+            const FlightRecorderState& state = flightRecorderState;
+            double baseTime = state.frames[firstFrame & (BLITZEN_FLIGHT_RECORDER_FRAMES - 1)].startTime;
+
+            fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", pFile);
+            fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main loop\"}},\n", pFile);
+            fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Events\"}}", pFile);
+
+            uint32_t firstFrameIndex = 0;
+            for(uint64_t f = firstFrame; f < endFrame; ++f)
+            {
+                const RecordedFrame& frame = state.frames[f & (BLITZEN_FLIGHT_RECORDER_FRAMES - 1)];
+                if(f == firstFrame)
+                {
+                    firstFrameIndex = frame.frameIndex;
+                }
+                double start = (frame.startTime - baseTime) * 1000000.0;
+
+                fprintf(pFile, ",\n{\"name\":\"Frame %u\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+                "\"args\":{\"allocations\":%u,\"allocatedBytes\":%llu,\"events\":%u}}", frame.frameIndex, start, frame.duration * 1000.0,
+                frame.allocationCount, static_cast<unsigned long long>(frame.allocatedBytes), frame.eventCount);
+
+                for(size_t p = 0; p < static_cast<size_t>(FramePhase::MaxPhases); ++p)
+                {
+                    if(frame.phaseDurations[p] > 0.0)
+                    {
+                        fprintf(pFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}", framePhaseNames[p],
+                        (frame.phaseStarts[p] - baseTime) * 1000000.0, frame.phaseDurations[p] * 1000.0);
+                    }
+                }
+
+                fprintf(pFile, ",\n{\"name\":\"Allocations\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"count\":%u}}", start,
+                frame.allocationCount);
+            }
+
+            // Only the events of the written frames that the event ring still holds
+            uint64_t eventCount = state.eventCount;
+            uint64_t firstEvent = eventCount > BLITZEN_FLIGHT_RECORDER_EVENTS ? eventCount - BLITZEN_FLIGHT_RECORDER_EVENTS : 0;
+            for(uint64_t e = firstEvent; e < eventCount; ++e)
+            {
+                const RecordedEvent& event = state.events[e & (BLITZEN_FLIGHT_RECORDER_EVENTS - 1)];
+                if(event.frameIndex < firstFrameIndex || event.time < baseTime)
+                {
+                    continue;
+                }
+                const char* name = event.type < sizeof(eventTypeNames) / sizeof(eventTypeNames[0]) ? eventTypeNames[event.type] : "Unknown";
+                fprintf(pFile, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":%.3f}", name,
+                (event.time - baseTime) * 1000000.0);
+            }
+
+            fputs("\n]}\n", pFile);
+            fclose(pFile);
+            return 1;
+        }
+
+        void FlightRecorderEndFrame()
+        {
+            FlightRecorderState& state = flightRecorderState;
+            if(!state.bInFrame)
+            {
+                return;
+            }
+            state.bInFrame = 0;
+
+            RecordedFrame& frame = state.currentFrame;
+            frame.duration = (BlitzenPlatform::GetAbsoluteTime() - frame.startTime) * 1000.0;
+            frame.allocationCount = state.allocationCount.load(std::memory_order_relaxed);
+            frame.allocatedBytes = state.allocatedBytes.load(std::memory_order_relaxed);
+            for(size_t p = 0; p < static_cast<size_t>(FramePhase::MaxPhases); ++p)
+            {
+                frame.phaseStarts[p] = state.phaseStarts[p].load(std::memory_order_relaxed);
+                frame.phaseDurations[p] = state.phaseDurations[p].exchange(0.0, std::memory_order_relaxed);
+            }
+
+            if(state.cooldownFrames)
+            {
+                --state.cooldownFrames;
+            }
+            else if(!state.framesUntilDump && state.dumpCount < BLITZEN_FLIGHT_RECORDER_MAX_DUMPS)
+            {
+                double median = GetMedianFrameTime();
+                if(median > 0.0 && frame.duration > median * BLITZEN_FLIGHT_RECORDER_HITCH_FACTOR &&
+                frame.duration > BLITZEN_FLIGHT_RECORDER_MIN_HITCH_MS)
+                {
+                    BLIT_WARN("Frame %u took %.2fms against a median of %.2fms, its trace will be written", frame.frameIndex, frame.duration, median)
+                    state.hitchFrameIndex = frame.frameIndex;
+                    state.framesUntilDump = BLITZEN_FLIGHT_RECORDER_FRAMES_AFTER + 1;
+                }
+            }
+
+            state.frames[state.frameCount & (BLITZEN_FLIGHT_RECORDER_FRAMES - 1)] = frame;
+            ++state.frameCount;
+
+            if(state.framesUntilDump && !--state.framesUntilDump)
+            {
+                uint64_t framesToWrite = BLITZEN_FLIGHT_RECORDER_FRAMES_BEFORE + BLITZEN_FLIGHT_RECORDER_FRAMES_AFTER + 1;
+                if(framesToWrite > BLITZEN_FLIGHT_RECORDER_FRAMES)
+                {
+                    framesToWrite = BLITZEN_FLIGHT_RECORDER_FRAMES;
+                }
+                if(framesToWrite > state.frameCount)
+                {
+                    framesToWrite = state.frameCount;
+                }
+
+                char filepath[256];
+                snprintf(filepath, sizeof(filepath), BLITZEN_FLIGHT_RECORDER_FILE, state.hitchFrameIndex);
+                if(WriteFrames(filepath, state.frameCount - framesToWrite, state.frameCount))
+                {
+                    BLIT_INFO("Hitch trace of frame %u written to %s", state.hitchFrameIndex, filepath)
+                }
+                ++state.dumpCount;
+                state.cooldownFrames = BLITZEN_FLIGHT_RECORDER_FRAMES_BEFORE;
+            }
+        }
+
+        uint8_t FlightRecorderDump(const char* filepath)
+        {
+            uint64_t frameCount = flightRecorderState.frameCount;
+            if(!frameCount)
+            {
+                return 0;
+            }
+            uint64_t firstFrame = frameCount > BLITZEN_FLIGHT_RECORDER_FRAMES ? frameCount - BLITZEN_FLIGHT_RECORDER_FRAMES : 0;
+            return WriteFrames(filepath, firstFrame, frameCount);
+        }
+    #endif
+}
@@ -0,0 +1,154 @@
+#include "blitFramePacer.h"
+#include "blitFrameStats.h"
+#include "blitMetrics.h"
+#include "blitProfiler.h"
+#include "Platform/blitPlatform.h"
+
+namespace BlitzenCore
+{
+    // All times are in seconds on the platform clock
+    struct FramePacerState
+    {
+        double targetFrameTime = 0.0;
+
+        double nextDeadline = 0.0;
+        double lastFrameStart = 0.0;
+
+        // The worst recent oversleep, it decides how early the pacer stops sleeping and starts spinning
+        double oversleepPeak = BLITZEN_FRAME_PACER_MIN_SPIN_MS / 1000.0;
+
+        // How late the pacer itself woke up after the deadline
+        double totalOvershoot = 0.0;
+        double maxOvershoot = 0.0;
+        double totalSleep = 0.0;
+        double totalSpin = 0.0;
+        uint64_t pacedFrames = 0;
+        // Frames that were already past their deadline and did not wait
+        uint64_t lateFrames = 0;
+
+        uint32_t waitMetric = BLITZEN_INVALID_METRIC;
+    };
+
+    static FramePacerState framePacerState;
+
+    void FramePacerInit(double targetFrameTime)
+    {
+        framePacerState = FramePacerState{};
+        FramePacerSetTarget(targetFrameTime);
+        MetricsRegister("PacerWaitUs", MetricType::Counter, framePacerState.waitMetric);
+    }
+
+    void FramePacerSetTarget(double targetFrameTime)
+    {
+        framePacerState.targetFrameTime = targetFrameTime > 0.0 ? targetFrameTime : 0.0;
+        // The schedule starts over from the next frame
+        framePacerState.nextDeadline = 0.0;
+        if(targetFrameTime > 0.0)
+        {
+            BLIT_INFO("Frame pacer targeting %.3fms (%.1f fps)", targetFrameTime * 1000.0, 1.0 / targetFrameTime)
+        }
+        else
+        {
+            BLIT_INFO("Frame pacer disabled")
+        }
+    }
+
+    double FramePacerGetTarget()
+    {
+        return framePacerState.targetFrameTime;
+    }
+
+    void FramePacerWait()
+    {
+        FramePacerState& state = framePacerState;
+        if(state.targetFrameTime <= 0.0)
+        {
+            return;
+        }
+
+        BLIT_PROFILE_SCOPE("Frame pacing")
+        double now = BlitzenPlatform::GetAbsoluteTime();
+        if(state.nextDeadline == 0.0 || now > state.nextDeadline + state.targetFrameTime)
+        {
+            if(state.nextDeadline != 0.0)
+            {
+                ++state.lateFrames;
+            }
+            state.nextDeadline = now;
+        }
+
+        double waitStart = now;
+        double deadline = state.nextDeadline;
+        double spinMargin = state.oversleepPeak;
+        if(spinMargin < BLITZEN_FRAME_PACER_MIN_SPIN_MS / 1000.0)
+        {
+            spinMargin = BLITZEN_FRAME_PACER_MIN_SPIN_MS / 1000.0;
+        }
+        else if(spinMargin > BLITZEN_FRAME_PACER_MAX_SPIN_MS / 1000.0)
+        {
+            spinMargin = BLITZEN_FRAME_PACER_MAX_SPIN_MS / 1000.0;
+        }
+
+        // Sleeps for the coarse part of the wait and measures by how much the OS overslept
+        double sleepTime = deadline - now - spinMargin;
+        if(sleepTime > 0.0)
+        {
+            BlitzenPlatform::PSleepPrecise(sleepTime);
+            double sleepEnd = BlitzenPlatform::GetAbsoluteTime();
+            double oversleep = (sleepEnd - now) - sleepTime;
+            state.oversleepPeak *= BLITZEN_FRAME_PACER_OVERSLEEP_DECAY;
+            if(oversleep > state.oversleepPeak)
+            {
+                state.oversleepPeak = oversleep;
+            }
+            state.totalSleep += sleepEnd - now;
+            now = sleepEnd;
+        }
+
+        // Spins for whatever is left, the clock is precise even where sleeps are not
+        double spinStart = now;
+        while(now < deadline)
+        {
+            now = BlitzenPlatform::GetAbsoluteTime();
+        }
+        state.totalSpin += now - spinStart;
+
+        double overshoot = now - deadline;
+        state.totalOvershoot += overshoot;
+        if(overshoot > state.maxOvershoot)
+        {
+            state.maxOvershoot = overshoot;
+        }
+
+        // Jitter is the distance from the target between the starts of two paced frames. There is none for the first frame after a reset
+        if(state.lastFrameStart != 0.0)
+        {
+            double error = (now - state.lastFrameStart) - state.targetFrameTime;
+            FrameStatsRecord(FrameStatType::PacingError, (error < 0.0 ? -error : error) * 1000.0);
+        }
+        MetricAdd(state.waitMetric, static_cast<int64_t>((now - waitStart) * 1000000.0));
+
+        state.lastFrameStart = now;
+        state.nextDeadline += state.targetFrameTime;
+        ++state.pacedFrames;
+    }
+
+    void FramePacerReset()
+    {
+        framePacerState.nextDeadline = 0.0;
+        framePacerState.lastFrameStart = 0.0;
+    }
+
+    void FramePacerLogSummary()
+    {
+        const FramePacerState& state = framePacerState;
+        if(!state.pacedFrames)
+        {
+            return;
+        }
+
+        BLIT_LOG_LIMITED(Core, Info, 0, "Frame pacer: %llu frames (%llu late), overshoot avg %.3fms max %.3fms, slept %.2fs, spun %.2fs",
+        static_cast<unsigned long long>(state.pacedFrames), static_cast<unsigned long long>(state.lateFrames),
+        state.totalOvershoot * 1000.0 / static_cast<double>(state.pacedFrames), state.maxOvershoot * 1000.0, state.totalSleep, state.totalSpin)
+    }
+}
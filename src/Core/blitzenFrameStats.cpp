@@ -0,0 +1,220 @@
+#include "blitFrameStats.h"
+
+// Percentiles are found by sorting a copy of the window when a summary is asked for
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+namespace BlitzenCore
+{
+    static const char* frameStatNames[static_cast<size_t>(FrameStatType::MaxTypes)] = {"CPU frame", "GPU frame", "Present interval", "Pacing error"};
+
+    struct FrameStatWindow
+    {
+        double samples[BLITZEN_FRAME_STATS_WINDOW];
+        // Total samples ever recorded, the window holds the last ones
+        uint64_t sampleCount = 0;
+
+        double runningAverage = 0.0;
+        uint64_t totalHitches = 0;
+
+        // Every sample since the capture began, and the ones that are still to be dropped
+        std::vector<double> captured;
+        uint32_t captureSkip = 0;
+    };
+
+    struct FrameStatsState
+    {
+        FrameStatWindow windows[static_cast<size_t>(FrameStatType::MaxTypes)];
+
+        // Scratch space for the summary, so that asking for one does not allocate
+        double sorted[BLITZEN_FRAME_STATS_WINDOW];
+
+        uint8_t bCapturing = 0;
+
+        // The render thread records its own statistics while the main thread records, summarizes or resets them
+        std::mutex mutex;
+    };
+
+    static FrameStatsState frameStatsState;
+
+    void FrameStatsRecord(FrameStatType type, double milliseconds)
+    {
+        std::lock_guard<std::mutex> lock(frameStatsState.mutex);
+        FrameStatWindow& window = frameStatsState.windows[static_cast<uint8_t>(type)];
+
+        // The median is too expensive to find for every sample, so hitches over the whole run are judged against a running average
+        if(window.sampleCount >= BLITZEN_FRAME_STATS_WARMUP_SAMPLES && milliseconds > window.runningAverage * BLITZEN_FRAME_STATS_HITCH_FACTOR)
+        {
+            ++window.totalHitches;
+        }
+        window.runningAverage = window.sampleCount ? window.runningAverage * 0.95 + milliseconds * 0.05 : milliseconds;
+
+        window.samples[window.sampleCount % BLITZEN_FRAME_STATS_WINDOW] = milliseconds;
+        ++window.sampleCount;
+
+        if(frameStatsState.bCapturing)
+        {
+            if(window.captureSkip)
+            {
+                --window.captureSkip;
+            }
+            else
+            {
+                window.captured.push_back(milliseconds);
+            }
+        }
+    }
+
+    // Nearest rank, so that the result is always one of the samples
+    static double GetPercentile(const double* pSorted, uint32_t count, double percentile)
+    {
+        uint32_t rank = static_cast<uint32_t>(percentile * count + 0.999999);
+        return pSorted[rank ? rank - 1 : 0];
+    }
+
+    // Sorts the samples in place and fills everything but the totals
+    static void SummarizeSamples(double* pSorted, uint32_t count, FrameStatSummary& summary)
+    {
+        double sum = 0.0;
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            sum += pSorted[i];
+        }
+        std::sort(pSorted, pSorted + count);
+
+        summary.sampleCount = count;
+        summary.min = pSorted[0];
+        summary.max = pSorted[count - 1];
+        summary.average = sum / count;
+        summary.p50 = GetPercentile(pSorted, count, 0.50);
+        summary.p95 = GetPercentile(pSorted, count, 0.95);
+        summary.p99 = GetPercentile(pSorted, count, 0.99);
+
+        // Everything past the first hitch is sorted after it
+        double hitchThreshold = summary.p50 * BLITZEN_FRAME_STATS_HITCH_FACTOR;
+        summary.windowHitches = static_cast<uint32_t>(pSorted + count - std::upper_bound(pSorted, pSorted + count, hitchThreshold));
+    }
+
+    uint8_t FrameStatsGetSummary(FrameStatType type, FrameStatSummary& summary)
+    {
+        std::lock_guard<std::mutex> lock(frameStatsState.mutex);
+        FrameStatWindow& window = frameStatsState.windows[static_cast<uint8_t>(type)];
+        if(!window.sampleCount)
+        {
+            return 0;
+        }
+
+        uint32_t count = static_cast<uint32_t>(window.sampleCount < BLITZEN_FRAME_STATS_WINDOW ? window.sampleCount : BLITZEN_FRAME_STATS_WINDOW);
+        double* pSorted = frameStatsState.sorted;
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            pSorted[i] = window.samples[i];
+        }
+        SummarizeSamples(pSorted, count, summary);
+
+        summary.totalSamples = window.sampleCount;
+        summary.totalHitches = window.totalHitches;
+        return 1;
+    }
+
+    void FrameStatsLogSummary()
+    {
+        for(uint8_t i = 0; i < static_cast<uint8_t>(FrameStatType::MaxTypes); ++i)
+        {
+            FrameStatSummary summary;
+            if(!FrameStatsGetSummary(static_cast<FrameStatType>(i), summary))
+            {
+                continue;
+            }
+
+            BLIT_LOG_LIMITED(Core, Info, 0, "%s (last %u): min %.3fms, avg %.3fms, p50 %.3fms, p95 %.3fms, p99 %.3fms, max %.3fms, %u hitches",
+            frameStatNames[i], summary.sampleCount, summary.min, summary.average, summary.p50, summary.p95, summary.p99, summary.max,
+            summary.windowHitches)
+            BLIT_LOG_LIMITED(Core, Info, 0, "%s (whole run): %llu samples, %llu hitches", frameStatNames[i],
+            static_cast<unsigned long long>(summary.totalSamples), static_cast<unsigned long long>(summary.totalHitches))
+        }
+    }
+
+    void FrameStatsWriteSummary()
+    {
+        #ifdef BLITZEN_FRAME_STATS_FILE
+            FILE* pFile = fopen(BLITZEN_FRAME_STATS_FILE, "w");
+            if(!pFile)
+            {
+                BLIT_LOG(Core, Error, "Failed to open %s for the frame statistics", BLITZEN_FRAME_STATS_FILE)
+                return;
+            }
+
+            fputs("statistic,samples,min,avg,p50,p95,p99,max,hitches,total_samples,total_hitches\n", pFile);
+            for(uint8_t i = 0; i < static_cast<uint8_t>(FrameStatType::MaxTypes); ++i)
+            {
+                FrameStatSummary summary;
+                if(!FrameStatsGetSummary(static_cast<FrameStatType>(i), summary))
+                {
+                    continue;
+                }
+
+                fprintf(pFile, "%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%u,%llu,%llu\n", frameStatNames[i], summary.sampleCount, summary.min,
+                summary.average, summary.p50, summary.p95, summary.p99, summary.max, summary.windowHitches,
+                static_cast<unsigned long long>(summary.totalSamples), static_cast<unsigned long long>(summary.totalHitches));
+            }
+            fclose(pFile);
+        #endif
+    }
+
+    const char* FrameStatsGetName(FrameStatType type)
+    {
+        return type < FrameStatType::MaxTypes ? frameStatNames[static_cast<uint8_t>(type)] : "Unknown";
+    }
+
+    void FrameStatsReset()
+    {
+        std::lock_guard<std::mutex> lock(frameStatsState.mutex);
+        for(FrameStatWindow& window : frameStatsState.windows)
+        {
+            window.sampleCount = 0;
+            window.runningAverage = 0.0;
+            window.totalHitches = 0;
+        }
+    }
+
+    void FrameStatsBeginCapture(uint32_t skippedSamples)
+    {
+        std::lock_guard<std::mutex> lock(frameStatsState.mutex);
+        for(FrameStatWindow& window : frameStatsState.windows)
+        {
+            window.captured.clear();
+            window.captureSkip = skippedSamples;
+        }
+        frameStatsState.bCapturing = 1;
+    }
+
+    uint8_t FrameStatsGetCaptureSummary(FrameStatType type, FrameStatSummary& summary)
+    {
+        std::lock_guard<std::mutex> lock(frameStatsState.mutex);
+        FrameStatWindow& window = frameStatsState.windows[static_cast<uint8_t>(type)];
+        if(window.captured.empty())
+        {
+            return 0;
+        }
+
+        // Sorting does not change what the summary describes, so the samples are sorted where they are
+        SummarizeSamples(window.captured.data(), static_cast<uint32_t>(window.captured.size()), summary);
+        summary.totalSamples = window.sampleCount;
+        summary.totalHitches = window.totalHitches;
+        return 1;
+    }
+
+    void FrameStatsEndCapture()
+    {
+        std::lock_guard<std::mutex> lock(frameStatsState.mutex);
+        for(FrameStatWindow& window : frameStatsState.windows)
+        {
+            std::vector<double>().swap(window.captured);
+            window.captureSkip = 0;
+        }
+        frameStatsState.bCapturing = 0;
+    }
+}
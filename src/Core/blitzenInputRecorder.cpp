@@ -0,0 +1,228 @@
+// Input recording belongs with the events that it records
+#define BLIT_LOG_CHANNEL    Events
+
+#include "blitInputRecorder.h"
+
+// Recordings are written and read with the C file functions
+#include <stdio.h>
+
+namespace BlitzenCore
+{
+    struct InputRecorderState
+    {
+        InputRecordingMode mode = InputRecordingMode::Inactive;
+
+        FILE* pFile = nullptr;
+        InputRecordingHeader header;
+
+        // Events waiting to be written to the file when recording
+        RecordedInputEvent batch[BLITZEN_INPUT_RECORDING_BATCH_SIZE];
+        uint32_t batchSize = 0;
+
+        // The whole recording when replaying
+        RecordedInputEvent* pReplayEvents = nullptr;
+        uint32_t replayCursor = 0;
+
+        uint32_t currentFrame = 0;
+
+        // Set while the recorder itself is feeding events to the input system, so that they are not mistaken for live input
+        uint8_t bDispatching = 0;
+    };
+
+    static InputRecorderState recorderState;
+
+    static void FlushRecordedBatch()
+    {
+        if(recorderState.batchSize)
+        {
+            fwrite(recorderState.batch, sizeof(RecordedInputEvent), recorderState.batchSize, recorderState.pFile);
+            recorderState.header.eventCount += recorderState.batchSize;
+            recorderState.batchSize = 0;
+        }
+    }
+
+    uint8_t InputRecordingInit(InputRecordingMode mode, const char* filepath, double replayDeltaTime)
+    {
+        if(mode == InputRecordingMode::Inactive)
+        {
+            return 1;
+        }
+
+        if(mode == InputRecordingMode::Record)
+        {
+            recorderState.pFile = fopen(filepath, "wb");
+            if(!recorderState.pFile)
+            {
+                BLIT_ERROR("Failed to open %s for input recording", filepath)
+                return 0;
+            }
+
+            recorderState.header.magic = BLITZEN_INPUT_RECORDING_MAGIC;
+            recorderState.header.version = BLITZEN_INPUT_RECORDING_VERSION;
+            recorderState.header.fixedDeltaTime = replayDeltaTime;
+            recorderState.header.eventCount = 0;
+            recorderState.header.frameCount = 0;
+            // The header is written now to reserve its space and rewritten with the final counts on shutdown
+            fwrite(&recorderState.header, sizeof(InputRecordingHeader), 1, recorderState.pFile);
+
+            recorderState.mode = mode;
+            BLIT_INFO("Recording input to %s", filepath)
+            return 1;
+        }
+
+        FILE* pFile = fopen(filepath, "rb");
+        if(!pFile)
+        {
+            BLIT_ERROR("Failed to open input recording %s", filepath)
+            return 0;
+        }
+
+        if(fread(&recorderState.header, sizeof(InputRecordingHeader), 1, pFile) != 1 ||
+        recorderState.header.magic != BLITZEN_INPUT_RECORDING_MAGIC || recorderState.header.version != BLITZEN_INPUT_RECORDING_VERSION)
+        {
+            BLIT_ERROR("%s is not a valid input recording", filepath)
+            fclose(pFile);
+            return 0;
+        }
+
+        if(recorderState.header.eventCount)
+        {
+            recorderState.pReplayEvents = reinterpret_cast<RecordedInputEvent*>(BlitAlloc(AllocationType::Engine,
+            recorderState.header.eventCount * sizeof(RecordedInputEvent)));
+            size_t eventsRead = fread(recorderState.pReplayEvents, sizeof(RecordedInputEvent), recorderState.header.eventCount, pFile);
+            if(eventsRead != recorderState.header.eventCount)
+            {
+                BLIT_WARN("Input recording %s is truncated, replaying %u of %u events", filepath,
+                static_cast<uint32_t>(eventsRead), recorderState.header.eventCount)
+                BlitFree(AllocationType::Engine, recorderState.pReplayEvents, recorderState.header.eventCount * sizeof(RecordedInputEvent));
+                recorderState.pReplayEvents = nullptr;
+                fclose(pFile);
+                return 0;
+            }
+        }
+        fclose(pFile);
+
+        // Recording runs at the live frame time, so a replay re-simulates the recorded input at the fixed delta time saved in the header
+        // rather than repeating the recorded frames exactly. The given one only stands in for a broken header
+        if(!(recorderState.header.fixedDeltaTime > 0.0))
+        {
+            BLIT_WARN("Input recording %s has no valid delta time, replaying at %.4fs per frame", filepath, replayDeltaTime)
+            recorderState.header.fixedDeltaTime = replayDeltaTime;
+        }
+
+        recorderState.replayCursor = 0;
+        recorderState.mode = mode;
+        BLIT_INFO("Replaying %u input events over %u frames from %s", recorderState.header.eventCount, recorderState.header.frameCount,
+        filepath)
+        return 1;
+    }
+
+    void InputRecordingShutdown()
+    {
+        if(recorderState.mode == InputRecordingMode::Record)
+        {
+            FlushRecordedBatch();
+            recorderState.header.frameCount = recorderState.currentFrame + 1;
+            fseek(recorderState.pFile, 0, SEEK_SET);
+            fwrite(&recorderState.header, sizeof(InputRecordingHeader), 1, recorderState.pFile);
+            fclose(recorderState.pFile);
+            recorderState.pFile = nullptr;
+            BLIT_INFO("Input recording complete: %u events over %u frames", recorderState.header.eventCount, recorderState.header.frameCount)
+        }
+        else if(recorderState.mode == InputRecordingMode::Replay && recorderState.pReplayEvents)
+        {
+            BlitFree(AllocationType::Engine, recorderState.pReplayEvents, recorderState.header.eventCount * sizeof(RecordedInputEvent));
+            recorderState.pReplayEvents = nullptr;
+        }
+
+        recorderState.mode = InputRecordingMode::Inactive;
+    }
+
+    InputRecordingMode GetInputRecordingMode()
+    {
+        return recorderState.mode;
+    }
+
+    double GetInputReplayDeltaTime()
+    {
+        return recorderState.header.fixedDeltaTime;
+    }
+
+    uint8_t InputReplayFinished()
+    {
+        return recorderState.mode == InputRecordingMode::Replay && recorderState.currentFrame >= recorderState.header.frameCount;
+    }
+
+    void InputRecordingBeginFrame(uint32_t frameIndex)
+    {
+        recorderState.currentFrame = frameIndex;
+
+        if(recorderState.mode != InputRecordingMode::Replay)
+        {
+            return;
+        }
+
+        // Feed every event that arrived on this frame when it was recorded, in the order that it arrived
+        recorderState.bDispatching = 1;
+        while(recorderState.replayCursor < recorderState.header.eventCount &&
+        recorderState.pReplayEvents[recorderState.replayCursor].frameIndex <= frameIndex)
+        {
+            RecordedInputEvent& event = recorderState.pReplayEvents[recorderState.replayCursor++];
+            switch(event.type)
+            {
+                case RecordedInputType::Key:
+                {
+                    InputProcessKey(static_cast<BlitKey>(event.code), static_cast<uint8_t>(event.state));
+                    break;
+                }
+                case RecordedInputType::MouseButton:
+                {
+                    InputProcessButton(static_cast<MouseButton>(event.code), static_cast<uint8_t>(event.state));
+                    break;
+                }
+                case RecordedInputType::MouseMove:
+                {
+                    InputProcessMouseMove(event.x, event.y);
+                    break;
+                }
+                case RecordedInputType::MouseWheel:
+                {
+                    InputProcessMouseWheel(event.state);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        recorderState.bDispatching = 0;
+    }
+
+    uint8_t InputRecordEvent(RecordedInputType type, uint16_t code, int8_t state, int16_t x, int16_t y)
+    {
+        switch(recorderState.mode)
+        {
+            case InputRecordingMode::Record:
+            {
+                RecordedInputEvent& event = recorderState.batch[recorderState.batchSize++];
+                event.frameIndex = recorderState.currentFrame;
+                event.type = type;
+                event.state = state;
+                event.code = code;
+                event.x = x;
+                event.y = y;
+                if(recorderState.batchSize == BLITZEN_INPUT_RECORDING_BATCH_SIZE)
+                {
+                    FlushRecordedBatch();
+                }
+                return 1;
+            }
+            case InputRecordingMode::Replay:
+            {
+                // Live input would make the replay diverge from the recording
+                return recorderState.bDispatching;
+            }
+            default:
+                return 1;
+        }
+    }
+}
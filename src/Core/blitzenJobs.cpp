@@ -0,0 +1,353 @@
+#include "blitJobs.h"
+#include "blitProfiler.h"
+#include "blitThreadAffinity.h"
+
+#include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace BlitzenCore
+{
+    // Slots are read by thieves while the owner may be writing them, the steal is only kept if its CAS on top succeeds
+    struct JobSlot
+    {
+        std::atomic<pfnJob> pfnFunction;
+        std::atomic<void*> pData;
+        std::atomic<JobCounter*> pCounter;
+    };
+
+    struct QueuedJob
+    {
+        pfnJob pfnFunction;
+        void* pData;
+        JobCounter* pCounter;
+    };
+
+    // Chase-Lev work stealing deque with a fixed size. Only the owner pushes and pops at the bottom, any thread steals from the top
+    struct alignas(64) JobDeque
+    {
+        std::atomic<int64_t> top{0};
+        // Kept on separate cache lines, thieves only write top and the owner mostly writes bottom
+        alignas(64) std::atomic<int64_t> bottom{0};
+        alignas(64) JobSlot slots[BLITZEN_JOBS_DEQUE_SIZE];
+
+        uint8_t Push(const QueuedJob& job)
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            if(b - t >= BLITZEN_JOBS_DEQUE_SIZE)
+            {
+                return 0;
+            }
+
+            JobSlot& slot = slots[b & (BLITZEN_JOBS_DEQUE_SIZE - 1)];
+            slot.pfnFunction.store(job.pfnFunction, std::memory_order_relaxed);
+            slot.pData.store(job.pData, std::memory_order_relaxed);
+            slot.pCounter.store(job.pCounter, std::memory_order_relaxed);
+            // Publishes the slot to thieves, whose acquire load of bottom pairs with this
+            bottom.store(b + 1, std::memory_order_release);
+            return 1;
+        }
+
+        uint8_t Pop(QueuedJob& job)
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if(t > b)
+            {
+                // Empty
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return 0;
+            }
+
+            ReadSlot(b, job);
+            if(t == b)
+            {
+                // Last job, thieves may be after it as well
+                uint8_t bWon = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return bWon;
+            }
+            return 1;
+        }
+
+        uint8_t Steal(QueuedJob& job)
+        {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if(t >= b)
+            {
+                return 0;
+            }
+
+            ReadSlot(t, job);
+            return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        void ReadSlot(int64_t index, QueuedJob& job)
+        {
+            JobSlot& slot = slots[index & (BLITZEN_JOBS_DEQUE_SIZE - 1)];
+            job.pfnFunction = slot.pfnFunction.load(std::memory_order_relaxed);
+            job.pData = slot.pData.load(std::memory_order_relaxed);
+            job.pCounter = slot.pCounter.load(std::memory_order_relaxed);
+        }
+    };
+
+    struct JobSystemState
+    {
+        // One for each job thread, index 0 belongs to the thread that started the job system
+        JobDeque* pDeques = nullptr;
+        uint32_t threadCount = 1;
+        uint32_t workerCount = 0;
+
+        std::thread workers[BLITZEN_JOBS_MAX_WORKERS];
+        char workerNames[BLITZEN_JOBS_MAX_WORKERS][16];
+        std::atomic<uint8_t> bRunning{0};
+
+        // Jobs that were queued and not taken yet. Idle workers sleep while this is 0
+        std::atomic<int64_t> pendingJobs{0};
+        std::atomic<uint32_t> sleepingWorkers{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+    };
+
+    static JobSystemState jobSystemState;
+
+    thread_local uint32_t jobThreadIndex = BLITZEN_JOBS_INVALID_THREAD;
+
+    static inline void ExecuteJob(const QueuedJob& job)
+    {
+        job.pfnFunction(job.pData);
+        if(job.pCounter)
+        {
+            job.pCounter->value.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    // The thread's own jobs come first, newest first, since their data is most likely still in cache. Then the other threads' oldest jobs
+    static uint8_t FindJob(uint32_t threadIndex, QueuedJob& job)
+    {
+        JobSystemState& state = jobSystemState;
+        if(state.pendingJobs.load(std::memory_order_relaxed) <= 0)
+        {
+            return 0;
+        }
+
+        uint8_t bFound = state.pDeques[threadIndex].Pop(job);
+        for(uint32_t i = 1; !bFound && i < state.threadCount; ++i)
+        {
+            bFound = state.pDeques[(threadIndex + i) % state.threadCount].Steal(job);
+        }
+
+        if(bFound)
+        {
+            state.pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return bFound;
+    }
+
+    static void JobWorkerThread(uint32_t threadIndex)
+    {
+        JobSystemState& state = jobSystemState;
+        jobThreadIndex = threadIndex;
+        ProfilerSetThreadName(state.workerNames[threadIndex - 1]);
+        ThreadAffinityPinCurrentThread(ThreadRole::Worker, threadIndex - 1);
+
+        uint32_t idleRounds = 0;
+        QueuedJob job;
+        while(state.bRunning.load(std::memory_order_acquire))
+        {
+            if(FindJob(threadIndex, job))
+            {
+                ExecuteJob(job);
+                idleRounds = 0;
+                continue;
+            }
+
+            if(++idleRounds < BLITZEN_JOBS_SPIN_ROUNDS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announcing the sleep before checking for jobs means that a submit either sees the sleeper or the sleeper sees the job
+            std::unique_lock<std::mutex> lock(state.sleepMutex);
+            state.sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            state.sleepCondition.wait(lock, [&state]()
+            {
+                return state.pendingJobs.load(std::memory_order_seq_cst) > 0 || !state.bRunning.load(std::memory_order_acquire);
+            });
+            state.sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+            idleRounds = 0;
+        }
+    }
+
+    uint8_t JobSystemInit(uint32_t workerCount /* = 0 */, uint32_t externalThreadCount /* = 0 */)
+    {
+        JobSystemState& state = jobSystemState;
+        if(state.bRunning.load(std::memory_order_acquire))
+        {
+            BLIT_WARN("The job system is already running")
+            return 0;
+        }
+
+        if(!workerCount)
+        {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+        if(workerCount > BLITZEN_JOBS_MAX_WORKERS)
+        {
+            workerCount = BLITZEN_JOBS_MAX_WORKERS;
+        }
+
+        state.workerCount = workerCount;
+        state.threadCount = workerCount + 1 + externalThreadCount;
+        state.pDeques = new JobDeque[state.threadCount];
+        state.pendingJobs.store(0, std::memory_order_relaxed);
+        jobThreadIndex = 0;
+
+        state.bRunning.store(1, std::memory_order_release);
+        for(uint32_t i = 0; i < workerCount; ++i)
+        {
+            snprintf(state.workerNames[i], sizeof(state.workerNames[i]), "Worker %u", i + 1);
+            state.workers[i] = std::thread(JobWorkerThread, i + 1);
+        }
+
+        BLIT_INFO("Job system started with %u workers", workerCount)
+        return 1;
+    }
+
+    uint8_t JobSystemRegisterThread(uint32_t externalIndex)
+    {
+        JobSystemState& state = jobSystemState;
+        uint32_t threadIndex = state.workerCount + 1 + externalIndex;
+        if(!state.bRunning.load(std::memory_order_acquire) || threadIndex >= state.threadCount)
+        {
+            BLIT_WARN("External job thread %u was not reserved when the job system started, its jobs run on it alone", externalIndex)
+            return 0;
+        }
+        jobThreadIndex = threadIndex;
+        return 1;
+    }
+
+    void JobSystemShutdown()
+    {
+        JobSystemState& state = jobSystemState;
+        if(!state.bRunning.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        // Whatever is still queued is finished first, nothing that was submitted should be dropped
+        WaitForCounter(nullptr);
+
+        {
+            std::lock_guard<std::mutex> lock(state.sleepMutex);
+            state.bRunning.store(0, std::memory_order_release);
+        }
+        state.sleepCondition.notify_all();
+        for(uint32_t i = 0; i < state.workerCount; ++i)
+        {
+            state.workers[i].join();
+        }
+
+        delete[] state.pDeques;
+        state.pDeques = nullptr;
+        state.threadCount = 1;
+        state.workerCount = 0;
+        jobThreadIndex = BLITZEN_JOBS_INVALID_THREAD;
+    }
+
+    uint32_t JobSystemGetThreadCount()
+    {
+        return jobSystemState.threadCount;
+    }
+
+    uint32_t JobSystemGetThreadIndex()
+    {
+        return jobThreadIndex;
+    }
+
+    void RunJobs(const JobDecl* pJobs, uint32_t jobCount, JobCounter* pCounter)
+    {
+        JobSystemState& state = jobSystemState;
+        if(pCounter)
+        {
+            pCounter->value.fetch_add(jobCount, std::memory_order_relaxed);
+        }
+
+        uint32_t threadIndex = jobThreadIndex;
+        if(threadIndex == BLITZEN_JOBS_INVALID_THREAD || !state.bRunning.load(std::memory_order_acquire))
+        {
+            for(uint32_t i = 0; i < jobCount; ++i)
+            {
+                ExecuteJob(QueuedJob{pJobs[i].pfnFunction, pJobs[i].pData, pCounter});
+            }
+            return;
+        }
+
+        JobDeque& deque = state.pDeques[threadIndex];
+        uint32_t queued = 0;
+        for(uint32_t i = 0; i < jobCount; ++i)
+        {
+            QueuedJob job{pJobs[i].pfnFunction, pJobs[i].pData, pCounter};
+            // Counted before it becomes visible, so that whoever takes it never sees the count go below 0
+            state.pendingJobs.fetch_add(1, std::memory_order_seq_cst);
+            if(deque.Push(job))
+            {
+                ++queued;
+            }
+            else
+            {
+                state.pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+                ExecuteJob(job);
+            }
+        }
+
+        if(queued && state.sleepingWorkers.load(std::memory_order_seq_cst))
+        {
+            // Taking the lock makes sure that a worker that is about to sleep has either seen the jobs or is already waiting
+            {
+                std::lock_guard<std::mutex> lock(state.sleepMutex);
+            }
+            if(queued > 1)
+            {
+                state.sleepCondition.notify_all();
+            }
+            else
+            {
+                state.sleepCondition.notify_one();
+            }
+        }
+    }
+
+    void WaitForCounter(JobCounter* pCounter, uint32_t value /* = 0 */)
+    {
+        JobSystemState& state = jobSystemState;
+        uint32_t threadIndex = jobThreadIndex;
+
+        // A null counter waits for every queued job
+        auto isDone = [&state, pCounter, value]()
+        {
+            return pCounter ? pCounter->value.load(std::memory_order_acquire) <= value : state.pendingJobs.load(std::memory_order_acquire) <= 0;
+        };
+
+        QueuedJob job;
+        while(!isDone())
+        {
+            if(threadIndex != BLITZEN_JOBS_INVALID_THREAD && state.pDeques && FindJob(threadIndex, job))
+            {
+                ExecuteJob(job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
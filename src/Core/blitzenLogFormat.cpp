@@ -0,0 +1,328 @@
+#include "blitLogFormat.h"
+
+#include <stdio.h>
+
+// This file is also compiled into the log decoder, so it should not depend on anything else in the engine
+namespace BlitzenCore
+{
+    struct LogArgReader
+    {
+        const uint8_t* pData;
+        uint32_t size;
+        uint32_t offset;
+    };
+
+    struct LogArgValue
+    {
+        LogArgType type;
+        int64_t i;
+        uint64_t u;
+        double d;
+        const char* string;
+        uint16_t stringLength;
+    };
+
+    static uint32_t GetLogArgSize(LogArgType type)
+    {
+        switch(type)
+        {
+            case LogArgType::Int32:
+            case LogArgType::UInt32:
+                return sizeof(uint32_t);
+            case LogArgType::Int64:
+            case LogArgType::UInt64:
+            case LogArgType::Pointer:
+                return sizeof(uint64_t);
+            case LogArgType::Double:
+                return sizeof(double);
+            default:
+                return 0;
+        }
+    }
+
+    // Reads the next argument and converts it to every representation that a conversion might ask for. Returns 0 when there are no more
+    static uint8_t ReadLogArg(LogArgReader& reader, LogArgValue& value)
+    {
+        if(reader.offset >= reader.size)
+        {
+            return 0;
+        }
+        value.type = static_cast<LogArgType>(reader.pData[reader.offset]);
+        const uint8_t* pValue = reader.pData + reader.offset + 1;
+        uint32_t remaining = reader.size - reader.offset - 1;
+
+        if(value.type == LogArgType::String)
+        {
+            if(remaining < sizeof(uint16_t))
+            {
+                return 0;
+            }
+            memcpy(&value.stringLength, pValue, sizeof(uint16_t));
+            if(remaining - sizeof(uint16_t) < value.stringLength)
+            {
+                return 0;
+            }
+            value.string = reinterpret_cast<const char*>(pValue + sizeof(uint16_t));
+            value.i = 0;
+            value.u = 0;
+            value.d = 0;
+            reader.offset += 1 + sizeof(uint16_t) + value.stringLength;
+            return 1;
+        }
+
+        uint32_t valueSize = GetLogArgSize(value.type);
+        if(!valueSize || remaining < valueSize)
+        {
+            return 0;
+        }
+
+        switch(value.type)
+        {
+            case LogArgType::Int32:
+            {
+                int32_t stored;
+                memcpy(&stored, pValue, sizeof(int32_t));
+                value.i = stored;
+                value.u = static_cast<uint32_t>(stored);
+                value.d = stored;
+                break;
+            }
+            case LogArgType::UInt32:
+            {
+                uint32_t stored;
+                memcpy(&stored, pValue, sizeof(uint32_t));
+                value.i = stored;
+                value.u = stored;
+                value.d = stored;
+                break;
+            }
+            case LogArgType::Int64:
+            {
+                memcpy(&value.i, pValue, sizeof(int64_t));
+                value.u = static_cast<uint64_t>(value.i);
+                value.d = static_cast<double>(value.i);
+                break;
+            }
+            case LogArgType::UInt64:
+            case LogArgType::Pointer:
+            {
+                memcpy(&value.u, pValue, sizeof(uint64_t));
+                value.i = static_cast<int64_t>(value.u);
+                value.d = static_cast<double>(value.u);
+                break;
+            }
+            case LogArgType::Double:
+            {
+                memcpy(&value.d, pValue, sizeof(double));
+                value.i = static_cast<int64_t>(value.d);
+                value.u = static_cast<uint64_t>(value.i);
+                break;
+            }
+            default:
+                break;
+        }
+        value.string = "";
+        value.stringLength = 0;
+        reader.offset += 1 + valueSize;
+        return 1;
+    }
+
+    static void AppendToOutput(char* pOut, uint32_t outSize, uint32_t& length, const char* text, size_t textLength)
+    {
+        if(length + 1 >= outSize)
+        {
+            return;
+        }
+        size_t space = outSize - 1 - length;
+        size_t copied = textLength < space ? textLength : space;
+        memcpy(pOut + length, text, copied);
+        length += static_cast<uint32_t>(copied);
+        pOut[length] = 0;
+    }
+
+    uint32_t RenderLogMessage(const char* format, const uint8_t* pArgs, uint32_t argsSize, char* pOut, uint32_t outSize)
+    {
+        if(!outSize)
+        {
+            return 0;
+        }
+        pOut[0] = 0;
+        uint32_t length = 0;
+        LogArgReader reader{pArgs, argsSize, 0};
+
+        const char* pCurrent = format;
+        while(*pCurrent)
+        {
+            const char* pPercent = strchr(pCurrent, '%');
+            if(!pPercent)
+            {
+                AppendToOutput(pOut, outSize, length, pCurrent, strlen(pCurrent));
+                break;
+            }
+            AppendToOutput(pOut, outSize, length, pCurrent, pPercent - pCurrent);
+
+            // The conversion is rebuilt without its length modifier, which is replaced by one that matches the stored argument
+            char spec[48];
+            uint32_t specLength = 0;
+            spec[specLength++] = '%';
+            const char* pSpec = pPercent + 1;
+
+            if(*pSpec == '%')
+            {
+                AppendToOutput(pOut, outSize, length, "%", 1);
+                pCurrent = pSpec + 1;
+                continue;
+            }
+
+            while(*pSpec && strchr("-+ #0", *pSpec) && specLength < 6)
+            {
+                spec[specLength++] = *pSpec++;
+            }
+
+            // Width and precision may come from the arguments, in which case they are written into the conversion as numbers
+            for(uint8_t part = 0; part < 2; ++part)
+            {
+                if(part == 1)
+                {
+                    if(*pSpec != '.')
+                    {
+                        break;
+                    }
+                    spec[specLength++] = *pSpec++;
+                }
+
+                if(*pSpec == '*')
+                {
+                    LogArgValue value;
+                    int32_t number = ReadLogArg(reader, value) ? static_cast<int32_t>(value.i) : 0;
+                    int32_t space = static_cast<int32_t>(sizeof(spec) - specLength - 8);
+                    int32_t numberLength = snprintf(spec + specLength, space, "%d", number);
+                    specLength += numberLength < space ? numberLength : space - 1;
+                    ++pSpec;
+                }
+                else
+                {
+                    while(*pSpec >= '0' && *pSpec <= '9' && specLength < 30)
+                    {
+                        spec[specLength++] = *pSpec++;
+                    }
+                }
+            }
+
+            uint8_t bWide = 0;
+            while(*pSpec && strchr("hlLzjtq", *pSpec))
+            {
+                if(*pSpec != 'h')
+                {
+                    bWide = 1;
+                }
+                ++pSpec;
+            }
+
+            char conversion = *pSpec;
+            if(!conversion)
+            {
+                // A dangling % is written as it is
+                AppendToOutput(pOut, outSize, length, pPercent, strlen(pPercent));
+                break;
+            }
+            pCurrent = pSpec + 1;
+
+            LogArgValue value;
+            if(!ReadLogArg(reader, value))
+            {
+                AppendToOutput(pOut, outSize, length, "<missing>", 9);
+                continue;
+            }
+
+            char converted[BLITZEN_LOG_FORMAT_CONVERSION_SIZE];
+            int32_t convertedLength = 0;
+            switch(conversion)
+            {
+                case 'd':
+                case 'i':
+                {
+                    if(bWide)
+                    {
+                        memcpy(spec + specLength, "ll", 2);
+                        specLength += 2;
+                    }
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    convertedLength = bWide ? snprintf(converted, sizeof(converted), spec, static_cast<long long>(value.i)) :
+                    snprintf(converted, sizeof(converted), spec, static_cast<int32_t>(value.i));
+                    break;
+                }
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'o':
+                {
+                    if(bWide)
+                    {
+                        memcpy(spec + specLength, "ll", 2);
+                        specLength += 2;
+                    }
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    convertedLength = bWide ? snprintf(converted, sizeof(converted), spec, static_cast<unsigned long long>(value.u)) :
+                    snprintf(converted, sizeof(converted), spec, static_cast<uint32_t>(value.u));
+                    break;
+                }
+                case 'c':
+                {
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    convertedLength = snprintf(converted, sizeof(converted), spec, static_cast<int32_t>(value.i));
+                    break;
+                }
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A':
+                {
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    convertedLength = snprintf(converted, sizeof(converted), spec, value.d);
+                    break;
+                }
+                case 's':
+                {
+                    // Stored strings are not terminated, so they are copied into a terminated buffer first (cut to its size).
+                    // A precision in the conversion still applies on top of that
+                    char string[BLITZEN_LOG_FORMAT_CONVERSION_SIZE];
+                    uint32_t stringLength = value.stringLength < sizeof(string) - 1 ? value.stringLength : sizeof(string) - 1;
+                    memcpy(string, value.string, stringLength);
+                    string[stringLength] = 0;
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    convertedLength = snprintf(converted, sizeof(converted), spec, string);
+                    break;
+                }
+                case 'p':
+                {
+                    convertedLength = snprintf(converted, sizeof(converted), "0x%llx", static_cast<unsigned long long>(value.u));
+                    break;
+                }
+                default:
+                {
+                    // Unknown conversions are written as they are, so that nothing is silently lost
+                    convertedLength = snprintf(converted, sizeof(converted), "%.*s", static_cast<int32_t>(pCurrent - pPercent), pPercent);
+                    break;
+                }
+            }
+
+            if(convertedLength > 0)
+            {
+                AppendToOutput(pOut, outSize, length, converted,
+                convertedLength < static_cast<int32_t>(sizeof(converted)) ? convertedLength : sizeof(converted) - 1);
+            }
+        }
+
+        return length;
+    }
+}
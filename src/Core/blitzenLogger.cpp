@@ -1,21 +1,490 @@
 #include "blitLogger.h"
 #include "blitAssert.h"
+#include "blitzenContainerLibrary.h"
 #include "Platform/blitPlatform.h"
 
 // Need this for string formatting
 #include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include <thread>
 
 namespace BlitzenCore
 {
-    void BlitLog(LogLevel level, const char* message, ...)
+    static const char* logLevels[static_cast<size_t>(LogLevel::MaxLevel)] = {"{FATAL}: ", "{ERROR}: ", "{Warning}: ", "{Info}: ", "{Debug}: ", "{Trace}: "};
+    // Names used by the levels environment variable
+    static const char* logLevelNames[static_cast<size_t>(LogLevel::MaxLevel)] = {"Fatal", "Error", "Warn", "Info", "Debug", "Trace"};
+    static const char* logChannelNames[static_cast<size_t>(LogChannel::MaxChannels)] = {"Core", "Events", "Vulkan", "Loader", "Platform"};
+
+    #define BLITZEN_LOG_STARTING_LEVEL(compiled) static_cast<uint8_t>(LogLevel::compiled < LogLevel::BLITZEN_LOG_DEFAULT_LEVEL ? \
+                                                LogLevel::compiled : LogLevel::BLITZEN_LOG_DEFAULT_LEVEL)
+
+    std::atomic<uint8_t> logChannelLevels[static_cast<size_t>(LogChannel::MaxChannels)] = 
+    {
+        BLITZEN_LOG_STARTING_LEVEL(BLITZEN_LOG_COMPILED_LEVEL_CORE), 
+        BLITZEN_LOG_STARTING_LEVEL(BLITZEN_LOG_COMPILED_LEVEL_EVENTS), 
+        BLITZEN_LOG_STARTING_LEVEL(BLITZEN_LOG_COMPILED_LEVEL_VULKAN), 
+        BLITZEN_LOG_STARTING_LEVEL(BLITZEN_LOG_COMPILED_LEVEL_LOADER), 
+        BLITZEN_LOG_STARTING_LEVEL(BLITZEN_LOG_COMPILED_LEVEL_PLATFORM)
+    };
+
+    // A message as it waits in a thread's ring. Only the message itself is formatted by the producer, the writer adds the rest.
+    // Deferred messages hold their encoded arguments instead of text
+    struct LogMessage
+    {
+        LogLevel level;
+        uint32_t length;
+        // 0 for messages that are already formatted
+        uint32_t formatId;
+        char text[BLITZEN_LOG_MESSAGE_SIZE];
+    };
+
+    struct LogFormat
+    {
+        const char* format;
+        const char* file;
+        uint32_t line;
+        LogLevel level;
+    };
+
+    struct LogThreadRing
+    {
+        BlitCL::SpscRingBuffer<LogMessage, BLITZEN_LOG_RING_SIZE> messages;
+        // Messages that were lost because the writer could not keep up
+        std::atomic<uint32_t> dropped{0};
+    };
+
+    struct LoggerState
+    {
+        std::atomic<uint8_t> bActive{0};
+        // Incremented on every shutdown, so that threads know to register a new ring if logging starts again
+        std::atomic<uint32_t> generation{0};
+
+        std::atomic<LogThreadRing*> pRings[BLITZEN_LOG_MAX_THREADS];
+        std::atomic<uint32_t> ringCount{0};
+
+        std::thread writer;
+        std::atomic<uint8_t> bWriterRunning{0};
+
+        // LogFlush waits for the writer to complete a full pass after its request
+        std::atomic<uint64_t> flushRequested{0};
+        std::atomic<uint64_t> flushCompleted{0};
+
+        FILE* pFile = nullptr;
+
+        // Format strings of deferred messages, indexed by id - 1
+        LogFormat formats[BLITZEN_LOG_MAX_FORMATS];
+        std::atomic<uint32_t> formatCount{0};
+
+        // Only touched by the writer. A format is written to the binary file before its first message
+        FILE* pBinaryFile = nullptr;
+        uint8_t formatWritten[BLITZEN_LOG_MAX_FORMATS];
+
+        // Call sites that have dropped messages at some point. Their repeats are reported by the writer once per window
+        std::atomic<LogSite*> pLimitedSites[BLITZEN_LOG_MAX_LIMITED_SITES];
+        std::atomic<uint32_t> limitedSiteCount{0};
+        double lastRepeatReport = 0.0;
+    };
+
+    static LoggerState loggerState;
+
+    thread_local LogThreadRing* pThreadRing = nullptr;
+    thread_local uint32_t threadRingGeneration = 0;
+
+    // Writes a complete line to every sink. Only called by the writer, or by whoever logs while the writer is not running
+    static void WriteToSinks(LogLevel level, const char* line, size_t length)
+    {
+        if(level <= LogLevel::Error)
+        {
+            BlitzenPlatform::ConsoleError(line, static_cast<uint8_t>(level));
+        }
+        else
+        {
+            BlitzenPlatform::ConsoleWrite(line, static_cast<uint8_t>(level));
+        }
+
+        if(loggerState.pFile)
+        {
+            fwrite(line, 1, length, loggerState.pFile);
+        }
+    }
+
+    static void WriteBinaryRecord(BinaryLogRecordType type, LogLevel level, uint32_t id, const void* pPayload, uint32_t size)
+    {
+        BinaryLogRecordHeader header;
+        header.type = type;
+        header.level = static_cast<uint8_t>(level);
+        header.size = static_cast<uint16_t>(size);
+        header.id = id;
+        fwrite(&header, sizeof(BinaryLogRecordHeader), 1, loggerState.pBinaryFile);
+        fwrite(pPayload, 1, size, loggerState.pBinaryFile);
+    }
+
+    static void WriteMessage(LogLevel level, const char* message, uint32_t length)
+    {
+        char line[BLITZEN_LOG_MESSAGE_SIZE + 32];
+        int32_t lineLength = snprintf(line, sizeof(line), "%s%.*s\n", logLevels[static_cast<uint8_t>(level)], static_cast<int32_t>(length),
+        message);
+        if(lineLength > 0)
+        {
+            WriteToSinks(level, line, lineLength < static_cast<int32_t>(sizeof(line)) ? lineLength : sizeof(line) - 1);
+        }
+    }
+
+    static void WriteDeferredMessage(LogLevel level, uint32_t formatId, const uint8_t* pArgs, uint32_t argsSize)
+    {
+        const LogFormat& format = loggerState.formats[formatId - 1];
+
+        // Without the binary file, the writer formats the message itself, which still keeps the work off of the thread that logged it
+        if(!loggerState.pBinaryFile)
+        {
+            char text[BLITZEN_LOG_MESSAGE_SIZE];
+            uint32_t length = RenderLogMessage(format.format, pArgs, argsSize, text, BLITZEN_LOG_MESSAGE_SIZE);
+            WriteMessage(level, text, length);
+            return;
+        }
+
+        if(!loggerState.formatWritten[formatId - 1])
+        {
+            char payload[BLITZEN_LOG_MESSAGE_SIZE * 2];
+            size_t formatLength = strlen(format.format) + 1;
+            size_t fileLength = strlen(format.file) + 1;
+            if(sizeof(uint32_t) + formatLength + fileLength > sizeof(payload))
+            {
+                // The decoder will not find the format and will say so, instead of the message being written wrong
+                return;
+            }
+            memcpy(payload, &format.line, sizeof(uint32_t));
+            memcpy(payload + sizeof(uint32_t), format.format, formatLength);
+            memcpy(payload + sizeof(uint32_t) + formatLength, format.file, fileLength);
+            WriteBinaryRecord(BinaryLogRecordType::Format, format.level, formatId, payload,
+            static_cast<uint32_t>(sizeof(uint32_t) + formatLength + fileLength));
+            loggerState.formatWritten[formatId - 1] = 1;
+        }
+
+        WriteBinaryRecord(BinaryLogRecordType::Message, level, formatId, pArgs, argsSize);
+    }
+
+    // Drains every registered ring once. Returns the number of messages written
+    static uint32_t DrainRings()
+    {
+        uint32_t written = 0;
+        uint32_t ringCount = loggerState.ringCount.load(std::memory_order_acquire);
+        for(uint32_t i = 0; i < ringCount; ++i)
+        {
+            // A thread that has claimed a slot but not stored its ring yet has nothing to write anyway
+            LogThreadRing* pRing = loggerState.pRings[i].load(std::memory_order_acquire);
+            if(!pRing)
+            {
+                continue;
+            }
+
+            while(LogMessage* pMessage = pRing->messages.Front())
+            {
+                if(pMessage->formatId)
+                {
+                    WriteDeferredMessage(pMessage->level, pMessage->formatId, reinterpret_cast<const uint8_t*>(pMessage->text),
+                    pMessage->length);
+                }
+                else
+                {
+                    // The binary log keeps formatted messages as well, so that it holds the whole log in order
+                    if(loggerState.pBinaryFile)
+                    {
+                        WriteBinaryRecord(BinaryLogRecordType::Text, pMessage->level, 0, pMessage->text, pMessage->length);
+                    }
+                    WriteMessage(pMessage->level, pMessage->text, pMessage->length);
+                }
+                pRing->messages.PopFront();
+                ++written;
+            }
+
+            uint32_t dropped = pRing->dropped.exchange(0, std::memory_order_relaxed);
+            if(dropped)
+            {
+                char line[128];
+                int32_t length = snprintf(line, sizeof(line), "%sLogger dropped %u messages, the writer could not keep up\n",
+                logLevels[static_cast<uint8_t>(LogLevel::Warn)], dropped);
+                WriteToSinks(LogLevel::Warn, line, length);
+                if(loggerState.pBinaryFile)
+                {
+                    uint32_t prefixLength = static_cast<uint32_t>(strlen(logLevels[static_cast<uint8_t>(LogLevel::Warn)]));
+                    WriteBinaryRecord(BinaryLogRecordType::Text, LogLevel::Warn, 0, line + prefixLength, length - prefixLength - 1);
+                }
+            }
+        }
+        return written;
+    }
+
+    // Reports how many messages each limited call site dropped since the last report. Only called by the writer, or after it has stopped
+    static void ReportRepeatedMessages()
+    {
+        uint32_t siteCount = loggerState.limitedSiteCount.load(std::memory_order_acquire);
+        if(siteCount > BLITZEN_LOG_MAX_LIMITED_SITES)
+        {
+            siteCount = BLITZEN_LOG_MAX_LIMITED_SITES;
+        }
+
+        for(uint32_t i = 0; i < siteCount; ++i)
+        {
+            LogSite* pSite = loggerState.pLimitedSites[i].load(std::memory_order_acquire);
+            if(!pSite)
+            {
+                continue;
+            }
+
+            uint32_t suppressed = pSite->suppressed.exchange(0, std::memory_order_relaxed);
+            if(suppressed)
+            {
+                char message[BLITZEN_LOG_MESSAGE_SIZE];
+                int32_t length = snprintf(message, sizeof(message), "\"%s\" (%s:%u) repeated %u more times", pSite->format, pSite->file, 
+                pSite->line, suppressed);
+                length = length < 0 ? 0 : length < static_cast<int32_t>(sizeof(message)) ? length : sizeof(message) - 1;
+                if(loggerState.pBinaryFile)
+                {
+                    WriteBinaryRecord(BinaryLogRecordType::Text, pSite->level, 0, message, length);
+                }
+                WriteMessage(pSite->level, message, length);
+            }
+        }
+    }
+
+    static void LogWriterThread()
     {
-        const char* logLevels[static_cast<size_t>(LogLevel::MaxLevel)] = {"{FATAL}: ", "{ERROR}: ", "{Info}: ", "{Warning}: ", "{Debug}: ", "{Trace}: "};
-        uint8_t isError = level < LogLevel::Info;
+        while(loggerState.bWriterRunning.load(std::memory_order_acquire))
+        {
+            uint64_t flushRequested = loggerState.flushRequested.load(std::memory_order_acquire);
+            uint32_t written = DrainRings();
+
+            if(flushRequested != loggerState.flushCompleted.load(std::memory_order_relaxed))
+            {
+                if(loggerState.pFile)
+                {
+                    fflush(loggerState.pFile);
+                }
+                if(loggerState.pBinaryFile)
+                {
+                    fflush(loggerState.pBinaryFile);
+                }
+                loggerState.flushCompleted.store(flushRequested, std::memory_order_release);
+            }
+
+            double time = BlitzenPlatform::GetAbsoluteTime();
+            if(time - loggerState.lastRepeatReport >= BLITZEN_LOG_SITE_WINDOW_SECONDS)
+            {
+                ReportRepeatedMessages();
+                loggerState.lastRepeatReport = time;
+            }
+
+            // Producers never wake the writer, so that logging stays a memory write. The writer polls instead
+            if(!written)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(BLITZEN_LOG_WRITER_SLEEP_MS));
+            }
+        }
+
+        // Whatever was logged before shutdown still gets written
+        DrainRings();
+    }
+
+    void SetLogLevel(LogChannel channel, LogLevel level)
+    {
+        LogLevel compiled = logCompiledLevels[static_cast<uint8_t>(channel)];
+        logChannelLevels[static_cast<uint8_t>(channel)].store(static_cast<uint8_t>(level < compiled ? level : compiled), 
+        std::memory_order_relaxed);
+    }
+
+    LogLevel GetLogLevel(LogChannel channel)
+    {
+        return static_cast<LogLevel>(logChannelLevels[static_cast<uint8_t>(channel)].load(std::memory_order_relaxed));
+    }
+
+    static uint8_t LogNameEquals(const char* name, const char* text, size_t length)
+    {
+        for(size_t i = 0; i < length; ++i)
+        {
+            if(!name[i] || tolower(name[i]) != tolower(text[i]))
+            {
+                return 0;
+            }
+        }
+        return !name[length];
+    }
+
+    // Reads a comma separated list of Channel=Level pairs, where All sets every channel
+    static void ParseLogLevels(const char* levels)
+    {
+        const char* pCurrent = levels;
+        while(*pCurrent)
+        {
+            const char* pEnd = strchr(pCurrent, ',');
+            size_t length = pEnd ? static_cast<size_t>(pEnd - pCurrent) : strlen(pCurrent);
+            const char* pEquals = reinterpret_cast<const char*>(memchr(pCurrent, '=', length));
+
+            uint8_t bValid = 0;
+            if(pEquals)
+            {
+                size_t channelLength = pEquals - pCurrent;
+                size_t levelLength = length - channelLength - 1;
 
-        //Temporary to avoid dynamic arrays for now
-        char outMessage[3200];
-        memset(outMessage, 0, sizeof(outMessage));
+                uint8_t level = static_cast<uint8_t>(LogLevel::MaxLevel);
+                for(uint8_t i = 0; i < static_cast<uint8_t>(LogLevel::MaxLevel); ++i)
+                {
+                    if(LogNameEquals(logLevelNames[i], pEquals + 1, levelLength))
+                    {
+                        level = i;
+                    }
+                }
 
+                if(level != static_cast<uint8_t>(LogLevel::MaxLevel))
+                {
+                    for(uint8_t i = 0; i < static_cast<uint8_t>(LogChannel::MaxChannels); ++i)
+                    {
+                        if(LogNameEquals("All", pCurrent, channelLength) || LogNameEquals(logChannelNames[i], pCurrent, channelLength))
+                        {
+                            SetLogLevel(static_cast<LogChannel>(i), static_cast<LogLevel>(level));
+                            bValid = 1;
+                        }
+                    }
+                }
+            }
+
+            if(!bValid)
+            {
+                BLIT_ERROR("Ignoring \"%.*s\" in %s", static_cast<int32_t>(length), pCurrent, BLITZEN_LOG_LEVELS_ENVIRONMENT_VARIABLE)
+            }
+
+            if(!pEnd)
+            {
+                break;
+            }
+            pCurrent = pEnd + 1;
+        }
+    }
+
+    uint8_t LoggingInit()
+    {
+        if(const char* levels = getenv(BLITZEN_LOG_LEVELS_ENVIRONMENT_VARIABLE))
+        {
+            ParseLogLevels(levels);
+        }
+
+        #ifdef BLITZEN_LOG_FILE
+            loggerState.pFile = fopen(BLITZEN_LOG_FILE, "w");
+            if(!loggerState.pFile)
+            {
+                BLIT_WARN("Failed to open %s, logging to the console only", BLITZEN_LOG_FILE)
+            }
+        #endif
+
+        #if BLITZEN_LOG_BINARY
+            loggerState.pBinaryFile = fopen(BLITZEN_LOG_BINARY_FILE, "wb");
+            if(loggerState.pBinaryFile)
+            {
+                BinaryLogFileHeader header;
+                header.magic = BLITZEN_BINARY_LOG_MAGIC;
+                header.version = BLITZEN_BINARY_LOG_VERSION;
+                fwrite(&header, sizeof(BinaryLogFileHeader), 1, loggerState.pBinaryFile);
+                memset(loggerState.formatWritten, 0, sizeof(loggerState.formatWritten));
+            }
+            else
+            {
+                BLIT_WARN("Failed to open %s, deferred messages will be formatted by the background writer", BLITZEN_LOG_BINARY_FILE)
+            }
+        #endif
+
+        #if BLITZEN_LOG_ASYNC
+            loggerState.bWriterRunning.store(1, std::memory_order_release);
+            loggerState.writer = std::thread(LogWriterThread);
+            loggerState.bActive.store(1, std::memory_order_release);
+        #endif
+
+        return 1;
+    }
+
+    void LoggingShutdown()
+    {
+        if(loggerState.bActive.exchange(0, std::memory_order_acq_rel))
+        {
+            loggerState.bWriterRunning.store(0, std::memory_order_release);
+            loggerState.writer.join();
+            ReportRepeatedMessages();
+
+            uint32_t ringCount = loggerState.ringCount.exchange(0, std::memory_order_acq_rel);
+            for(uint32_t i = 0; i < ringCount; ++i)
+            {
+                delete loggerState.pRings[i].exchange(nullptr, std::memory_order_acq_rel);
+            }
+            loggerState.generation.fetch_add(1, std::memory_order_acq_rel);
+        }
+        else
+        {
+            ReportRepeatedMessages();
+        }
+
+        if(loggerState.pFile)
+        {
+            fclose(loggerState.pFile);
+            loggerState.pFile = nullptr;
+        }
+        if(loggerState.pBinaryFile)
+        {
+            fclose(loggerState.pBinaryFile);
+            loggerState.pBinaryFile = nullptr;
+        }
+    }
+
+    void LogFlush()
+    {
+        if(!loggerState.bActive.load(std::memory_order_acquire))
+        {
+            if(loggerState.pFile)
+            {
+                fflush(loggerState.pFile);
+            }
+            return;
+        }
+
+        uint64_t request = loggerState.flushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while(loggerState.flushCompleted.load(std::memory_order_acquire) < request)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Returns the calling thread's ring, registering a new one the first time the thread logs
+    static LogThreadRing* GetThreadRing()
+    {
+        uint32_t generation = loggerState.generation.load(std::memory_order_acquire);
+        if(pThreadRing && threadRingGeneration == generation)
+        {
+            return pThreadRing;
+        }
+
+        pThreadRing = nullptr;
+        threadRingGeneration = generation;
+
+        uint32_t index = loggerState.ringCount.load(std::memory_order_acquire);
+        do
+        {
+            // The thread will have to log synchronously
+            if(index >= BLITZEN_LOG_MAX_THREADS)
+            {
+                return nullptr;
+            }
+        } while(!loggerState.ringCount.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+
+        LogThreadRing* pRing = new LogThreadRing();
+        loggerState.pRings[index].store(pRing, std::memory_order_release);
+        pThreadRing = pRing;
+        return pRing;
+    }
+
+    void BlitLog(LogLevel level, const char* message, ...)
+    {
         // This variable is different depending on the platform
         #if _MSC_VER
             va_list argPtr;
@@ -23,26 +492,131 @@ namespace BlitzenCore
             __builtin_va_list argPtr;
         #endif
 
+        // Fatal messages are usually followed by a break, so they are written out immediately, after everything that came before them
+        LogThreadRing* pRing = nullptr;
+        if(level != LogLevel::Fatal && loggerState.bActive.load(std::memory_order_acquire))
+        {
+            pRing = GetThreadRing();
+        }
+
+        if(pRing)
+        {
+            LogMessage* pMessage = pRing->messages.BeginPush();
+            if(!pMessage)
+            {
+                pRing->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            va_start(argPtr, message);
+            int32_t length = vsnprintf(pMessage->text, BLITZEN_LOG_MESSAGE_SIZE, message, argPtr);
+            va_end(argPtr);
+
+            pMessage->level = level;
+            pMessage->formatId = 0;
+            pMessage->length = length < 0 ? 0 : length < BLITZEN_LOG_MESSAGE_SIZE ? length : BLITZEN_LOG_MESSAGE_SIZE - 1;
+            pRing->messages.EndPush();
+            return;
+        }
+
+        if(level == LogLevel::Fatal)
+        {
+            LogFlush();
+        }
+
+        char outMessage[BLITZEN_LOG_MESSAGE_SIZE];
         va_start(argPtr, message);
-        vsnprintf(outMessage, 3200, message, argPtr);
+        int32_t length = vsnprintf(outMessage, BLITZEN_LOG_MESSAGE_SIZE, message, argPtr);
         va_end(argPtr);
 
-        // Pass out message to a clean buffer to be printed out
-        char outMessage2[3200];
-        sprintf(outMessage2, "%s%s\n", logLevels[static_cast<uint8_t>(level)], outMessage);
+        WriteMessage(level, outMessage, length < 0 ? 0 : length < BLITZEN_LOG_MESSAGE_SIZE ? length : BLITZEN_LOG_MESSAGE_SIZE - 1);
+        if(level == LogLevel::Fatal && loggerState.pFile)
+        {
+            fflush(loggerState.pFile);
+        }
+    }
 
-        if(isError)
+    uint8_t LogSiteAllow(LogSite& site)
+    {
+        if(site.level == LogLevel::Fatal)
         {
-            BlitzenPlatform::ConsoleError(outMessage2, static_cast<uint8_t>(level));
+            return 1;
         }
-        else
+
+        // The first message of a new window resets the count. Threads that race on this only make the count approximate
+        uint64_t window = static_cast<uint64_t>(BlitzenPlatform::GetAbsoluteTime() / BLITZEN_LOG_SITE_WINDOW_SECONDS);
+        uint64_t siteWindow = site.window.load(std::memory_order_relaxed);
+        if(window != siteWindow && site.window.compare_exchange_strong(siteWindow, window, std::memory_order_relaxed))
         {
-            BlitzenPlatform::ConsoleWrite(outMessage2, static_cast<uint8_t>(level));
+            site.count.store(0, std::memory_order_relaxed);
         }
+
+        if(site.count.fetch_add(1, std::memory_order_relaxed) < site.limit)
+        {
+            return 1;
+        }
+
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        if(!site.bRegistered.exchange(1, std::memory_order_relaxed))
+        {
+            uint32_t index = loggerState.limitedSiteCount.fetch_add(1, std::memory_order_relaxed);
+            if(index < BLITZEN_LOG_MAX_LIMITED_SITES)
+            {
+                loggerState.pLimitedSites[index].store(&site, std::memory_order_release);
+            }
+        }
+        return 0;
+    }
+
+    uint32_t RegisterLogFormat(LogLevel level, const char* format, const char* file, uint32_t line)
+    {
+        uint32_t index = loggerState.formatCount.fetch_add(1, std::memory_order_relaxed);
+        if(index >= BLITZEN_LOG_MAX_FORMATS)
+        {
+            return 0;
+        }
+
+        // Call sites register from their static initializer and pass the id to the writer through the ring, which makes the entry visible to it
+        LogFormat& entry = loggerState.formats[index];
+        entry.format = format;
+        entry.file = file;
+        entry.line = line;
+        entry.level = level;
+        return index + 1;
+    }
+
+    void BlitLogEncoded(LogLevel level, uint32_t formatId, const char* format, const uint8_t* pArgs, uint32_t argsSize)
+    {
+        LogThreadRing* pRing = nullptr;
+        if(formatId && loggerState.bActive.load(std::memory_order_acquire))
+        {
+            pRing = GetThreadRing();
+        }
+
+        if(pRing)
+        {
+            LogMessage* pMessage = pRing->messages.BeginPush();
+            if(!pMessage)
+            {
+                pRing->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            memcpy(pMessage->text, pArgs, argsSize);
+            pMessage->level = level;
+            pMessage->formatId = formatId;
+            pMessage->length = argsSize;
+            pRing->messages.EndPush();
+            return;
+        }
+
+        char text[BLITZEN_LOG_MESSAGE_SIZE];
+        uint32_t length = RenderLogMessage(format, pArgs, argsSize, text, BLITZEN_LOG_MESSAGE_SIZE);
+        WriteMessage(level, text, length);
     }
 
     void ReportAssertionFailure(const char* expression, const char* message, const char* file, int32_t line)
     {
         BlitLog(LogLevel::Fatal, "Assertion failure: %s, message: %s, in file: %s, line: %d", expression, message, file, line);
     }
-}
\ No newline at end of file
+}
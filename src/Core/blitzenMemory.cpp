@@ -1,14 +1,48 @@
 #include "blitMemory.h"
 #include "Platform/blitPlatform.h"
 #include "mainEngine.h"
+#include "blitFlightRecorder.h"
+#include "blitMetrics.h"
+
+#include <stdio.h>
+#include <mutex>
 
 namespace BlitzenCore
 {
     static AllocationData allocState;
+    // Threads other than the main thread allocate as well (the profiler's rings are allocated by the thread that records into them)
+    static std::mutex allocStateMutex;
+
+    static uint32_t allocationsMetric = BLITZEN_INVALID_METRIC;
+    static uint32_t allocatedBytesMetric = BLITZEN_INVALID_METRIC;
+
+    struct GpuMemoryState
+    {
+        size_t categories[static_cast<size_t>(GpuMemoryCategory::MaxCategories)];
+        size_t categoryPeaks[static_cast<size_t>(GpuMemoryCategory::MaxCategories)];
+    };
+    static GpuMemoryState gpuMemoryState;
+
+    // Opened by the first report, so that a run that never reports does not leave an empty file behind
+    static FILE* pMemoryReportFile = nullptr;
+
+    // Indexed by AllocationType, types that are not used have no name and are left out of the report
+    static const char* allocationTypeNames[static_cast<size_t>(AllocationType::MaxTypes)] =
+    {
+        nullptr, "Array", "DynamicArray", "Hashmap", "Queue", "Bst", nullptr, "Engine", "Renderer", "Entity", "EntityNode", "Scene"
+    };
+
+    static const char* gpuMemoryCategoryNames[static_cast<size_t>(GpuMemoryCategory::MaxCategories)] =
+    {
+        "Geometry", "Textures", "RenderTargets", "PerFrame", "SceneData", "Staging"
+    };
 
     void MemoryManagementInit()
     {
         BlitzenPlatform::PlatformMemZero(&allocState, sizeof(AllocationData));
+
+        MetricsRegister("Allocations", MetricType::Counter, allocationsMetric);
+        MetricsRegister("AllocatedBytes", MetricType::Counter, allocatedBytesMetric);
     }
 
     void MemoryManagementShutdown()
@@ -19,6 +53,12 @@ namespace BlitzenCore
             return;
         }
         BLIT_ASSERT_MESSAGE(!allocState.totalAllocated, "There is still unallocated memory")
+
+        if(pMemoryReportFile)
+        {
+            fclose(pMemoryReportFile);
+            pMemoryReportFile = nullptr;
+        }
     }
 
     void* BlitAlloc(AllocationType alloc, size_t size)
@@ -29,8 +69,14 @@ namespace BlitzenCore
             BLIT_FATAL("Allocation type: %i, A valid allocation type must be specified!", static_cast<uint8_t>(alloc))
         }
 
-        allocState.totalAllocated += size;
-        allocState.typesAllocated[static_cast<size_t>(alloc)] += size;
+        {
+            std::lock_guard<std::mutex> lock(allocStateMutex);
+            allocState.totalAllocated += size;
+            allocState.typesAllocated[static_cast<size_t>(alloc)] += size;
+        }
+        FlightRecorderCountAllocation(size);
+        MetricAdd(allocationsMetric);
+        MetricAdd(allocatedBytesMetric, static_cast<int64_t>(size));
 
         return BlitzenPlatform::PlatformMalloc(size, false);
     }
@@ -43,8 +89,11 @@ namespace BlitzenCore
             BLIT_FATAL("Allocation type: %i, A valid allocation type must be specified!", static_cast<uint8_t>(alloc))
         }
 
-        allocState.totalAllocated -= size;
-        allocState.typesAllocated[static_cast<size_t>(alloc)] -= size;
+        {
+            std::lock_guard<std::mutex> lock(allocStateMutex);
+            allocState.totalAllocated -= size;
+            allocState.typesAllocated[static_cast<size_t>(alloc)] -= size;
+        }
 
         BlitzenPlatform::PlatformFree(pBlock, false);
     }
@@ -63,4 +112,90 @@ namespace BlitzenCore
     {
         BlitzenPlatform::PlatformMemZero(pBlock, size);
     }
+
+    void GpuMemoryTrackAllocation(GpuMemoryCategory category, size_t size)
+    {
+        size_t index = static_cast<size_t>(category);
+        gpuMemoryState.categories[index] += size;
+        if(gpuMemoryState.categories[index] > gpuMemoryState.categoryPeaks[index])
+        {
+            gpuMemoryState.categoryPeaks[index] = gpuMemoryState.categories[index];
+        }
+    }
+
+    void GpuMemoryTrackFree(GpuMemoryCategory category, size_t size)
+    {
+        gpuMemoryState.categories[static_cast<size_t>(category)] -= size;
+    }
+
+    void GetMemoryReport(MemoryReport& report)
+    {
+        BlitzenPlatform::PlatformMemZero(&report, sizeof(MemoryReport));
+        {
+            std::lock_guard<std::mutex> lock(allocStateMutex);
+            report.cpu = allocState;
+        }
+        BlitzenPlatform::PlatformMemCopy(report.gpuCategories, gpuMemoryState.categories, sizeof(gpuMemoryState.categories));
+        BlitzenPlatform::PlatformMemCopy(report.gpuCategoryPeaks, gpuMemoryState.categoryPeaks, sizeof(gpuMemoryState.categoryPeaks));
+    }
+
+    uint8_t WriteMemoryReport(const MemoryReport& report, uint32_t frameIndex, double time)
+    {
+        for(uint32_t i = 0; i < report.gpuHeapCount; ++i)
+        {
+            const GpuHeapReport& heap = report.gpuHeaps[i];
+            if(heap.budget && static_cast<double>(heap.usage) > static_cast<double>(heap.budget) * BLITZEN_MEMORY_BUDGET_WARNING_RATIO)
+            {
+                BLIT_WARN("GPU heap %u%s is using %llu of its %llu byte budget", i, heap.bDeviceLocal ? " (device local)" : "",
+                static_cast<unsigned long long>(heap.usage), static_cast<unsigned long long>(heap.budget))
+            }
+        }
+
+        #ifdef BLITZEN_MEMORY_REPORT_FILE
+            if(!pMemoryReportFile)
+            {
+                pMemoryReportFile = fopen(BLITZEN_MEMORY_REPORT_FILE, "w");
+                if(!pMemoryReportFile)
+                {
+                    BLIT_ERROR("Failed to open %s for memory reports", BLITZEN_MEMORY_REPORT_FILE)
+                    return 0;
+                }
+            }
+            FILE* pFile = pMemoryReportFile;
+
+            fprintf(pFile, "{\"frame\":%u,\"time\":%.3f,\"cpu\":{\"total\":%llu", frameIndex, time,
+            static_cast<unsigned long long>(report.cpu.totalAllocated));
+            for(size_t i = 0; i < static_cast<size_t>(AllocationType::MaxTypes); ++i)
+            {
+                if(allocationTypeNames[i])
+                {
+                    fprintf(pFile, ",\"%s\":%llu", allocationTypeNames[i], static_cast<unsigned long long>(report.cpu.typesAllocated[i]));
+                }
+            }
+
+            fputs("},\"gpu\":{", pFile);
+            for(size_t i = 0; i < static_cast<size_t>(GpuMemoryCategory::MaxCategories); ++i)
+            {
+                fprintf(pFile, "%s\"%s\":{\"bytes\":%llu,\"peak\":%llu}", i ? "," : "", gpuMemoryCategoryNames[i],
+                static_cast<unsigned long long>(report.gpuCategories[i]), static_cast<unsigned long long>(report.gpuCategoryPeaks[i]));
+            }
+
+            fputs("},\"heaps\":[", pFile);
+            for(uint32_t i = 0; i < report.gpuHeapCount; ++i)
+            {
+                const GpuHeapReport& heap = report.gpuHeaps[i];
+                fprintf(pFile, "%s{\"deviceLocal\":%u,\"usage\":%llu,\"budget\":%llu,\"blockBytes\":%llu,\"allocationBytes\":%llu,"
+                "\"blocks\":%u,\"allocations\":%u}", i ? "," : "", static_cast<uint32_t>(heap.bDeviceLocal), 
+                static_cast<unsigned long long>(heap.usage), static_cast<unsigned long long>(heap.budget), 
+                static_cast<unsigned long long>(heap.blockBytes), static_cast<unsigned long long>(heap.allocationBytes), 
+                heap.blockCount, heap.allocationCount);
+            }
+            fputs("]}\n", pFile);
+
+            // Flushed so that the reports survive a crash, they are not written often enough for this to matter
+            fflush(pFile);
+        #endif
+
+        return 1;
+    }
 }
\ No newline at end of file
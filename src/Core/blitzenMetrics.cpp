@@ -0,0 +1,154 @@
+#include "blitMetrics.h"
+
+#include <stdio.h>
+
+namespace BlitzenCore
+{
+    struct MetricsState
+    {
+        const char* names[BLITZEN_METRICS_MAX];
+        MetricType types[BLITZEN_METRICS_MAX];
+        std::atomic<int64_t> values[BLITZEN_METRICS_MAX];
+        std::atomic<uint32_t> metricCount{0};
+        // Set by the first sample, registration is closed after it
+        std::atomic<uint8_t> bSampled{0};
+
+        // One row of samples for each stored frame
+        int64_t samples[BLITZEN_METRICS_FLUSH_FRAMES][BLITZEN_METRICS_MAX];
+        uint32_t frameIndices[BLITZEN_METRICS_FLUSH_FRAMES];
+        uint32_t sampledFrames = 0;
+
+        FILE* pFile = nullptr;
+        uint8_t bFileFailed = 0;
+    };
+
+    static MetricsState metricsState;
+
+    uint8_t MetricsRegister(const char* name, MetricType type, uint32_t& metric)
+    {
+        metric = BLITZEN_INVALID_METRIC;
+        if(metricsState.bSampled.load(std::memory_order_acquire))
+        {
+            BLIT_WARN("Metric %s was registered after the first frame was sampled and will not be recorded", name)
+            return 0;
+        }
+
+        uint32_t index = metricsState.metricCount.load(std::memory_order_relaxed);
+        if(index >= BLITZEN_METRICS_MAX)
+        {
+            BLIT_WARN("No room for metric %s, BLITZEN_METRICS_MAX is %u", name, BLITZEN_METRICS_MAX)
+            return 0;
+        }
+
+        metricsState.names[index] = name;
+        metricsState.types[index] = type;
+        metricsState.values[index].store(0, std::memory_order_relaxed);
+        metricsState.metricCount.store(index + 1, std::memory_order_release);
+        metric = index;
+        return 1;
+    }
+
+    void MetricAdd(uint32_t metric, int64_t value /* = 1 */)
+    {
+        if(metric < BLITZEN_METRICS_MAX)
+        {
+            metricsState.values[metric].fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    void MetricSet(uint32_t metric, int64_t value)
+    {
+        if(metric < BLITZEN_METRICS_MAX)
+        {
+            metricsState.values[metric].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    static void WriteMetrics()
+    {
+        #ifdef BLITZEN_METRICS_FILE
+            MetricsState& state = metricsState;
+            uint32_t metricCount = state.metricCount.load(std::memory_order_acquire);
+
+            if(!state.pFile)
+            {
+                if(state.bFileFailed)
+                {
+                    return;
+                }
+                state.pFile = fopen(BLITZEN_METRICS_FILE, "w");
+                if(!state.pFile)
+                {
+                    BLIT_ERROR("Failed to open %s for metrics", BLITZEN_METRICS_FILE)
+                    state.bFileFailed = 1;
+                    return;
+                }
+
+                #if BLITZEN_METRICS_FORMAT == BLITZEN_METRICS_FORMAT_CSV
+                    fputs("frame", state.pFile);
+                    for(uint32_t m = 0; m < metricCount; ++m)
+                    {
+                        fprintf(state.pFile, ",%s", state.names[m]);
+                    }
+                    fputc('\n', state.pFile);
+                #endif
+            }
+
+            for(uint32_t f = 0; f < state.sampledFrames; ++f)
+            {
+                #if BLITZEN_METRICS_FORMAT == BLITZEN_METRICS_FORMAT_CSV
+                    fprintf(state.pFile, "%u", state.frameIndices[f]);
+                    for(uint32_t m = 0; m < metricCount; ++m)
+                    {
+                        fprintf(state.pFile, ",%lld", static_cast<long long>(state.samples[f][m]));
+                    }
+                    fputc('\n', state.pFile);
+                #else
+                    fprintf(state.pFile, "{\"frame\":%u", state.frameIndices[f]);
+                    for(uint32_t m = 0; m < metricCount; ++m)
+                    {
+                        fprintf(state.pFile, ",\"%s\":%lld", state.names[m], static_cast<long long>(state.samples[f][m]));
+                    }
+                    fputs("}\n", state.pFile);
+                #endif
+            }
+            fflush(state.pFile);
+        #endif
+
+        metricsState.sampledFrames = 0;
+    }
+
+    void MetricsSampleFrame(uint32_t frameIndex)
+    {
+        MetricsState& state = metricsState;
+        state.bSampled.store(1, std::memory_order_release);
+        uint32_t metricCount = state.metricCount.load(std::memory_order_acquire);
+
+        int64_t* pRow = state.samples[state.sampledFrames];
+        for(uint32_t m = 0; m < metricCount; ++m)
+        {
+            pRow[m] = state.types[m] == MetricType::Counter ? state.values[m].exchange(0, std::memory_order_relaxed) :
+            state.values[m].load(std::memory_order_relaxed);
+        }
+        state.frameIndices[state.sampledFrames] = frameIndex;
+
+        if(++state.sampledFrames == BLITZEN_METRICS_FLUSH_FRAMES)
+        {
+            WriteMetrics();
+        }
+    }
+
+    void MetricsShutdown()
+    {
+        if(metricsState.sampledFrames)
+        {
+            WriteMetrics();
+        }
+
+        if(metricsState.pFile)
+        {
+            fclose(metricsState.pFile);
+            metricsState.pFile = nullptr;
+        }
+    }
+}
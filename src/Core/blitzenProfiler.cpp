@@ -0,0 +1,313 @@
+#include "blitProfiler.h"
+#include "blitMemory.h"
+#include "Platform/blitPlatform.h"
+
+#include <stdio.h>
+#include <new>
+
+namespace BlitzenCore
+{
+    #if BLITZEN_PROFILER
+        struct ProfileZone
+        {
+            const char* name;
+            uint64_t startTicks;
+            uint64_t endTicks;
+        };
+
+        // Written only by its thread. The count is published after each zone, so that the exporter only reads complete zones
+        struct ProfilerThreadRing
+        {
+            ProfileZone zones[BLITZEN_PROFILER_RING_SIZE];
+            std::atomic<uint64_t> zoneCount{0};
+            std::atomic<const char*> threadName{nullptr};
+        };
+
+        // Track zones are already in microseconds since ProfilerInit
+        struct ProfileTrackZone
+        {
+            const char* name;
+            double start;
+            double duration;
+        };
+
+        struct ProfilerTrack
+        {
+            ProfileTrackZone zones[BLITZEN_PROFILER_TRACK_SIZE];
+            std::atomic<uint64_t> zoneCount{0};
+            const char* name = nullptr;
+        };
+
+        struct ProfilerState
+        {
+            std::atomic<ProfilerThreadRing*> pRings[BLITZEN_PROFILER_MAX_THREADS];
+            std::atomic<uint32_t> ringCount{0};
+
+            std::atomic<ProfilerTrack*> pTracks[BLITZEN_PROFILER_MAX_TRACKS];
+            std::atomic<uint32_t> trackCount{0};
+
+            // Taken at init and again at export, to find out how many ticks there are in a second
+            uint64_t startTicks = 0;
+            double startTime = 0.0;
+
+            // Set once the rings are freed. Threads still hold pointers to their ring, so this is checked before they are used
+            std::atomic<uint8_t> bShutdown{0};
+        };
+
+        static ProfilerState profilerState;
+
+        // 0 until the thread records its first zone, the thread's ring or nullptr if there was no room for it after that
+        thread_local ProfilerThreadRing* pProfilerRing = nullptr;
+        thread_local uint8_t bProfilerRingClaimed = 0;
+
+        static ProfilerThreadRing* GetProfilerRing()
+        {
+            if(profilerState.bShutdown.load(std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            if(bProfilerRingClaimed)
+            {
+                return pProfilerRing;
+            }
+            bProfilerRingClaimed = 1;
+
+            uint32_t index = profilerState.ringCount.load(std::memory_order_acquire);
+            do
+            {
+                if(index >= BLITZEN_PROFILER_MAX_THREADS)
+                {
+                    static std::atomic<uint8_t> bReported{0};
+                    if(!bReported.exchange(1, std::memory_order_relaxed))
+                    {
+                        BLIT_LOG(Core, Warn, "More than %u threads record profiler zones, the ones past that are left out of the trace",
+                        BLITZEN_PROFILER_MAX_THREADS)
+                    }
+                    return nullptr;
+                }
+            } while(!profilerState.ringCount.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+
+            pProfilerRing = new(BlitAlloc(AllocationType::Engine, sizeof(ProfilerThreadRing))) ProfilerThreadRing();
+            profilerState.pRings[index].store(pProfilerRing, std::memory_order_release);
+            return pProfilerRing;
+        }
+
+        void ProfilerRecordZone(const char* name, uint64_t startTicks, uint64_t endTicks)
+        {
+            ProfilerThreadRing* pRing = GetProfilerRing();
+            if(!pRing)
+            {
+                return;
+            }
+
+            uint64_t count = pRing->zoneCount.load(std::memory_order_relaxed);
+            ProfileZone& zone = pRing->zones[count & (BLITZEN_PROFILER_RING_SIZE - 1)];
+            zone.name = name;
+            zone.startTicks = startTicks;
+            zone.endTicks = endTicks;
+            pRing->zoneCount.store(count + 1, std::memory_order_release);
+        }
+
+        void ProfilerSetThreadName(const char* name)
+        {
+            if(ProfilerThreadRing* pRing = GetProfilerRing())
+            {
+                pRing->threadName.store(name, std::memory_order_release);
+            }
+        }
+
+        uint8_t ProfilerCreateTrack(const char* name, uint32_t& track)
+        {
+            if(profilerState.bShutdown.load(std::memory_order_relaxed))
+            {
+                return 0;
+            }
+            uint32_t index = profilerState.trackCount.fetch_add(1, std::memory_order_acq_rel);
+            if(index >= BLITZEN_PROFILER_MAX_TRACKS)
+            {
+                BLIT_WARN("No room for the profiler track %s, BLITZEN_PROFILER_MAX_TRACKS is %u", name, BLITZEN_PROFILER_MAX_TRACKS)
+                return 0;
+            }
+
+            ProfilerTrack* pTrack = new(BlitAlloc(AllocationType::Engine, sizeof(ProfilerTrack))) ProfilerTrack();
+            pTrack->name = name;
+            profilerState.pTracks[index].store(pTrack, std::memory_order_release);
+            track = index;
+            return 1;
+        }
+
+        void ProfilerRecordTrackZone(uint32_t track, const char* name, double startMicroseconds, double durationMicroseconds)
+        {
+            ProfilerTrack* pTrack = track < BLITZEN_PROFILER_MAX_TRACKS ? profilerState.pTracks[track].load(std::memory_order_acquire) : nullptr;
+            if(!pTrack)
+            {
+                return;
+            }
+
+            uint64_t count = pTrack->zoneCount.load(std::memory_order_relaxed);
+            ProfileTrackZone& zone = pTrack->zones[count & (BLITZEN_PROFILER_TRACK_SIZE - 1)];
+            zone.name = name;
+            zone.start = startMicroseconds;
+            zone.duration = durationMicroseconds;
+            pTrack->zoneCount.store(count + 1, std::memory_order_release);
+        }
+
+        double ProfilerGetTime()
+        {
+            return (BlitzenPlatform::GetAbsoluteTime() - profilerState.startTime) * 1000000.0;
+        }
+
+        uint8_t ProfilerInit()
+        {
+            profilerState.startTicks = GetProfilerTicks();
+            profilerState.startTime = BlitzenPlatform::GetAbsoluteTime();
+            return 1;
+        }
+
+        static void WriteJsonString(FILE* pFile, const char* string)
+        {
+            fputc('"', pFile);
+            for(const char* c = string; *c; ++c)
+            {
+                if(*c == '"' || *c == '\\')
+                {
+                    fputc('\\', pFile);
+                }
+                fputc(*c >= ' ' ? *c : ' ', pFile);
+            }
+            fputc('"', pFile);
+        }
+
+        uint8_t ProfilerExportTrace(const char* filepath)
+        {
+            // Ticks are calibrated against the platform clock over the whole run, which is accurate enough for a constant rate counter
+            uint64_t endTicks = GetProfilerTicks();
+            double endTime = BlitzenPlatform::GetAbsoluteTime();
+            if(endTime <= profilerState.startTime || endTicks <= profilerState.startTicks)
+            {
+                BLIT_ERROR("The profiler clock has not advanced since ProfilerInit, the trace cannot be exported")
+                return 0;
+            }
+            double microsecondsPerTick = (endTime - profilerState.startTime) * 1000000.0 /
+            static_cast<double>(endTicks - profilerState.startTicks);
+
+            FILE* pFile = fopen(filepath, "w");
+            if(!pFile)
+            {
+                BLIT_ERROR("Failed to open %s for the profiler trace", filepath)
+                return 0;
+            }
+
+            fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", pFile);
+            uint8_t bFirst = 1;
+            uint64_t exportedZones = 0;
+
+            uint32_t ringCount = profilerState.ringCount.load(std::memory_order_acquire);
+            for(uint32_t i = 0; i < ringCount && i < BLITZEN_PROFILER_MAX_THREADS; ++i)
+            {
+                ProfilerThreadRing* pRing = profilerState.pRings[i].load(std::memory_order_acquire);
+                if(!pRing)
+                {
+                    continue;
+                }
+
+                if(const char* threadName = pRing->threadName.load(std::memory_order_acquire))
+                {
+                    fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",\n", i);
+                    WriteJsonString(pFile, threadName);
+                    fputs("}}", pFile);
+                    bFirst = 0;
+                }
+
+                // Only the zones that the ring still holds, minus a margin in case its thread is still recording over the oldest ones
+                uint64_t zoneCount = pRing->zoneCount.load(std::memory_order_acquire);
+                uint64_t available = zoneCount < BLITZEN_PROFILER_RING_SIZE - 64 ? zoneCount : BLITZEN_PROFILER_RING_SIZE - 64;
+                for(uint64_t z = zoneCount - available; z < zoneCount; ++z)
+                {
+                    const ProfileZone& zone = pRing->zones[z & (BLITZEN_PROFILER_RING_SIZE - 1)];
+                    // Zones from before ProfilerInit are placed at its start
+                    double start = zone.startTicks > profilerState.startTicks ?
+                    static_cast<double>(zone.startTicks - profilerState.startTicks) * microsecondsPerTick : 0.0;
+                    double duration = zone.endTicks > zone.startTicks ? static_cast<double>(zone.endTicks - zone.startTicks) * microsecondsPerTick : 0.0;
+
+                    fprintf(pFile, "%s{\"name\":", bFirst ? "" : ",\n");
+                    WriteJsonString(pFile, zone.name);
+                    fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", i, start, duration);
+                    bFirst = 0;
+                }
+                exportedZones += available;
+            }
+
+            // Tracks come after every possible thread id
+            uint32_t trackCount = profilerState.trackCount.load(std::memory_order_acquire);
+            for(uint32_t i = 0; i < trackCount && i < BLITZEN_PROFILER_MAX_TRACKS; ++i)
+            {
+                ProfilerTrack* pTrack = profilerState.pTracks[i].load(std::memory_order_acquire);
+                if(!pTrack)
+                {
+                    continue;
+                }
+                uint32_t tid = BLITZEN_PROFILER_MAX_THREADS + i;
+
+                fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",\n", tid);
+                WriteJsonString(pFile, pTrack->name);
+                fputs("}}", pFile);
+                bFirst = 0;
+
+                uint64_t zoneCount = pTrack->zoneCount.load(std::memory_order_acquire);
+                uint64_t available = zoneCount < BLITZEN_PROFILER_TRACK_SIZE - 64 ? zoneCount : BLITZEN_PROFILER_TRACK_SIZE - 64;
+                for(uint64_t z = zoneCount - available; z < zoneCount; ++z)
+                {
+                    const ProfileTrackZone& zone = pTrack->zones[z & (BLITZEN_PROFILER_TRACK_SIZE - 1)];
+                    fputs(",\n{\"name\":", pFile);
+                    WriteJsonString(pFile, zone.name);
+                    fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", tid, zone.start > 0.0 ? zone.start : 0.0,
+                    zone.duration);
+                }
+                exportedZones += available;
+            }
+
+            fputs("\n]}\n", pFile);
+            fclose(pFile);
+
+            BLIT_INFO("Profiler trace with %u zones written to %s", static_cast<uint32_t>(exportedZones), filepath)
+            return 1;
+        }
+
+        void ProfilerShutdown()
+        {
+            #ifdef BLITZEN_PROFILER_TRACE_FILE
+                ProfilerExportTrace(BLITZEN_PROFILER_TRACE_FILE);
+            #endif
+
+            // Zones recorded after this (by the thread that shuts down, the others have stopped) are dropped
+            profilerState.bShutdown.store(1, std::memory_order_relaxed);
+            uint32_t ringCount = profilerState.ringCount.exchange(0, std::memory_order_acq_rel);
+            for(uint32_t i = 0; i < ringCount && i < BLITZEN_PROFILER_MAX_THREADS; ++i)
+            {
+                if(ProfilerThreadRing* pRing = profilerState.pRings[i].exchange(nullptr, std::memory_order_acq_rel))
+                {
+                    pRing->~ProfilerThreadRing();
+                    BlitFree(AllocationType::Engine, pRing, sizeof(ProfilerThreadRing));
+                }
+            }
+            uint32_t trackCount = profilerState.trackCount.exchange(0, std::memory_order_acq_rel);
+            for(uint32_t i = 0; i < trackCount && i < BLITZEN_PROFILER_MAX_TRACKS; ++i)
+            {
+                if(ProfilerTrack* pTrack = profilerState.pTracks[i].exchange(nullptr, std::memory_order_acq_rel))
+                {
+                    pTrack->~ProfilerTrack();
+                    BlitFree(AllocationType::Engine, pTrack, sizeof(ProfilerTrack));
+                }
+            }
+        }
+    #else
+        uint8_t ProfilerInit() { return 1; }
+        void ProfilerShutdown() {}
+        void ProfilerSetThreadName(const char* /*name*/) {}
+        uint8_t ProfilerExportTrace(const char* /*filepath*/) { return 0; }
+        double ProfilerGetTime() { return 0.0; }
+        uint8_t ProfilerCreateTrack(const char* /*name*/, uint32_t& /*track*/) { return 0; }
+        void ProfilerRecordTrackZone(uint32_t /*track*/, const char* /*name*/, double /*startMicroseconds*/, double /*durationMicroseconds*/) {}
+    #endif
+}
@@ -0,0 +1,245 @@
+#include "blitSceneManifest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace BlitzenCore
+{
+    static uint32_t FindManifestScene(const SceneManifest& manifest, const char* name)
+    {
+        for(uint32_t i = 0; i < manifest.scenes.size(); ++i)
+        {
+            if(manifest.scenes[i].name == name)
+            {
+                return i;
+            }
+        }
+        return UINT32_MAX;
+    }
+
+    // Returns 0 and logs the line if the entry could not be read
+    static uint8_t ParseManifestLine(SceneManifest& manifest, const char* line, const char* filepath, uint32_t lineNumber)
+    {
+        char keyword[32];
+        if(sscanf(line, "%31s", keyword) != 1)
+        {
+            // Empty
+            return 1;
+        }
+        const char* pArguments = strstr(line, keyword) + strlen(keyword);
+
+        char name[128];
+        char path[256];
+        if(!strcmp(keyword, "scene"))
+        {
+            if(sscanf(pArguments, "%127s %255s", name, path) != 2)
+            {
+                BLIT_ERROR("%s:%u: expected scene <name> <gltf path>", filepath, lineNumber)
+                return 0;
+            }
+            if(FindManifestScene(manifest, name) != UINT32_MAX)
+            {
+                BLIT_ERROR("%s:%u: scene %s is listed twice", filepath, lineNumber, name)
+                return 0;
+            }
+            manifest.scenes.push_back(ManifestScene{name, path});
+            return 1;
+        }
+
+        if(!strcmp(keyword, "instance") || !strcmp(keyword, "array"))
+        {
+            uint8_t bArray = keyword[0] == 'a';
+            uint32_t count = 1;
+            glm::vec3 position;
+            glm::vec3 step(0.f);
+            float scale = 1.f;
+            int read = bArray ? sscanf(pArguments, "%127s %u %f %f %f %f %f %f", name, &count, &position.x, &position.y, &position.z,
+            &step.x, &step.y, &step.z) : sscanf(pArguments, "%127s %f %f %f %f", name, &position.x, &position.y, &position.z, &scale);
+            if(bArray ? read != 8 : read < 4)
+            {
+                BLIT_ERROR("%s:%u: expected %s", filepath, lineNumber, bArray ? "array <scene> <count> <x> <y> <z> <dx> <dy> <dz>" :
+                "instance <scene> <x> <y> <z> [scale]")
+                return 0;
+            }
+
+            uint32_t scene = FindManifestScene(manifest, name);
+            if(scene == UINT32_MAX)
+            {
+                BLIT_ERROR("%s:%u: scene %s is placed before it is listed", filepath, lineNumber, name)
+                return 0;
+            }
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                glm::mat4 transform = glm::translate(glm::mat4(1.f), position + step * static_cast<float>(i));
+                manifest.instances.push_back(ManifestInstance{scene, glm::scale(transform, glm::vec3(scale))});
+            }
+            return 1;
+        }
+
+        if(!strcmp(keyword, "scenario"))
+        {
+            BenchmarkScenario scenario;
+            scenario.warmup = 0.0;
+            if(sscanf(pArguments, "%127s %lf %lf", name, &scenario.duration, &scenario.warmup) < 2 || scenario.duration <= 0.0)
+            {
+                BLIT_ERROR("%s:%u: expected scenario <name> <duration> [warmup]", filepath, lineNumber)
+                return 0;
+            }
+            if(scenario.warmup >= scenario.duration)
+            {
+                BLIT_ERROR("%s:%u: the warmup of scenario %s leaves nothing to measure", filepath, lineNumber, name)
+                return 0;
+            }
+            scenario.name = name;
+            manifest.scenarios.push_back(scenario);
+            return 1;
+        }
+
+        if(!strcmp(keyword, "camera"))
+        {
+            CameraPathPoint point;
+            if(sscanf(pArguments, "%lf %f %f %f %f %f", &point.time, &point.position.x, &point.position.y, &point.position.z,
+            &point.yaw, &point.pitch) != 6)
+            {
+                BLIT_ERROR("%s:%u: expected camera <time> <x> <y> <z> <yaw> <pitch>", filepath, lineNumber)
+                return 0;
+            }
+            if(manifest.scenarios.empty())
+            {
+                BLIT_ERROR("%s:%u: camera point outside of a scenario", filepath, lineNumber)
+                return 0;
+            }
+            std::vector<CameraPathPoint>& path = manifest.scenarios.back().cameraPath;
+            if(!path.empty() && point.time <= path.back().time)
+            {
+                BLIT_ERROR("%s:%u: camera points must be in order of time", filepath, lineNumber)
+                return 0;
+            }
+            path.push_back(point);
+            return 1;
+        }
+
+        if(!strcmp(keyword, "spin"))
+        {
+            ManifestSpin spin;
+            if(sscanf(pArguments, "%127s %u %f %f %f %f", name, &spin.node, &spin.axis.x, &spin.axis.y, &spin.axis.z, &spin.speed) != 6)
+            {
+                BLIT_ERROR("%s:%u: expected spin <scene> <node> <x> <y> <z> <speed>", filepath, lineNumber)
+                return 0;
+            }
+            if(glm::length(spin.axis) == 0.f)
+            {
+                BLIT_ERROR("%s:%u: the spin axis cannot be zero", filepath, lineNumber)
+                return 0;
+            }
+            spin.scene = FindManifestScene(manifest, name);
+            if(spin.scene == UINT32_MAX)
+            {
+                BLIT_ERROR("%s:%u: scene %s is spun before it is listed", filepath, lineNumber, name)
+                return 0;
+            }
+            spin.axis = glm::normalize(spin.axis);
+            manifest.spins.push_back(spin);
+            return 1;
+        }
+
+        BLIT_ERROR("%s:%u: unknown entry %s", filepath, lineNumber, keyword)
+        return 0;
+    }
+
+    uint8_t LoadSceneManifest(const char* filepath, SceneManifest& manifest)
+    {
+        manifest = SceneManifest{};
+        FILE* pFile = fopen(filepath, "r");
+        if(!pFile)
+        {
+            return 0;
+        }
+
+        char line[512];
+        uint32_t lineNumber = 0;
+        uint8_t bValid = 1;
+        while(bValid && fgets(line, sizeof(line), pFile))
+        {
+            ++lineNumber;
+            if(char* pComment = strchr(line, '#'))
+            {
+                *pComment = 0;
+            }
+            bValid = ParseManifestLine(manifest, line, filepath, lineNumber);
+        }
+        fclose(pFile);
+
+        if(!bValid)
+        {
+            manifest = SceneManifest{};
+            return 0;
+        }
+
+        BLIT_INFO("%s: %u scenes, %u instances, %u benchmark scenarios, %u spinning nodes", filepath, static_cast<uint32_t>(manifest.scenes.size()),
+        static_cast<uint32_t>(manifest.instances.size()), static_cast<uint32_t>(manifest.scenarios.size()), static_cast<uint32_t>(manifest.spins.size()))
+        return 1;
+    }
+
+    void GetDefaultSceneManifest(SceneManifest& manifest)
+    {
+        manifest = SceneManifest{};
+        manifest.scenes.push_back(ManifestScene{"structure", "Assets/structure.glb"});
+        manifest.scenes.push_back(ManifestScene{"city", "Assets/Highpoly.glb"});
+        manifest.instances.push_back(ManifestInstance{0, glm::mat4(1.f)});
+        manifest.instances.push_back(ManifestInstance{1, glm::mat4(1.f)});
+
+        // Release builds stress the renderer with 300 more copies of the city, in three lines that zigzag around one axis each
+        #ifdef NDEBUG
+            float iter = 1.f;
+            for(float f = 0.f; f < 100.f; f += 1.f)
+            {
+                iter *= -1.f;
+                manifest.instances.push_back(ManifestInstance{1, glm::translate(glm::mat4(1.f), glm::vec3(-iter, iter, -f))});
+            }
+            for(float f = 0.f; f < 100.f; f += 1.f)
+            {
+                iter *= -1.f;
+                manifest.instances.push_back(ManifestInstance{1, glm::translate(glm::mat4(1.f), glm::vec3(iter, f, -iter))});
+            }
+            for(float f = 0.f; f < 100.f; f += 1.f)
+            {
+                iter *= -1.f;
+                manifest.instances.push_back(ManifestInstance{1, glm::translate(glm::mat4(1.f), glm::vec3(f, -iter, iter))});
+            }
+        #endif
+    }
+
+    uint8_t GetCameraPathPoint(const BenchmarkScenario& scenario, double time, CameraPathPoint& point)
+    {
+        const std::vector<CameraPathPoint>& path = scenario.cameraPath;
+        if(path.empty())
+        {
+            return 0;
+        }
+        if(time <= path.front().time)
+        {
+            point = path.front();
+            return 1;
+        }
+
+        for(size_t i = 1; i < path.size(); ++i)
+        {
+            if(time < path[i].time)
+            {
+                const CameraPathPoint& from = path[i - 1];
+                const CameraPathPoint& to = path[i];
+                float t = static_cast<float>((time - from.time) / (to.time - from.time));
+                point.time = time;
+                point.position = glm::mix(from.position, to.position, t);
+                point.yaw = from.yaw + (to.yaw - from.yaw) * t;
+                point.pitch = from.pitch + (to.pitch - from.pitch) * t;
+                return 1;
+            }
+        }
+
+        point = path.back();
+        return 1;
+    }
+}
@@ -0,0 +1,269 @@
+#include "blitStartup.h"
+#include "blitProfiler.h"
+#include "Platform/blitPlatform.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+namespace BlitzenCore
+{
+    static void ExecuteStartupTask(StartupTask& task);
+
+    static void StartupTaskJob(void* pData)
+    {
+        ExecuteStartupTask(*reinterpret_cast<StartupTask*>(pData));
+    }
+
+    // Main thread tasks wait for the thread that runs the graph to pick them up, the others go to the job threads
+    static void QueueStartupTask(StartupTask& task)
+    {
+        StartupGraph& graph = *task.pGraph;
+        if(task.bMainThread)
+        {
+            {
+                std::lock_guard<std::mutex> lock(graph.mainThreadMutex);
+                graph.mainThreadQueue[graph.mainThreadQueueCount++] = static_cast<uint32_t>(&task - graph.tasks);
+                graph.mainThreadIdle.value.store(0, std::memory_order_release);
+            }
+            return;
+        }
+        RunJob(StartupTaskJob, &task, &graph.jobs);
+    }
+
+    // Timed with the platform's clock rather than the profiler's, so that the report still works when the profiler is compiled out
+    static double GetStartupTime(const StartupGraph& graph)
+    {
+        return (BlitzenPlatform::GetAbsoluteTime() - graph.startTime) * 1000.0;
+    }
+
+    static void ExecuteStartupTask(StartupTask& task)
+    {
+        StartupGraph& graph = *task.pGraph;
+
+        task.status = StartupTaskStatus::Complete;
+        for(uint32_t i = 0; i < task.dependencyCount; ++i)
+        {
+            if(graph.tasks[task.dependencies[i]].status != StartupTaskStatus::Complete)
+            {
+                task.status = StartupTaskStatus::Skipped;
+            }
+        }
+
+        task.threadIndex = JobSystemGetThreadIndex();
+        task.startTime = GetStartupTime(graph);
+        if(task.status == StartupTaskStatus::Complete)
+        {
+            BLIT_PROFILE_SCOPE(task.name)
+            if(!task.pfnFunction(task.pData))
+            {
+                task.status = StartupTaskStatus::Failed;
+            }
+        }
+        task.endTime = GetStartupTime(graph);
+
+        // The release makes the status visible to the tasks that this one starts
+        uint32_t index = static_cast<uint32_t>(&task - graph.tasks);
+        for(uint32_t i = index + 1; i < graph.taskCount; ++i)
+        {
+            StartupTask& dependent = graph.tasks[i];
+            for(uint32_t d = 0; d < dependent.dependencyCount; ++d)
+            {
+                if(dependent.dependencies[d] == index && dependent.remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    QueueStartupTask(dependent);
+                }
+            }
+        }
+
+        if(graph.finishedTasks.fetch_add(1, std::memory_order_acq_rel) + 1 == graph.taskCount)
+        {
+            std::lock_guard<std::mutex> lock(graph.mainThreadMutex);
+            graph.mainThreadIdle.value.store(0, std::memory_order_release);
+        }
+    }
+
+    static const char* GetStartupTaskStatusName(StartupTaskStatus status)
+    {
+        switch(status)
+        {
+            case StartupTaskStatus::Complete: return "done";
+            case StartupTaskStatus::Failed: return "FAILED";
+            case StartupTaskStatus::Skipped: return "skipped";
+            default: return "pending";
+        }
+    }
+
+    // Every line goes to the log without a site limit, so that no task is dropped, and to the report file
+    static void WriteStartupReportLine(FILE* pFile, const char* format, ...)
+    {
+        char line[640];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+
+        BLIT_LOG_LIMITED(Core, Info, 0, "%s", line)
+        if(pFile)
+        {
+            fprintf(pFile, "%s\n", line);
+        }
+    }
+
+    static void WriteStartupReport(StartupGraph& graph, double totalTime)
+    {
+        FILE* pFile = nullptr;
+        #ifdef BLITZEN_STARTUP_REPORT_FILE
+            pFile = fopen(BLITZEN_STARTUP_REPORT_FILE, "w");
+            if(!pFile)
+            {
+                BLIT_ERROR("Failed to open %s for the startup report", BLITZEN_STARTUP_REPORT_FILE)
+            }
+        #endif
+
+        double workTime = 0.0;
+        uint32_t lastTask = 0;
+        for(uint32_t i = 0; i < graph.taskCount; ++i)
+        {
+            const StartupTask& task = graph.tasks[i];
+            workTime += task.endTime - task.startTime;
+            if(task.endTime > graph.tasks[lastTask].endTime)
+            {
+                lastTask = i;
+            }
+            WriteStartupReportLine(pFile, "Startup %-20s %8.2fms -> %8.2fms (%8.2fms) thread %2i %s", task.name, task.startTime, task.endTime,
+            task.endTime - task.startTime, task.threadIndex == BLITZEN_JOBS_INVALID_THREAD ? -1 : static_cast<int32_t>(task.threadIndex),
+            GetStartupTaskStatusName(task.status));
+        }
+
+        // Walks back from the task that finished last through whichever dependency finished last, that is what the total waited on
+        char path[512];
+        size_t length = 0;
+        path[0] = 0;
+        uint32_t index = lastTask;
+        for(;;)
+        {
+            const StartupTask& task = graph.tasks[index];
+            int written = snprintf(path + length, sizeof(path) - length, length ? " <- %s" : "%s", task.name);
+            if(written < 0 || length + written >= sizeof(path))
+            {
+                break;
+            }
+            length += written;
+
+            if(!task.dependencyCount)
+            {
+                break;
+            }
+            index = task.dependencies[0];
+            for(uint32_t d = 1; d < task.dependencyCount; ++d)
+            {
+                if(graph.tasks[task.dependencies[d]].endTime > graph.tasks[index].endTime)
+                {
+                    index = task.dependencies[d];
+                }
+            }
+        }
+
+        WriteStartupReportLine(pFile, "Startup took %.2fms for %.2fms of work, critical path: %s", totalTime, workTime, path);
+        if(pFile)
+        {
+            fclose(pFile);
+        }
+    }
+
+    uint32_t StartupAddTask(StartupGraph& graph, const char* name, pfnStartupTask pfnFunction, void* pData,
+    std::initializer_list<uint32_t> dependencies /* = {} */, uint8_t bMainThread /* = 0 */)
+    {
+        if(graph.taskCount == BLITZEN_STARTUP_MAX_TASKS || dependencies.size() > BLITZEN_STARTUP_MAX_DEPENDENCIES)
+        {
+            BLIT_ERROR("No room for startup task %s", name)
+            return BLITZEN_STARTUP_MAX_TASKS;
+        }
+
+        uint32_t index = graph.taskCount;
+        StartupTask& task = graph.tasks[index];
+        task.name = name;
+        task.pfnFunction = pfnFunction;
+        task.pData = pData;
+        task.bMainThread = bMainThread;
+        task.dependencyCount = 0;
+        for(uint32_t dependency : dependencies)
+        {
+            // Waiting for a later task (or one that could not be added) would never finish
+            if(dependency >= index)
+            {
+                BLIT_ERROR("Startup task %s waits for a task that was not added before it", name)
+                return BLITZEN_STARTUP_MAX_TASKS;
+            }
+            task.dependencies[task.dependencyCount++] = dependency;
+        }
+        task.status = StartupTaskStatus::Pending;
+        task.threadIndex = BLITZEN_JOBS_INVALID_THREAD;
+        task.startTime = 0.0;
+        task.endTime = 0.0;
+        task.pGraph = &graph;
+
+        ++graph.taskCount;
+        return index;
+    }
+
+    uint8_t StartupRun(StartupGraph& graph)
+    {
+        if(!graph.taskCount)
+        {
+            return 1;
+        }
+
+        graph.startTime = BlitzenPlatform::GetAbsoluteTime();
+        graph.finishedTasks.store(0, std::memory_order_relaxed);
+        graph.mainThreadQueueCount = 0;
+        graph.mainThreadIdle.value.store(1, std::memory_order_relaxed);
+        for(uint32_t i = 0; i < graph.taskCount; ++i)
+        {
+            graph.tasks[i].remainingDependencies.store(graph.tasks[i].dependencyCount, std::memory_order_relaxed);
+        }
+
+        for(uint32_t i = 0; i < graph.taskCount; ++i)
+        {
+            if(!graph.tasks[i].dependencyCount)
+            {
+                QueueStartupTask(graph.tasks[i]);
+            }
+        }
+
+        // Runs jobs until a main thread task is ready or the graph is done
+        for(;;)
+        {
+            WaitForCounter(&graph.mainThreadIdle, 0);
+
+            uint32_t index;
+            {
+                std::lock_guard<std::mutex> lock(graph.mainThreadMutex);
+                if(!graph.mainThreadQueueCount)
+                {
+                    if(graph.finishedTasks.load(std::memory_order_acquire) == graph.taskCount)
+                    {
+                        break;
+                    }
+                    graph.mainThreadIdle.value.store(1, std::memory_order_relaxed);
+                    continue;
+                }
+                index = graph.mainThreadQueue[--graph.mainThreadQueueCount];
+            }
+            ExecuteStartupTask(graph.tasks[index]);
+        }
+        // The jobs hold on to the graph until their counter is released
+        WaitForCounter(&graph.jobs, 0);
+
+        WriteStartupReport(graph, GetStartupTime(graph));
+
+        for(uint32_t i = 0; i < graph.taskCount; ++i)
+        {
+            if(graph.tasks[i].status != StartupTaskStatus::Complete)
+            {
+                return 0;
+            }
+        }
+        return 1;
+    }
+}
@@ -0,0 +1,172 @@
+#include "blitThreadAffinity.h"
+#include "Platform/blitPlatform.h"
+
+#include <algorithm>
+
+namespace BlitzenCore
+{
+    struct ThreadAffinityState
+    {
+        uint8_t policy = BLITZEN_THREAD_AFFINITY_NONE;
+        uint8_t bInitialized = 0;
+        uint8_t bRenderThread = 0;
+
+        BlitzenPlatform::CpuTopology topology;
+
+        // Physical cores policy: one processor per core, in the order that threads get them
+        uint16_t coreSlots[BLITZEN_PLATFORM_MAX_CPUS];
+        uint32_t coreSlotCount = 0;
+
+        // Cache group policy: the processors of the main thread's group
+        uint16_t groupCpus[BLITZEN_PLATFORM_MAX_CPUS];
+        uint32_t groupCpuCount = 0;
+        uint32_t groupCoreCount = 0;
+    };
+
+    static ThreadAffinityState threadAffinityState;
+
+    uint8_t ThreadAffinityInit(uint8_t bRenderThread, uint8_t policy /* = BLITZEN_THREAD_AFFINITY_POLICY */)
+    {
+        ThreadAffinityState& state = threadAffinityState;
+        BlitzenPlatform::CpuTopology& topology = state.topology;
+        if(!BlitzenPlatform::PlatformGetCpuTopology(topology))
+        {
+            BLIT_WARN("Processor topology is incomplete, every logical processor is treated as a core")
+        }
+        if(!topology.cpuCount)
+        {
+            BLIT_ERROR("No processors were found, threads will not be pinned")
+            return 0;
+        }
+
+        BLIT_INFO("%u logical processors, %u cores, %u cache groups, %u packages%s", topology.cpuCount, topology.coreCount,
+        topology.cacheGroupCount, topology.packageCount, topology.bHybrid ? ", hybrid" : "")
+
+        // First hardware thread of every core, fastest cores first, then grouped by cache so that neighbouring threads share one
+        uint8_t fastestClass = 0;
+        for(uint32_t i = 0; i < topology.cpuCount; ++i)
+        {
+            fastestClass = std::max(fastestClass, topology.cpus[i].efficiencyClass);
+        }
+        uint32_t order[BLITZEN_PLATFORM_MAX_CPUS];
+        uint32_t orderCount = 0;
+        for(uint32_t i = 0; i < topology.cpuCount; ++i)
+        {
+            const BlitzenPlatform::CpuInfo& cpu = topology.cpus[i];
+            if(cpu.smtIndex == 0 && (BLITZEN_THREAD_AFFINITY_USE_EFFICIENCY_CORES || cpu.efficiencyClass == fastestClass))
+            {
+                order[orderCount++] = i;
+            }
+        }
+        std::stable_sort(order, order + orderCount, [&topology](uint32_t a, uint32_t b)
+        {
+            const BlitzenPlatform::CpuInfo& cpuA = topology.cpus[a];
+            const BlitzenPlatform::CpuInfo& cpuB = topology.cpus[b];
+            if(cpuA.efficiencyClass != cpuB.efficiencyClass)
+            {
+                return cpuA.efficiencyClass > cpuB.efficiencyClass;
+            }
+            return cpuA.cacheGroup < cpuB.cacheGroup;
+        });
+        state.coreSlotCount = orderCount;
+        for(uint32_t i = 0; i < orderCount; ++i)
+        {
+            state.coreSlots[i] = topology.cpus[order[i]].osIndex;
+        }
+
+        // The main thread's group is the one of the first core slot
+        uint16_t mainGroup = orderCount ? topology.cpus[order[0]].cacheGroup : 0;
+        state.groupCpuCount = 0;
+        state.groupCoreCount = 0;
+        for(uint32_t i = 0; i < topology.cpuCount; ++i)
+        {
+            if(topology.cpus[i].cacheGroup == mainGroup)
+            {
+                state.groupCpus[state.groupCpuCount++] = topology.cpus[i].osIndex;
+                state.groupCoreCount += topology.cpus[i].smtIndex == 0;
+            }
+        }
+
+        state.policy = policy;
+        state.bRenderThread = bRenderThread;
+        state.bInitialized = 1;
+        return 1;
+    }
+
+    uint32_t ThreadAffinityGetWorkerCount()
+    {
+        const ThreadAffinityState& state = threadAffinityState;
+        uint32_t reserved = 1 + state.bRenderThread;
+        uint32_t available = 0;
+        switch(state.bInitialized ? state.policy : BLITZEN_THREAD_AFFINITY_NONE)
+        {
+            case BLITZEN_THREAD_AFFINITY_PHYSICAL_CORES:
+            {
+                available = state.coreSlotCount;
+                break;
+            }
+            case BLITZEN_THREAD_AFFINITY_CACHE_GROUP:
+            {
+                available = state.groupCoreCount;
+                break;
+            }
+            default:
+            {
+                // Left to the job system, which uses every hardware thread
+                return 0;
+            }
+        }
+        // There is always at least one worker, even if it has to share
+        return available > reserved ? available - reserved : 1;
+    }
+
+    void ThreadAffinityPinCurrentThread(ThreadRole role, uint32_t index /* = 0 */)
+    {
+        const ThreadAffinityState& state = threadAffinityState;
+        if(!state.bInitialized)
+        {
+            return;
+        }
+
+        if(state.policy == BLITZEN_THREAD_AFFINITY_PHYSICAL_CORES && state.coreSlotCount)
+        {
+            // Main takes slot 0, render (if there is one) slot 1 and workers the rest. Workers that do not fit wrap around onto the
+            // slots after the main thread's
+            uint32_t slot = 0;
+            switch(role)
+            {
+                case ThreadRole::Main:
+                {
+                    slot = 0;
+                    break;
+                }
+                case ThreadRole::Render:
+                {
+                    slot = 1;
+                    break;
+                }
+                case ThreadRole::Worker:
+                {
+                    slot = 1 + state.bRenderThread + index;
+                    break;
+                }
+            }
+            if(slot >= state.coreSlotCount)
+            {
+                uint32_t firstShared = state.coreSlotCount > 1 ? 1 : 0;
+                slot = firstShared + slot % (state.coreSlotCount - firstShared);
+            }
+            if(!BlitzenPlatform::PlatformSetThreadAffinity(&state.coreSlots[slot], 1))
+            {
+                BLIT_WARN("Failed to pin thread to processor %u", state.coreSlots[slot])
+            }
+        }
+        else if(state.policy == BLITZEN_THREAD_AFFINITY_CACHE_GROUP && state.groupCpuCount)
+        {
+            if(!BlitzenPlatform::PlatformSetThreadAffinity(state.groupCpus, state.groupCpuCount))
+            {
+                BLIT_WARN("Failed to restrict thread to its cache group")
+            }
+        }
+    }
+}
@@ -7,19 +7,21 @@ namespace BlitzenEngine
         m_pWindowWidth = pWindowWidth;
         m_pWindowHeight = pWindowHeight;
 
-        RotateCamera(0.f, 0.f, deltaTime);
+        RotateCamera(0.f, 0.f);
         MoveCamera(deltaTime);
+        // Nothing to interpolate from before the first step
+        m_previousPosition = m_position;
     }
 
-    void Camera::RotateCamera(float yawMovement, float pitchMovement, float deltaTime)
+    void Camera::RotateCamera(float yawMovement, float pitchMovement)
     {
         if(yawMovement < 100.f && yawMovement > -100.f)
         {
-            m_yaw += (yawMovement * m_sensitivity * deltaTime) / 50.f;
+            m_yaw += yawMovement * m_sensitivity;
         }
         if(pitchMovement < 100.f && pitchMovement > -100.f)
         {
-            m_pitch -= (pitchMovement * m_sensitivity * deltaTime) / 50.f;
+            m_pitch -= pitchMovement * m_sensitivity;
         }
 
         glm::quat pitchRotation = glm::angleAxis(m_pitch, glm::vec3(1.0f, 0.f, 0.f));
@@ -29,10 +31,35 @@ namespace BlitzenEngine
 
     void Camera::MoveCamera(float deltaTime)
     {
+        m_previousPosition = m_position;
         m_position += glm::vec3(m_rotationMatrix * glm::vec4(m_velocity * m_speed * deltaTime, 0.f));
         glm::mat4 translationMatrix = glm::translate(glm::mat4(1.f), m_position);
 
         m_viewMatrix = glm::inverse(translationMatrix * m_rotationMatrix);
         m_projectionView = m_projectionMatrix * m_viewMatrix ;
     }
+
+    void Camera::SetPose(const glm::vec3& position, float yaw, float pitch)
+    {
+        m_previousPosition = m_position;
+        m_position = position;
+        m_yaw = yaw;
+        m_pitch = pitch;
+
+        glm::quat pitchRotation = glm::angleAxis(m_pitch, glm::vec3(1.0f, 0.f, 0.f));
+        glm::quat yawRotation = glm::angleAxis(m_yaw, glm::vec3(0.f, -1.f, 0.f));
+        m_rotationMatrix = glm::toMat4(yawRotation) * glm::toMat4(pitchRotation);
+
+        m_viewMatrix = glm::inverse(glm::translate(glm::mat4(1.f), m_position) * m_rotationMatrix);
+        m_projectionView = m_projectionMatrix * m_viewMatrix;
+    }
+
+    void Camera::InterpolateView(float alpha)
+    {
+        glm::vec3 position = glm::mix(m_previousPosition, m_position, glm::clamp(alpha, 0.f, 1.f));
+        glm::mat4 translationMatrix = glm::translate(glm::mat4(1.f), position);
+
+        m_viewMatrix = glm::inverse(translationMatrix * m_rotationMatrix);
+        m_projectionView = m_projectionMatrix * m_viewMatrix;
+    }
 }
\ No newline at end of file
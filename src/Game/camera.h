@@ -9,9 +9,18 @@ namespace BlitzenEngine
     public:
         void Init(float deltaTime, const uint32_t* windowWidth, const uint32_t* windowHeight);
 
+        // One simulation step. The position before it is kept, so that frames drawn between two steps can be placed in between
         void MoveCamera(float deltaTime);
 
-        void RotateCamera(float yawMovement, float pitchMovement, float deltaTime);
+        // Builds the view matrix with the position at the given fraction (0 to 1) of the way from the previous step to the last one.
+        // Rotation comes straight from the mouse and is never interpolated, so that looking around has no added latency
+        void InterpolateView(float alpha);
+
+        // Takes the mouse movement in pixels. The turn only depends on how far the mouse moved, not on the time or how the OS split the moves
+        void RotateCamera(float yawMovement, float pitchMovement);
+
+        // Places the camera directly as one simulation step, for scripted camera paths
+        void SetPose(const glm::vec3& position, float yaw, float pitch);
 
         inline const glm::mat4& GetViewMatrix() const {return m_viewMatrix;}
         inline const glm::mat4& GetProjectionMatrix() const {return m_projectionMatrix;}
@@ -42,6 +51,7 @@ namespace BlitzenEngine
 
         //Used to set the translation of the view matrix
         glm::vec3 m_position = glm::vec3(0.f, 0.f, -5.f);
+        glm::vec3 m_previousPosition = glm::vec3(0.f, 0.f, -5.f);
 
         //Dictate the current direction of the camera and sets the current rotation matrix
         float m_pitch = 0;
@@ -49,7 +59,8 @@ namespace BlitzenEngine
         glm::mat4 m_rotationMatrix = glm::mat4(1.f);
 
         //Data for how fast the camera should move and change direction
-        float m_sensitivity = 10.f;
+        // Radians for each pixel, about what the old per-frame scaling turned at 60 frames per second
+        float m_sensitivity = 0.0033f;
         float m_speed = 100.f;
 
         //Used to set up the projection matrix with glm::perspective
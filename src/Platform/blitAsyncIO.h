@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Core/blitLogger.h"
+
+// Reads that can be waiting or in flight at once, each one holds a handle until its result is taken (must be a power of 2)
+#define BLITZEN_ASYNC_IO_MAX_REQUESTS           256
+// When this is set, Linux reads go through io_uring. If it is 0 or the kernel refuses it, the thread pool below is used instead
+#define BLITZEN_ASYNC_IO_URING                  1
+// Reads that the io_uring backend keeps submitted to the kernel at once
+#define BLITZEN_ASYNC_IO_URING_DEPTH            64
+// Threads of the fallback backend, each one does a single blocking read at a time
+#define BLITZEN_ASYNC_IO_THREADS                2
+#define BLITZEN_ASYNC_IO_MAX_PATH               256
+
+namespace BlitzenPlatform
+{
+    // Waiting reads are started in priority order, reads of the same priority in the order they were submitted
+    enum class IoPriority : uint8_t
+    {
+        High = 0,
+        Normal = 1,
+        Low = 2,
+
+        MaxPriorities = 3
+    };
+
+    enum class IoStatus : uint8_t
+    {
+        // The handle is stale or was never given out
+        Invalid = 0,
+        Pending = 1,
+        Complete = 2,
+        Failed = 3
+    };
+
+    struct IoHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    // Called on the I/O thread as soon as the read is done. It should only hand the result to another thread, never block
+    typedef void (*pfnIoComplete)(IoHandle handle, IoStatus status, void* pUserData);
+
+    struct IoReadRequest
+    {
+        // Copied when the read is submitted
+        const char* filepath = nullptr;
+
+        uint64_t offset = 0;
+        // 0 reads from the offset to the end of the file
+        uint64_t size = 0;
+
+        // Where the data is written. When this is null, a buffer of the read size plus the padding is allocated with PlatformMalloc
+        // and belongs to the caller once the result is taken
+        void* pBuffer = nullptr;
+        uint64_t bufferSize = 0;
+        // Zeroed bytes after the data of an allocated buffer, for parsers that read past the end
+        uint64_t padding = 0;
+
+        IoPriority priority = IoPriority::Normal;
+
+        pfnIoComplete pfnCallback = nullptr;
+        void* pUserData = nullptr;
+    };
+
+    // Starts the backend's threads. Returns 0 if neither backend could start, submissions fail after that
+    uint8_t AsyncIoInit();
+    // Finishes every read that was submitted before stopping. Results that were not taken are freed
+    void AsyncIoShutdown();
+
+    // Queues the reads together, the backend is woken once for the whole batch. Returns how many were queued, a handle that
+    // could not be given out (no free slot, path too long) is left invalid. Safe to call from any thread
+    uint32_t AsyncIoSubmitReads(const IoReadRequest* pRequests, uint32_t count, IoHandle* pHandles);
+
+    IoStatus AsyncIoGetStatus(IoHandle handle);
+    // Waits until the read is no longer pending. Job threads run queued jobs while they wait, other threads block
+    IoStatus AsyncIoWait(IoHandle handle);
+
+    // Waits for the read, gives its buffer and the bytes that were read, and frees the handle. When the read failed, the data is null
+    // and a buffer that the read allocated is freed here
+    IoStatus AsyncIoTakeResult(IoHandle handle, void*& pData, uint64_t& size);
+
+    // Reads on the calling thread, without a slot. For reads whose submission was refused, so that they are not lost when every
+    // slot is taken. The buffer is given out the same way as by AsyncIoTakeResult
+    IoStatus AsyncIoReadBlocking(const IoReadRequest& request, void*& pData, uint64_t& size);
+
+    // Takes the result of the read that was submitted for the request, or reads it on the calling thread when its handle was left invalid
+    IoStatus AsyncIoTakeOrRead(IoHandle handle, const IoReadRequest& request, void*& pData, uint64_t& size);
+}
@@ -5,10 +5,21 @@
 
 #if _MSC_VER
     #define VULKAN_SURFACE_KHR_EXTENSION_NAME       "VK_KHR_win32_surface"
-#elif linux
-    #define VULKAN_SURFACE_KHR_EXTENSION_NAME       //I don't know yet, I will look it up later
+    #define BLITZEN_PLATFORM_HEADLESS               0
+#elif defined(__linux__)
+    // Linux runs are for benchmark machines without a display, no window is created and the swapchain presents to nothing
+    #define VULKAN_SURFACE_KHR_EXTENSION_NAME       "VK_EXT_headless_surface"
+    #define BLITZEN_PLATFORM_HEADLESS               1
 #endif
 
+// When this is set, the window is owned by a dedicated thread that collects OS input as it arrives. 
+// The main thread only drains the collected events in PlatformPumpMessages
+#define BLITZEN_PLATFORM_INPUT_THREAD           1
+// How many events the input thread can collect before the main thread drains them (must be a power of 2)
+#define BLITZEN_PLATFORM_EVENT_QUEUE_SIZE       1024
+// Logical processors that the topology can describe, the ones past this are ignored
+#define BLITZEN_PLATFORM_MAX_CPUS               256
+
 namespace BlitzenPlatform
 {
     struct PlatformState
@@ -17,10 +28,41 @@ namespace BlitzenPlatform
         void* pInternalState;
     };
 
+    enum class PlatformEventType : uint8_t
+    {
+        Key = 0,
+        MouseButton = 1,
+        MouseMove = 2,
+        MouseWheel = 3,
+        WindowResize = 4,
+        WindowClose = 5,
+        // The state is 1 when the window gained focus and 0 when it lost it
+        WindowFocus = 6
+    };
+
+    // An OS input event translated to the engine's terms
+    struct PlatformEvent
+    {
+        PlatformEventType type;
+        // Pressed state for keys and buttons, wheel direction for the mouse wheel
+        int8_t state;
+        // Key or button
+        uint16_t code;
+        // Mouse position or window size
+        int32_t x;
+        int32_t y;
+    };
+
+    // Passes a collected event to the input and event systems. Called on the main thread only
+    void DispatchPlatformEvent(const PlatformEvent& event);
+
     uint8_t PlatformStartup(PlatformState* pState, const char* appName, int32_t initialX, int32_t initialY, uint32_t windowWidth, uint32_t windowHeight);
     void PlatformShutdown(PlatformState* pState);
 
     uint8_t PlatformPumpMessages(PlatformState* pState);
+    // Blocks the calling thread until the OS has an event for the window or the timeout (in seconds) runs out. A negative timeout
+    // waits for as long as it takes. Returns 1 if an event is waiting. Meant for the main thread while there is nothing to draw
+    uint8_t PlatformWaitForEvents(PlatformState* pState, double timeout);
 
     /* -------------------------------------------------------------------------------------------------------
         These will not be called by systems directly, they're meant to aid the custom allocation functions, 
@@ -39,6 +81,41 @@ namespace BlitzenPlatform
     double GetAbsoluteTime();
 
     void PSleep(uint64_t ms);
+    // Sleeps with the best resolution the OS offers, which can still oversleep, callers that need to be exact spin for the rest
+    void PSleepPrecise(double seconds);
 
     void CreateVulkanSurface(PlatformState* pState, VkInstance& instance, VkSurfaceKHR& surface, VkAllocationCallbacks* pAllocator);
+
+    // A logical processor that the process is allowed to run on
+    struct CpuInfo
+    {
+        // The OS's number for it, which is what affinity masks use
+        uint16_t osIndex;
+        // Physical core, last level cache group and package, numbered from 0 in the order they were found
+        uint16_t core;
+        uint16_t cacheGroup;
+        uint16_t package;
+        // 0 for the first hardware thread of its core, 1 for its SMT sibling, etc.
+        uint8_t smtIndex;
+        // Higher is faster. Every processor is 0 on machines that do not mix core types
+        uint8_t efficiencyClass;
+    };
+
+    struct CpuTopology
+    {
+        CpuInfo cpus[BLITZEN_PLATFORM_MAX_CPUS];
+        uint32_t cpuCount;
+        uint32_t coreCount;
+        uint32_t cacheGroupCount;
+        uint32_t packageCount;
+        // Set when there are cores of more than one efficiency class
+        uint8_t bHybrid;
+    };
+
+    // Fills the topology of the processors that the process may use. When the details cannot be found, every logical processor
+    // is reported as its own core in a single cache group, and 0 is returned
+    uint8_t PlatformGetCpuTopology(CpuTopology& topology);
+
+    // Restricts the calling thread to the given processors (OS indices). Returns 0 if the OS refused
+    uint8_t PlatformSetThreadAffinity(const uint16_t* pOsIndices, uint32_t count);
 }
\ No newline at end of file
@@ -0,0 +1,886 @@
+#include "blitAsyncIO.h"
+#include "blitPlatform.h"
+#include "Core/blitProfiler.h"
+#include "Core/blitMetrics.h"
+#include "Core/blitJobs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__linux__)
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+    #if BLITZEN_ASYNC_IO_URING
+        // io_uring is used through its system calls directly, so that liburing is not needed
+        #include <poll.h>
+        #include <sys/mman.h>
+        #include <sys/syscall.h>
+        #include <sys/eventfd.h>
+        #include <linux/io_uring.h>
+    #endif
+#endif
+
+namespace BlitzenPlatform
+{
+    struct IoRequestSlot
+    {
+        char filepath[BLITZEN_ASYNC_IO_MAX_PATH];
+        uint64_t offset;
+        uint64_t size;
+
+        uint8_t* pBuffer;
+        uint64_t bufferSize;
+        uint64_t padding;
+        uint8_t bOwnsBuffer;
+
+        IoPriority priority;
+        pfnIoComplete pfnCallback;
+        void* pUserData;
+
+        uint64_t bytesRead;
+
+        // The open file while the read is in flight
+        #if defined(__linux__)
+            int fd;
+            // Given to IORING_OP_READV, so it has to live until the read completes
+            struct iovec iov;
+        #else
+            FILE* pFile;
+        #endif
+
+        std::atomic<uint32_t> generation{0};
+        // Invalid while the slot is free
+        std::atomic<IoStatus> status{IoStatus::Invalid};
+        // 1 while the read is pending, so that job threads can wait on it with WaitForCounter and keep running jobs
+        BlitzenCore::JobCounter pendingCounter;
+    };
+
+    #if defined(__linux__) && BLITZEN_ASYNC_IO_URING
+        // Marks the completion of the poll on the wake eventfd, every other completion holds the index of its slot
+        #define BLITZEN_ASYNC_IO_WAKE_DATA      UINT64_MAX
+
+        struct IoUring
+        {
+            int ringFd = -1;
+            // Written by submitters, the ring keeps a poll on it so that the I/O thread wakes up for new reads
+            int wakeFd = -1;
+            uint8_t bWakeArmed = 0;
+
+            void* pSqRing = nullptr;
+            size_t sqRingSize = 0;
+            void* pCqRing = nullptr;
+            size_t cqRingSize = 0;
+            io_uring_sqe* pSqes = nullptr;
+            size_t sqesSize = 0;
+
+            unsigned* pSqHead;
+            unsigned* pSqTail;
+            unsigned* pSqMask;
+            unsigned* pSqArray;
+            unsigned sqEntries;
+            unsigned* pCqHead;
+            unsigned* pCqTail;
+            unsigned* pCqMask;
+            io_uring_cqe* pCqes;
+
+            // Entries added to the submission ring since the last io_uring_enter
+            uint32_t toSubmit = 0;
+            uint32_t inFlight = 0;
+            // One entry is always left for the wake poll
+            uint32_t maxInFlight = 0;
+        };
+    #endif
+
+    struct AsyncIoState
+    {
+        IoRequestSlot slots[BLITZEN_ASYNC_IO_MAX_REQUESTS];
+        uint32_t freeSlots[BLITZEN_ASYNC_IO_MAX_REQUESTS];
+        uint32_t freeCount = 0;
+
+        // Waiting reads of each priority, as rings of slot indices
+        uint32_t queues[static_cast<size_t>(IoPriority::MaxPriorities)][BLITZEN_ASYNC_IO_MAX_REQUESTS];
+        uint32_t queueHeads[static_cast<size_t>(IoPriority::MaxPriorities)];
+        uint32_t queueTails[static_cast<size_t>(IoPriority::MaxPriorities)];
+        uint32_t queuedCount = 0;
+
+        // Guards the free slots, the queues and bRunning
+        std::mutex mutex;
+        // The pool threads sleep on this while there is nothing to read
+        std::condition_variable queueCondition;
+
+        // Threads in AsyncIoWait sleep on this until a read completes
+        std::mutex completionMutex;
+        std::condition_variable completionCondition;
+
+        std::thread threads[BLITZEN_ASYNC_IO_THREADS];
+        char threadNames[BLITZEN_ASYNC_IO_THREADS][16];
+        uint32_t threadCount = 0;
+
+        uint8_t bRunning = 0;
+        uint8_t bInitialized = 0;
+        uint8_t bUring = 0;
+
+        #if defined(__linux__) && BLITZEN_ASYNC_IO_URING
+            IoUring uring;
+        #endif
+
+        uint32_t readBytesMetric = BLITZEN_INVALID_METRIC;
+    };
+
+    static AsyncIoState asyncIoState;
+
+    // Called with the mutex held
+    static uint8_t PopQueuedRead(uint32_t& index)
+    {
+        AsyncIoState& state = asyncIoState;
+        for(size_t p = 0; p < static_cast<size_t>(IoPriority::MaxPriorities); ++p)
+        {
+            if(state.queueHeads[p] != state.queueTails[p])
+            {
+                index = state.queues[p][state.queueHeads[p]++ & (BLITZEN_ASYNC_IO_MAX_REQUESTS - 1)];
+                --state.queuedCount;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // Settles the size of the read against the size of the file and allocates its buffer if the caller did not give one
+    static uint8_t PrepareReadBuffer(IoRequestSlot& slot, uint64_t fileSize)
+    {
+        if(slot.offset > fileSize || (slot.size && slot.size > fileSize - slot.offset))
+        {
+            BLIT_ERROR("Read of %llu bytes at %llu is past the end of %s", static_cast<unsigned long long>(slot.size),
+            static_cast<unsigned long long>(slot.offset), slot.filepath)
+            return 0;
+        }
+        if(!slot.size)
+        {
+            slot.size = fileSize - slot.offset;
+        }
+
+        if(slot.pBuffer)
+        {
+            if(slot.bufferSize < slot.size)
+            {
+                BLIT_ERROR("Buffer of %llu bytes is too small for the %llu bytes of %s", static_cast<unsigned long long>(slot.bufferSize),
+                static_cast<unsigned long long>(slot.size), slot.filepath)
+                return 0;
+            }
+            return 1;
+        }
+
+        slot.pBuffer = reinterpret_cast<uint8_t*>(PlatformMalloc(static_cast<size_t>(slot.size + slot.padding), 0));
+        if(!slot.pBuffer)
+        {
+            BLIT_ERROR("Failed to allocate %llu bytes for %s", static_cast<unsigned long long>(slot.size + slot.padding), slot.filepath)
+            return 0;
+        }
+        slot.bOwnsBuffer = 1;
+        if(slot.padding)
+        {
+            PlatformMemZero(slot.pBuffer + slot.size, static_cast<size_t>(slot.padding));
+        }
+        return 1;
+    }
+
+    #if defined(__linux__)
+        static uint8_t OpenReadFile(IoRequestSlot& slot)
+        {
+            slot.fd = open(slot.filepath, O_RDONLY | O_CLOEXEC);
+            if(slot.fd < 0)
+            {
+                BLIT_ERROR("Failed to open %s for reading", slot.filepath)
+                return 0;
+            }
+
+            struct stat fileStat;
+            if(fstat(slot.fd, &fileStat) != 0 || !PrepareReadBuffer(slot, static_cast<uint64_t>(fileStat.st_size)))
+            {
+                close(slot.fd);
+                slot.fd = -1;
+                return 0;
+            }
+            return 1;
+        }
+
+        static void CloseReadFile(IoRequestSlot& slot)
+        {
+            close(slot.fd);
+            slot.fd = -1;
+        }
+
+        static uint8_t ReadFileBlocking(IoRequestSlot& slot)
+        {
+            while(slot.bytesRead < slot.size)
+            {
+                ssize_t result = pread(slot.fd, slot.pBuffer + slot.bytesRead, static_cast<size_t>(slot.size - slot.bytesRead),
+                static_cast<off_t>(slot.offset + slot.bytesRead));
+                if(result < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if(result <= 0)
+                {
+                    break;
+                }
+                slot.bytesRead += static_cast<uint64_t>(result);
+            }
+            return slot.bytesRead == slot.size;
+        }
+    #else
+        static uint8_t OpenReadFile(IoRequestSlot& slot)
+        {
+            slot.pFile = fopen(slot.filepath, "rb");
+            if(!slot.pFile)
+            {
+                BLIT_ERROR("Failed to open %s for reading", slot.filepath)
+                return 0;
+            }
+
+            // The 64-bit seek, so that files over 2GB can be read
+            int64_t fileSize = _fseeki64(slot.pFile, 0, SEEK_END) == 0 ? _ftelli64(slot.pFile) : -1;
+            if(fileSize < 0 || !PrepareReadBuffer(slot, static_cast<uint64_t>(fileSize)))
+            {
+                fclose(slot.pFile);
+                slot.pFile = nullptr;
+                return 0;
+            }
+            return 1;
+        }
+
+        static void CloseReadFile(IoRequestSlot& slot)
+        {
+            fclose(slot.pFile);
+            slot.pFile = nullptr;
+        }
+
+        static uint8_t ReadFileBlocking(IoRequestSlot& slot)
+        {
+            if(_fseeki64(slot.pFile, static_cast<int64_t>(slot.offset), SEEK_SET) != 0)
+            {
+                return 0;
+            }
+            slot.bytesRead = fread(slot.pBuffer, 1, static_cast<size_t>(slot.size), slot.pFile);
+            return slot.bytesRead == slot.size;
+        }
+    #endif
+
+    static void CompleteRead(uint32_t index, IoStatus status)
+    {
+        IoRequestSlot& slot = asyncIoState.slots[index];
+        // Taken before the status is published, the slot may be freed by its owner right after
+        pfnIoComplete pfnCallback = slot.pfnCallback;
+        void* pUserData = slot.pUserData;
+        IoHandle handle{index, slot.generation.load(std::memory_order_relaxed)};
+
+        BlitzenCore::MetricAdd(asyncIoState.readBytesMetric, static_cast<int64_t>(slot.bytesRead));
+        slot.status.store(status, std::memory_order_release);
+        slot.pendingCounter.value.store(0, std::memory_order_release);
+        if(pfnCallback)
+        {
+            pfnCallback(handle, status, pUserData);
+        }
+
+        // Taking the lock keeps a waiter from missing the notification between its check and its wait
+        {
+            std::lock_guard<std::mutex> lock(asyncIoState.completionMutex);
+        }
+        asyncIoState.completionCondition.notify_all();
+    }
+
+    static void IoPoolThread(uint32_t threadIndex)
+    {
+        AsyncIoState& state = asyncIoState;
+        BlitzenCore::ProfilerSetThreadName(state.threadNames[threadIndex]);
+
+        for(;;)
+        {
+            uint32_t index;
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.queueCondition.wait(lock, [&state]() { return state.queuedCount || !state.bRunning; });
+                // Only stops once every read is done
+                if(!PopQueuedRead(index))
+                {
+                    return;
+                }
+            }
+
+            BLIT_PROFILE_SCOPE("AsyncRead")
+            IoRequestSlot& slot = state.slots[index];
+            IoStatus status = IoStatus::Failed;
+            if(OpenReadFile(slot))
+            {
+                if(ReadFileBlocking(slot))
+                {
+                    status = IoStatus::Complete;
+                }
+                else
+                {
+                    BLIT_ERROR("Read %llu of %llu bytes from %s", static_cast<unsigned long long>(slot.bytesRead),
+                    static_cast<unsigned long long>(slot.size), slot.filepath)
+                }
+                CloseReadFile(slot);
+            }
+            CompleteRead(index, status);
+        }
+    }
+
+    #if defined(__linux__) && BLITZEN_ASYNC_IO_URING
+        static void UringShutdown(IoUring& ring)
+        {
+            if(ring.pSqes)
+            {
+                munmap(ring.pSqes, ring.sqesSize);
+            }
+            if(ring.pCqRing && ring.pCqRing != ring.pSqRing)
+            {
+                munmap(ring.pCqRing, ring.cqRingSize);
+            }
+            if(ring.pSqRing)
+            {
+                munmap(ring.pSqRing, ring.sqRingSize);
+            }
+            if(ring.wakeFd >= 0)
+            {
+                close(ring.wakeFd);
+            }
+            if(ring.ringFd >= 0)
+            {
+                close(ring.ringFd);
+            }
+            ring = IoUring{};
+        }
+
+        static uint8_t UringInit(IoUring& ring)
+        {
+            io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            ring.ringFd = static_cast<int>(syscall(__NR_io_uring_setup, BLITZEN_ASYNC_IO_URING_DEPTH, &params));
+            if(ring.ringFd < 0)
+            {
+                return 0;
+            }
+
+            ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            // Newer kernels map both rings with one call
+            uint8_t bSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if(bSingleMap && ring.cqRingSize > ring.sqRingSize)
+            {
+                ring.sqRingSize = ring.cqRingSize;
+            }
+
+            void* pSqRing = mmap(nullptr, ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.ringFd, IORING_OFF_SQ_RING);
+            if(pSqRing == MAP_FAILED)
+            {
+                UringShutdown(ring);
+                return 0;
+            }
+            ring.pSqRing = pSqRing;
+
+            void* pCqRing = bSingleMap ? pSqRing :
+            mmap(nullptr, ring.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.ringFd, IORING_OFF_CQ_RING);
+            if(pCqRing == MAP_FAILED)
+            {
+                UringShutdown(ring);
+                return 0;
+            }
+            ring.pCqRing = pCqRing;
+
+            ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* pSqes = mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.ringFd, IORING_OFF_SQES);
+            if(pSqes == MAP_FAILED)
+            {
+                UringShutdown(ring);
+                return 0;
+            }
+            ring.pSqes = reinterpret_cast<io_uring_sqe*>(pSqes);
+
+            uint8_t* pSq = reinterpret_cast<uint8_t*>(pSqRing);
+            ring.pSqHead = reinterpret_cast<unsigned*>(pSq + params.sq_off.head);
+            ring.pSqTail = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+            ring.pSqMask = reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+            ring.pSqArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+            ring.sqEntries = params.sq_entries;
+
+            uint8_t* pCq = reinterpret_cast<uint8_t*>(pCqRing);
+            ring.pCqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+            ring.pCqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+            ring.pCqMask = reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+            ring.pCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+
+            ring.maxInFlight = params.sq_entries - 1;
+
+            ring.wakeFd = eventfd(0, EFD_CLOEXEC);
+            if(ring.wakeFd < 0)
+            {
+                UringShutdown(ring);
+                return 0;
+            }
+            return 1;
+        }
+
+        // Only the I/O thread writes the submission ring, the kernel reads the entries up to the tail once it is published
+        static io_uring_sqe* UringGetSqe(IoUring& ring)
+        {
+            unsigned tail = *ring.pSqTail;
+            unsigned head = __atomic_load_n(ring.pSqHead, __ATOMIC_ACQUIRE);
+            if(tail - head >= ring.sqEntries)
+            {
+                return nullptr;
+            }
+            unsigned index = tail & *ring.pSqMask;
+            io_uring_sqe* pSqe = &ring.pSqes[index];
+            memset(pSqe, 0, sizeof(io_uring_sqe));
+            ring.pSqArray[index] = index;
+            return pSqe;
+        }
+
+        static void UringCommitSqe(IoUring& ring)
+        {
+            __atomic_store_n(ring.pSqTail, *ring.pSqTail + 1, __ATOMIC_RELEASE);
+            ++ring.toSubmit;
+        }
+
+        // Asks for whatever the slot has not read yet, so a short read is continued by calling this again
+        static void UringQueueRead(IoUring& ring, uint32_t index)
+        {
+            IoRequestSlot& slot = asyncIoState.slots[index];
+            io_uring_sqe* pSqe = UringGetSqe(ring);
+            slot.iov.iov_base = slot.pBuffer + slot.bytesRead;
+            slot.iov.iov_len = static_cast<size_t>(slot.size - slot.bytesRead);
+            pSqe->opcode = IORING_OP_READV;
+            pSqe->fd = slot.fd;
+            pSqe->addr = reinterpret_cast<uint64_t>(&slot.iov);
+            pSqe->len = 1;
+            pSqe->off = slot.offset + slot.bytesRead;
+            pSqe->user_data = index;
+            UringCommitSqe(ring);
+        }
+
+        static void UringArmWake(IoUring& ring)
+        {
+            io_uring_sqe* pSqe = UringGetSqe(ring);
+            pSqe->opcode = IORING_OP_POLL_ADD;
+            pSqe->fd = ring.wakeFd;
+            pSqe->poll32_events = POLLIN;
+            pSqe->user_data = BLITZEN_ASYNC_IO_WAKE_DATA;
+            UringCommitSqe(ring);
+            ring.bWakeArmed = 1;
+        }
+
+        static void UringFinishRead(IoUring& ring, uint32_t index, IoStatus status)
+        {
+            CloseReadFile(asyncIoState.slots[index]);
+            --ring.inFlight;
+            CompleteRead(index, status);
+        }
+
+        static void UringHandleCompletion(IoUring& ring, const io_uring_cqe& cqe)
+        {
+            if(cqe.user_data == BLITZEN_ASYNC_IO_WAKE_DATA)
+            {
+                // Resets the eventfd, so that the next poll waits for the next submission
+                uint64_t value;
+                ssize_t drained = read(ring.wakeFd, &value, sizeof(value));
+                (void)drained;
+                ring.bWakeArmed = 0;
+                return;
+            }
+
+            uint32_t index = static_cast<uint32_t>(cqe.user_data);
+            IoRequestSlot& slot = asyncIoState.slots[index];
+            if(cqe.res == -EINTR || cqe.res == -EAGAIN)
+            {
+                UringQueueRead(ring, index);
+            }
+            else if(cqe.res < 0)
+            {
+                BLIT_ERROR("Reading %s failed with error %d", slot.filepath, -cqe.res)
+                UringFinishRead(ring, index, IoStatus::Failed);
+            }
+            else
+            {
+                slot.bytesRead += static_cast<uint64_t>(cqe.res);
+                if(slot.bytesRead == slot.size)
+                {
+                    UringFinishRead(ring, index, IoStatus::Complete);
+                }
+                else if(cqe.res == 0)
+                {
+                    BLIT_ERROR("Read %llu of %llu bytes from %s", static_cast<unsigned long long>(slot.bytesRead),
+                    static_cast<unsigned long long>(slot.size), slot.filepath)
+                    UringFinishRead(ring, index, IoStatus::Failed);
+                }
+                else
+                {
+                    UringQueueRead(ring, index);
+                }
+            }
+        }
+
+        static void IoUringThread()
+        {
+            AsyncIoState& state = asyncIoState;
+            IoUring& ring = state.uring;
+            BlitzenCore::ProfilerSetThreadName("IO");
+
+            for(;;)
+            {
+                if(!ring.bWakeArmed)
+                {
+                    UringArmWake(ring);
+                }
+
+                // Opens the waiting reads while the ring has room. Opening is synchronous, but it is cheap next to the reads
+                uint8_t bStopping = 0;
+                while(ring.inFlight < ring.maxInFlight)
+                {
+                    uint32_t index;
+                    {
+                        std::lock_guard<std::mutex> lock(state.mutex);
+                        if(!PopQueuedRead(index))
+                        {
+                            bStopping = !state.bRunning;
+                            break;
+                        }
+                    }
+
+                    IoRequestSlot& slot = state.slots[index];
+                    if(!OpenReadFile(slot))
+                    {
+                        CompleteRead(index, IoStatus::Failed);
+                        continue;
+                    }
+                    // An empty read would complete with 0 bytes, which looks like the end of the file
+                    if(!slot.size)
+                    {
+                        CloseReadFile(slot);
+                        CompleteRead(index, IoStatus::Complete);
+                        continue;
+                    }
+                    ++ring.inFlight;
+                    UringQueueRead(ring, index);
+                }
+
+                if(bStopping && !ring.inFlight)
+                {
+                    return;
+                }
+
+                int result = static_cast<int>(syscall(__NR_io_uring_enter, ring.ringFd, ring.toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+                if(result >= 0)
+                {
+                    ring.toSubmit -= static_cast<uint32_t>(result);
+                }
+                else if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                {
+                    BLIT_ERROR("io_uring_enter failed with error %d", errno)
+                }
+
+                unsigned head = *ring.pCqHead;
+                unsigned tail = __atomic_load_n(ring.pCqTail, __ATOMIC_ACQUIRE);
+                while(head != tail)
+                {
+                    UringHandleCompletion(ring, ring.pCqes[head & *ring.pCqMask]);
+                    ++head;
+                }
+                __atomic_store_n(ring.pCqHead, head, __ATOMIC_RELEASE);
+            }
+        }
+    #endif
+
+    uint8_t AsyncIoInit()
+    {
+        AsyncIoState& state = asyncIoState;
+        if(state.bInitialized)
+        {
+            return 1;
+        }
+
+        // Reversed, so that the first reads get the first slots
+        for(uint32_t i = 0; i < BLITZEN_ASYNC_IO_MAX_REQUESTS; ++i)
+        {
+            state.freeSlots[i] = BLITZEN_ASYNC_IO_MAX_REQUESTS - 1 - i;
+        }
+        state.freeCount = BLITZEN_ASYNC_IO_MAX_REQUESTS;
+        state.bRunning = 1;
+        BlitzenCore::MetricsRegister("IoReadBytes", BlitzenCore::MetricType::Counter, state.readBytesMetric);
+
+        #if defined(__linux__) && BLITZEN_ASYNC_IO_URING
+            if(UringInit(state.uring))
+            {
+                state.bUring = 1;
+                state.threads[0] = std::thread(IoUringThread);
+                state.threadCount = 1;
+                state.bInitialized = 1;
+                BLIT_INFO("Async I/O started with io_uring, %u reads in flight", state.uring.maxInFlight)
+                return 1;
+            }
+            BLIT_WARN("io_uring is not available, async I/O falls back to blocking reads on %u threads", BLITZEN_ASYNC_IO_THREADS)
+        #endif
+
+        for(uint32_t i = 0; i < BLITZEN_ASYNC_IO_THREADS; ++i)
+        {
+            snprintf(state.threadNames[i], sizeof(state.threadNames[i]), "IO %u", i);
+            state.threads[i] = std::thread(IoPoolThread, i);
+        }
+        state.threadCount = BLITZEN_ASYNC_IO_THREADS;
+        state.bInitialized = 1;
+        BLIT_INFO("Async I/O started with %u threads", BLITZEN_ASYNC_IO_THREADS)
+        return 1;
+    }
+
+    static void WakeIoThreads(uint32_t newReads)
+    {
+        #if defined(__linux__) && BLITZEN_ASYNC_IO_URING
+            if(asyncIoState.bUring)
+            {
+                uint64_t value = 1;
+                if(write(asyncIoState.uring.wakeFd, &value, sizeof(value)) < 0)
+                {
+                    BLIT_ERROR("Failed to wake the io_uring thread")
+                }
+                return;
+            }
+        #endif
+
+        if(newReads > 1)
+        {
+            asyncIoState.queueCondition.notify_all();
+        }
+        else
+        {
+            asyncIoState.queueCondition.notify_one();
+        }
+    }
+
+    void AsyncIoShutdown()
+    {
+        AsyncIoState& state = asyncIoState;
+        if(!state.bInitialized)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.bRunning = 0;
+        }
+        WakeIoThreads(state.threadCount);
+        for(uint32_t i = 0; i < state.threadCount; ++i)
+        {
+            state.threads[i].join();
+        }
+        state.threadCount = 0;
+
+        #if defined(__linux__) && BLITZEN_ASYNC_IO_URING
+            if(state.bUring)
+            {
+                UringShutdown(state.uring);
+                state.bUring = 0;
+            }
+        #endif
+
+        for(uint32_t i = 0; i < BLITZEN_ASYNC_IO_MAX_REQUESTS; ++i)
+        {
+            IoRequestSlot& slot = state.slots[i];
+            if(slot.status.load(std::memory_order_acquire) != IoStatus::Invalid && slot.bOwnsBuffer)
+            {
+                PlatformFree(slot.pBuffer, 0);
+            }
+            slot.status.store(IoStatus::Invalid, std::memory_order_relaxed);
+        }
+        state.bInitialized = 0;
+    }
+
+    uint32_t AsyncIoSubmitReads(const IoReadRequest* pRequests, uint32_t count, IoHandle* pHandles)
+    {
+        AsyncIoState& state = asyncIoState;
+        if(!state.bInitialized)
+        {
+            BLIT_ERROR("Reads submitted before async I/O was initialized")
+            return 0;
+        }
+
+        uint32_t queued = 0;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                const IoReadRequest& request = pRequests[i];
+                pHandles[i] = IoHandle{};
+                if(!request.filepath || strlen(request.filepath) >= BLITZEN_ASYNC_IO_MAX_PATH)
+                {
+                    BLIT_ERROR("Read submitted without a path or with one longer than %u characters", BLITZEN_ASYNC_IO_MAX_PATH - 1)
+                    continue;
+                }
+                if(!state.freeCount)
+                {
+                    BLIT_WARN("No room to read %s, BLITZEN_ASYNC_IO_MAX_REQUESTS is %u", request.filepath, BLITZEN_ASYNC_IO_MAX_REQUESTS)
+                    continue;
+                }
+
+                uint32_t index = state.freeSlots[--state.freeCount];
+                IoRequestSlot& slot = state.slots[index];
+                strcpy(slot.filepath, request.filepath);
+                slot.offset = request.offset;
+                slot.size = request.size;
+                slot.pBuffer = reinterpret_cast<uint8_t*>(request.pBuffer);
+                slot.bufferSize = request.bufferSize;
+                slot.padding = request.padding;
+                slot.bOwnsBuffer = 0;
+                slot.priority = request.priority < IoPriority::MaxPriorities ? request.priority : IoPriority::Low;
+                slot.pfnCallback = request.pfnCallback;
+                slot.pUserData = request.pUserData;
+                slot.bytesRead = 0;
+                slot.pendingCounter.value.store(1, std::memory_order_relaxed);
+                slot.status.store(IoStatus::Pending, std::memory_order_relaxed);
+
+                size_t priority = static_cast<size_t>(slot.priority);
+                state.queues[priority][state.queueTails[priority]++ & (BLITZEN_ASYNC_IO_MAX_REQUESTS - 1)] = index;
+                ++state.queuedCount;
+
+                pHandles[i] = IoHandle{index, slot.generation.load(std::memory_order_relaxed)};
+                ++queued;
+            }
+        }
+
+        // Once for the whole batch
+        if(queued)
+        {
+            WakeIoThreads(queued);
+        }
+        return queued;
+    }
+
+    IoStatus AsyncIoGetStatus(IoHandle handle)
+    {
+        if(handle.index >= BLITZEN_ASYNC_IO_MAX_REQUESTS)
+        {
+            return IoStatus::Invalid;
+        }
+        IoRequestSlot& slot = asyncIoState.slots[handle.index];
+        if(slot.generation.load(std::memory_order_relaxed) != handle.generation)
+        {
+            return IoStatus::Invalid;
+        }
+        return slot.status.load(std::memory_order_acquire);
+    }
+
+    IoStatus AsyncIoWait(IoHandle handle)
+    {
+        IoStatus status = AsyncIoGetStatus(handle);
+        if(status != IoStatus::Pending)
+        {
+            return status;
+        }
+
+        BLIT_PROFILE_SCOPE("AsyncIoWait")
+        // A job thread runs other jobs until the read is done, instead of taking a worker away from the job system
+        if(BlitzenCore::JobSystemGetThreadIndex() != BLITZEN_JOBS_INVALID_THREAD)
+        {
+            BlitzenCore::WaitForCounter(&asyncIoState.slots[handle.index].pendingCounter);
+            return AsyncIoGetStatus(handle);
+        }
+
+        std::unique_lock<std::mutex> lock(asyncIoState.completionMutex);
+        asyncIoState.completionCondition.wait(lock, [&status, handle]()
+        {
+            status = AsyncIoGetStatus(handle);
+            return status != IoStatus::Pending;
+        });
+        return status;
+    }
+
+    IoStatus AsyncIoTakeResult(IoHandle handle, void*& pData, uint64_t& size)
+    {
+        pData = nullptr;
+        size = 0;
+        IoStatus status = AsyncIoWait(handle);
+        if(status == IoStatus::Invalid)
+        {
+            return status;
+        }
+
+        AsyncIoState& state = asyncIoState;
+        IoRequestSlot& slot = state.slots[handle.index];
+        if(status == IoStatus::Complete)
+        {
+            pData = slot.pBuffer;
+            size = slot.bytesRead;
+        }
+        else if(slot.bOwnsBuffer && slot.pBuffer)
+        {
+            PlatformFree(slot.pBuffer, 0);
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        slot.generation.fetch_add(1, std::memory_order_relaxed);
+        slot.status.store(IoStatus::Invalid, std::memory_order_relaxed);
+        state.freeSlots[state.freeCount++] = handle.index;
+        return status;
+    }
+
+    IoStatus AsyncIoReadBlocking(const IoReadRequest& request, void*& pData, uint64_t& size)
+    {
+        pData = nullptr;
+        size = 0;
+        if(!request.filepath || strlen(request.filepath) >= BLITZEN_ASYNC_IO_MAX_PATH)
+        {
+            BLIT_ERROR("Read requested without a path or with one longer than %u characters", BLITZEN_ASYNC_IO_MAX_PATH - 1)
+            return IoStatus::Invalid;
+        }
+
+        BLIT_PROFILE_SCOPE("BlockingRead")
+        // Goes through the same steps as a read of the pool threads, with a slot that never leaves this function
+        IoRequestSlot slot;
+        strcpy(slot.filepath, request.filepath);
+        slot.offset = request.offset;
+        slot.size = request.size;
+        slot.pBuffer = reinterpret_cast<uint8_t*>(request.pBuffer);
+        slot.bufferSize = request.bufferSize;
+        slot.padding = request.padding;
+        slot.bOwnsBuffer = 0;
+        slot.bytesRead = 0;
+        if(!OpenReadFile(slot))
+        {
+            return IoStatus::Failed;
+        }
+
+        uint8_t bRead = ReadFileBlocking(slot);
+        CloseReadFile(slot);
+        BlitzenCore::MetricAdd(asyncIoState.readBytesMetric, static_cast<int64_t>(slot.bytesRead));
+        if(!bRead)
+        {
+            BLIT_ERROR("Read %llu of %llu bytes from %s", static_cast<unsigned long long>(slot.bytesRead),
+            static_cast<unsigned long long>(slot.size), slot.filepath)
+            if(slot.bOwnsBuffer)
+            {
+                PlatformFree(slot.pBuffer, 0);
+            }
+            return IoStatus::Failed;
+        }
+
+        pData = slot.pBuffer;
+        size = slot.bytesRead;
+        return IoStatus::Complete;
+    }
+
+    IoStatus AsyncIoTakeOrRead(IoHandle handle, const IoReadRequest& request, void*& pData, uint64_t& size)
+    {
+        if(AsyncIoGetStatus(handle) == IoStatus::Invalid)
+        {
+            return AsyncIoReadBlocking(request, pData, size);
+        }
+        return AsyncIoTakeResult(handle, pData, size);
+    }
+}
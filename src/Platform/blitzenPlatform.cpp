@@ -1,8 +1,85 @@
+#define BLIT_LOG_CHANNEL    Platform
+
 #include "blitPlatform.h"
 #include "Core/blitEvents.h"
+#include "Core/blitzenContainerLibrary.h"
+
+// Included outside the namespace, since the C library declarations have to stay global
+#if defined(__linux__)
+    #include <time.h>
+    #include <errno.h>
+    #include <signal.h>
+    #include <unistd.h>
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <sched.h>
+#endif
 
 namespace BlitzenPlatform
 {
+    // What each platform finds out about a processor, before cores and cache groups are numbered
+    struct RawCpuInfo
+    {
+        uint16_t osIndex;
+        // Equal keys mean the same core, cache or package, their values mean nothing otherwise
+        uint32_t coreKey;
+        uint32_t cacheKey;
+        uint32_t packageKey;
+        uint8_t efficiencyClass;
+    };
+
+    // Numbers cores, cache groups and packages from 0 in the order the processors are given and finds the SMT siblings
+    static void BuildCpuTopology(CpuTopology& topology, const RawCpuInfo* pRaw, uint32_t count)
+    {
+        topology.cpuCount = count;
+        topology.coreCount = 0;
+        topology.cacheGroupCount = 0;
+        topology.packageCount = 0;
+        topology.bHybrid = 0;
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            CpuInfo& cpu = topology.cpus[i];
+            cpu.osIndex = pRaw[i].osIndex;
+            cpu.efficiencyClass = pRaw[i].efficiencyClass;
+            cpu.smtIndex = 0;
+
+            uint32_t first = i;
+            for(uint32_t j = 0; j < i; ++j)
+            {
+                if(pRaw[j].coreKey == pRaw[i].coreKey && pRaw[j].packageKey == pRaw[i].packageKey)
+                {
+                    first = first == i ? j : first;
+                    ++cpu.smtIndex;
+                }
+            }
+            cpu.core = first == i ? static_cast<uint16_t>(topology.coreCount++) : topology.cpus[first].core;
+
+            first = i;
+            for(uint32_t j = 0; j < i && first == i; ++j)
+            {
+                first = pRaw[j].cacheKey == pRaw[i].cacheKey ? j : first;
+            }
+            cpu.cacheGroup = first == i ? static_cast<uint16_t>(topology.cacheGroupCount++) : topology.cpus[first].cacheGroup;
+
+            first = i;
+            for(uint32_t j = 0; j < i && first == i; ++j)
+            {
+                first = pRaw[j].packageKey == pRaw[i].packageKey ? j : first;
+            }
+            cpu.package = first == i ? static_cast<uint16_t>(topology.packageCount++) : topology.cpus[first].package;
+
+            topology.bHybrid |= cpu.efficiencyClass != topology.cpus[0].efficiencyClass;
+        }
+
+        // A machine with one kind of core has a single class, whatever value the OS gave it
+        for(uint32_t i = 0; !topology.bHybrid && i < count; ++i)
+        {
+            topology.cpus[i].efficiencyClass = 0;
+        }
+    }
+
     #if _MSC_VER
         #include <windows.h>
         #include <windowsx.h>
@@ -11,22 +88,121 @@ namespace BlitzenPlatform
         #include "vulkan/vulkan_win32.h"
 
 
+        // Posted to the window by PlatformShutdown, so that the window gets destroyed by the thread that created it
+        #define BLITZEN_WIN32_DESTROY_WINDOW_MESSAGE        (WM_USER + 1)
+
         struct InternalState
         {
-            HWND windowHandle;
-            HINSTANCE windowsInstance;
+            HWND windowHandle = nullptr;
+            HINSTANCE windowsInstance = nullptr;
+
+            // Used when the window is owned by the input thread
+            HANDLE inputThread = nullptr;
+            HANDLE windowReadyEvent = nullptr;
+            uint8_t bWindowCreated = 0;
+
+            // Window creation parameters, saved so that the input thread can create the window
+            const char* appName;
+            int32_t initialX;
+            int32_t initialY;
+            uint32_t width;
+            uint32_t height;
+
+            // Filled by the input thread, drained by the main thread
+            BlitCL::SpscRingBuffer<PlatformEvent, BLITZEN_PLATFORM_EVENT_QUEUE_SIZE> eventQueue;
+            // Signaled for every event that is pushed, so that a main thread with nothing to draw can wait for one
+            HANDLE eventsAvailable = nullptr;
         };
 
-        inline double clockFrequency;
+        static InternalState* pPlatformInternalState;
+
         inline LARGE_INTEGER startTime;
 
         // Will be given as a function pointer to be called by window when an event occurs
         LRESULT CALLBACK Win32ProcessMessage(HWND winWindow, uint32_t msg, WPARAM w_param, LPARAM l_param);
 
+        uint8_t Win32CreateWindow(InternalState* pInternalState);
+
+        // Creates the window and keeps receiving its messages until it is destroyed
+        DWORD WINAPI Win32InputThread(LPVOID pParameter)
+        {
+            InternalState* pInternalState = reinterpret_cast<InternalState*>(pParameter);
+
+            pInternalState->bWindowCreated = Win32CreateWindow(pInternalState);
+            SetEvent(pInternalState->windowReadyEvent);
+            if(!pInternalState->bWindowCreated)
+            {
+                return 0;
+            }
+
+            // Unlike the main thread, this one can afford to sleep until the OS has something for it
+            MSG message;
+            while(GetMessageA(&message, nullptr, 0, 0) > 0)
+            {
+                TranslateMessage(&message);
+                DispatchMessageA(&message);
+            }
+
+            return 0;
+        }
+
+        // Sends an event to the main thread if the input thread is active, otherwise passes it to the engine immediately
+        void SubmitPlatformEvent(PlatformEvent& event)
+        {
+            #if BLITZEN_PLATFORM_INPUT_THREAD
+                // Input should never be lost, so if the main thread has fallen too far behind, wait for it to catch up
+                while(!pPlatformInternalState->eventQueue.Push(event))
+                {
+                    Sleep(0);
+                }
+                SetEvent(pPlatformInternalState->eventsAvailable);
+            #else
+                DispatchPlatformEvent(event);
+            #endif
+        }
+
         uint8_t PlatformStartup(PlatformState* pState, const char* appName, int32_t initialX, int32_t initialY, uint32_t width, uint32_t height)
         {
-            pState->pInternalState = malloc(sizeof(InternalState));
+            pState->pInternalState = new InternalState();
             InternalState* pInternalState = reinterpret_cast<InternalState*>(pState->pInternalState);
+            pPlatformInternalState = pInternalState;
+
+            pInternalState->appName = appName;
+            pInternalState->initialX = initialX;
+            pInternalState->initialY = initialY;
+            pInternalState->width = width;
+            pInternalState->height = height;
+
+            // Clock setup, similar thing to glfwGetTime
+            QueryPerformanceCounter(&startTime);
+
+            #if BLITZEN_PLATFORM_INPUT_THREAD
+                // Auto reset, a wait consumes the signal and the queue is drained after it anyway
+                pInternalState->eventsAvailable = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+                pInternalState->windowReadyEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+                pInternalState->inputThread = CreateThread(nullptr, 0, Win32InputThread, pInternalState, 0, nullptr);
+                if(!pInternalState->inputThread)
+                {
+                    BLIT_FATAL("Failed to create the input thread")
+                    return 0;
+                }
+                // The window handle is needed by the renderer, so the engine cannot continue before the window exists
+                WaitForSingleObject(pInternalState->windowReadyEvent, INFINITE);
+                CloseHandle(pInternalState->windowReadyEvent);
+                pInternalState->windowReadyEvent = nullptr;
+                return pInternalState->bWindowCreated;
+            #else
+                return Win32CreateWindow(pInternalState);
+            #endif
+        }
+
+        uint8_t Win32CreateWindow(InternalState* pInternalState)
+        {
+            const char* appName = pInternalState->appName;
+            int32_t initialX = pInternalState->initialX;
+            int32_t initialY = pInternalState->initialY;
+            uint32_t width = pInternalState->width;
+            uint32_t height = pInternalState->height;
 
             pInternalState->windowsInstance = GetModuleHandleA(0);
 
@@ -99,12 +275,6 @@ namespace BlitzenPlatform
             int32_t show = shouldActivate ? SW_SHOW : SW_SHOWNOACTIVATE;
             ShowWindow(pInternalState->windowHandle, show);
 
-            // Clock setup, similar thing to glfwGetTime
-            LARGE_INTEGER frequency;
-            QueryPerformanceFrequency(&frequency);
-            clockFrequency = 1.0 / static_cast<double>(frequency.QuadPart);// The quad part is just a 64 bit integer
-            QueryPerformanceCounter(&startTime);
-
             // Tell the engine that the function was successful
             return 1;
         }
@@ -112,14 +282,44 @@ namespace BlitzenPlatform
         void PlatformShutdown(PlatformState* pState)
         {
             InternalState* pInternalState = reinterpret_cast<InternalState*>(pState->pInternalState);
-            if(pInternalState->windowHandle)
-            {
-                DestroyWindow(pInternalState->windowHandle);
-            }
+            #if BLITZEN_PLATFORM_INPUT_THREAD
+                if(pInternalState->inputThread)
+                {
+                    // Only the thread that created the window can destroy it, the thread exits once the window is gone
+                    if(pInternalState->windowHandle)
+                    {
+                        PostMessageA(pInternalState->windowHandle, BLITZEN_WIN32_DESTROY_WINDOW_MESSAGE, 0, 0);
+                    }
+                    WaitForSingleObject(pInternalState->inputThread, INFINITE);
+                    CloseHandle(pInternalState->inputThread);
+                }
+                if(pInternalState->eventsAvailable)
+                {
+                    CloseHandle(pInternalState->eventsAvailable);
+                }
+            #else
+                if(pInternalState->windowHandle)
+                {
+                    DestroyWindow(pInternalState->windowHandle);
+                }
+            #endif
+
+            pPlatformInternalState = nullptr;
+            delete pInternalState;
+            pState->pInternalState = nullptr;
+        }
+
+        static double Win32QueryClockFrequency()
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            return 1.0 / static_cast<double>(frequency.QuadPart);// The quad part is just a 64 bit integer
         }
 
         double GetAbsoluteTime()
         {
+            // Queried on first use, since the logger reads the clock before the platform is started
+            static const double clockFrequency = Win32QueryClockFrequency();
             LARGE_INTEGER nowTime;
             QueryPerformanceCounter(&nowTime);
             return static_cast<double>(nowTime.QuadPart) * clockFrequency;
@@ -130,6 +330,30 @@ namespace BlitzenPlatform
             Sleep(ms);
         }
 
+        // Not defined by older SDKs, high resolution timers need Windows 10 1803 or newer
+        #ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+            #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION   0x00000002
+        #endif
+
+        void PSleepPrecise(double seconds)
+        {
+            // Each thread gets its own timer, the first use finds out if high resolution timers are supported
+            thread_local HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if(timer)
+            {
+                // Negative due times are relative, in 100 nanosecond units
+                LARGE_INTEGER dueTime;
+                dueTime.QuadPart = -static_cast<LONGLONG>(seconds * 10000000.0);
+                if(SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE))
+                {
+                    WaitForSingleObject(timer, INFINITE);
+                    return;
+                }
+            }
+            // Sleep rounds up to the scheduler tick, so it is only asked for whole milliseconds that fit
+            Sleep(static_cast<DWORD>(seconds * 1000.0));
+        }
+
         void ConsoleWrite(const char* message, uint8_t color)
         {
             HANDLE consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -181,14 +405,126 @@ namespace BlitzenPlatform
 
         uint8_t PlatformPumpMessages(PlatformState* pState)
         {
-            MSG message;
-            while(PeekMessageA(&message, nullptr, 0, 0, PM_REMOVE))
+            #if BLITZEN_PLATFORM_INPUT_THREAD
+                // Everything that arrived since the last frame, in the order it arrived
+                InternalState* pInternalState = reinterpret_cast<InternalState*>(pState->pInternalState);
+                PlatformEvent event;
+                while(pInternalState->eventQueue.Pop(event))
+                {
+                    DispatchPlatformEvent(event);
+                }
+            #else
+                MSG message;
+                while(PeekMessageA(&message, nullptr, 0, 0, PM_REMOVE))
+                {
+                    TranslateMessage(&message);
+                    DispatchMessage(&message);
+                }
+            #endif
+
+            return 1;
+        }
+
+        uint8_t PlatformWaitForEvents(PlatformState* pState, double timeout)
+        {
+            DWORD milliseconds = timeout < 0.0 ? INFINITE : static_cast<DWORD>(timeout * 1000.0);
+            #if BLITZEN_PLATFORM_INPUT_THREAD
+                InternalState* pInternalState = reinterpret_cast<InternalState*>(pState->pInternalState);
+                if(pInternalState->eventQueue.GetSize())
+                {
+                    return 1;
+                }
+                return WaitForSingleObject(pInternalState->eventsAvailable, milliseconds) == WAIT_OBJECT_0;
+            #else
+                return MsgWaitForMultipleObjects(0, nullptr, FALSE, milliseconds, QS_ALLINPUT) == WAIT_OBJECT_0;
+            #endif
+        }
+
+        uint8_t PlatformGetCpuTopology(CpuTopology& topology)
+        {
+            // Only processor group 0 is looked at, which holds every processor on machines with up to 64 of them
+            DWORD_PTR processMask = 0;
+            DWORD_PTR systemMask = 0;
+            GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+
+            RawCpuInfo raw[64];
+            uint32_t keys[3][64] = {};
+            uint8_t efficiency[64] = {};
+            uint8_t bFound = 0;
+
+            DWORD length = 0;
+            GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+            uint8_t* pBuffer = length ? reinterpret_cast<uint8_t*>(malloc(length)) : nullptr;
+            if(pBuffer && GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(pBuffer), &length))
             {
-                TranslateMessage(&message);
-                DispatchMessage(&message);
+                bFound = 1;
+                uint32_t entryIndex = 0;
+                for(DWORD offset = 0; offset < length; ++entryIndex)
+                {
+                    PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX pInfo = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(pBuffer + offset);
+                    offset += pInfo->Size;
+
+                    // Cores, last level caches and packages each fill their own key, with the entry's index
+                    uint32_t keyType = 3;
+                    KAFFINITY mask = 0;
+                    if(pInfo->Relationship == RelationProcessorCore)
+                    {
+                        keyType = 0;
+                        mask = pInfo->Processor.GroupMask[0].Group == 0 ? pInfo->Processor.GroupMask[0].Mask : 0;
+                    }
+                    else if(pInfo->Relationship == RelationCache && pInfo->Cache.Level == 3)
+                    {
+                        keyType = 1;
+                        mask = pInfo->Cache.GroupMask.Group == 0 ? pInfo->Cache.GroupMask.Mask : 0;
+                    }
+                    else if(pInfo->Relationship == RelationProcessorPackage)
+                    {
+                        keyType = 2;
+                        mask = pInfo->Processor.GroupMask[0].Group == 0 ? pInfo->Processor.GroupMask[0].Mask : 0;
+                    }
+
+                    for(uint32_t bit = 0; keyType < 3 && bit < 64; ++bit)
+                    {
+                        if(mask & (KAFFINITY(1) << bit))
+                        {
+                            keys[keyType][bit] = entryIndex + 1;
+                            if(keyType == 0)
+                            {
+                                efficiency[bit] = pInfo->Processor.EfficiencyClass;
+                            }
+                        }
+                    }
+                }
             }
+            free(pBuffer);
 
-            return 1;
+            uint32_t count = 0;
+            for(uint32_t bit = 0; bit < 64 && bit < BLITZEN_PLATFORM_MAX_CPUS; ++bit)
+            {
+                if(processMask & (DWORD_PTR(1) << bit))
+                {
+                    RawCpuInfo& cpu = raw[count++];
+                    cpu.osIndex = static_cast<uint16_t>(bit);
+                    cpu.coreKey = bFound ? keys[0][bit] : bit;
+                    // Without a last level cache entry, the package is the closest thing to it
+                    cpu.cacheKey = keys[1][bit] ? keys[1][bit] : keys[2][bit];
+                    cpu.packageKey = keys[2][bit];
+                    cpu.efficiencyClass = efficiency[bit];
+                }
+            }
+
+            BuildCpuTopology(topology, raw, count);
+            return bFound;
+        }
+
+        uint8_t PlatformSetThreadAffinity(const uint16_t* pOsIndices, uint32_t count)
+        {
+            DWORD_PTR mask = 0;
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                mask |= pOsIndices[i] < 64 ? (DWORD_PTR(1) << pOsIndices[i]) : 0;
+            }
+            return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
         }
 
         void CreateVulkanSurface(PlatformState* pState, VkInstance& instance, VkSurfaceKHR& surface, VkAllocationCallbacks* pAllocator)
@@ -213,27 +549,41 @@ namespace BlitzenPlatform
 
                 case WM_CLOSE:
                 {
-                    BlitzenCore::EventContext context{};
-                    BlitzenCore::FireEvent(BlitzenCore::BlitEventType::EngineShutdown, nullptr, context);
+                    PlatformEvent event{};
+                    event.type = PlatformEventType::WindowClose;
+                    SubmitPlatformEvent(event);
                     return 1;
                 }
 
+                case BLITZEN_WIN32_DESTROY_WINDOW_MESSAGE:
+                {
+                    DestroyWindow(winWindow);
+                    return 0;
+                }
+
                 case WM_DESTROY:
                 {
                     PostQuitMessage(0);
                     return 0;
                 }
+                case WM_ACTIVATEAPP:
+                {
+                    PlatformEvent event{};
+                    event.type = PlatformEventType::WindowFocus;
+                    event.state = w_param ? 1 : 0;
+                    SubmitPlatformEvent(event);
+                    break;
+                }
                 case WM_SIZE:
                 {
                     // Get the updated size.
                     RECT rect;
                     GetClientRect(winWindow, &rect);
-                    uint32_t width = rect.right - rect.left;
-                    uint32_t height = rect.bottom - rect.top;
-                    BlitzenCore::EventContext context;
-                    context.data.ui32[0] = width;
-                    context.data.ui32[1] = height;
-                    BlitzenCore::FireEvent(BlitzenCore::BlitEventType::WindowResize, nullptr, context);
+                    PlatformEvent event{};
+                    event.type = PlatformEventType::WindowResize;
+                    event.x = rect.right - rect.left;
+                    event.y = rect.bottom - rect.top;
+                    SubmitPlatformEvent(event);
                     break;
                 }
                 case WM_KEYDOWN:
@@ -242,17 +592,21 @@ namespace BlitzenPlatform
                 case WM_SYSKEYUP: 
                 {
                     // Key pressed/released
-                    uint8_t pressed = (msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN);
-                    BlitzenCore::BlitKey key = static_cast<BlitzenCore::BlitKey>(w_param);
-                    BlitzenCore::InputProcessKey(key, pressed);
+                    PlatformEvent event{};
+                    event.type = PlatformEventType::Key;
+                    event.state = (msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN);
+                    event.code = static_cast<uint16_t>(w_param);
+                    SubmitPlatformEvent(event);
                     break;
                 } 
                 case WM_MOUSEMOVE: 
                 {
                     // Mouse move
-                    int32_t mouseX = GET_X_LPARAM(l_param);
-                    int32_t mouseY = GET_Y_LPARAM(l_param);
-                    BlitzenCore::InputProcessMouseMove(mouseX, mouseY);
+                    PlatformEvent event{};
+                    event.type = PlatformEventType::MouseMove;
+                    event.x = GET_X_LPARAM(l_param);
+                    event.y = GET_Y_LPARAM(l_param);
+                    SubmitPlatformEvent(event);
                     break;
                 } 
                 case WM_MOUSEWHEEL: 
@@ -261,8 +615,10 @@ namespace BlitzenPlatform
                     if (zDelta != 0) 
                     {
                         // Flatten the input to an OS-independent (-1, 1)
-                        zDelta = (zDelta < 0) ? -1 : 1;
-                        BlitzenCore::InputProcessMouseWheel(zDelta);
+                        PlatformEvent event{};
+                        event.type = PlatformEventType::MouseWheel;
+                        event.state = (zDelta < 0) ? -1 : 1;
+                        SubmitPlatformEvent(event);
                     }
                    break;
                 }
@@ -297,7 +653,13 @@ namespace BlitzenPlatform
                         }
                     }
                     if(button != BlitzenCore::MouseButton::MaxButtons)
-                        BlitzenCore::InputProcessButton(button, bPressed);
+                    {
+                        PlatformEvent event{};
+                        event.type = PlatformEventType::MouseButton;
+                        event.state = bPressed;
+                        event.code = static_cast<uint16_t>(button);
+                        SubmitPlatformEvent(event);
+                    }
                     break;
                 } 
             }
@@ -305,7 +667,375 @@ namespace BlitzenPlatform
             return DefWindowProcA(winWindow, msg, w_param, l_param);
         }
 
-    #elif Linux
+    #elif defined(__linux__)
+
+        // Stands in for the window, the engine still asks for its size and a surface
+        struct InternalState
+        {
+            uint32_t width;
+            uint32_t height;
+        };
+
+        // Set by SIGINT and SIGTERM, so that a benchmark that is stopped early still shuts down and writes its results
+        static volatile sig_atomic_t bQuitRequested = 0;
+
+        static void LinuxQuitSignalHandler(int /*signal*/)
+        {
+            bQuitRequested = 1;
+        }
+
+        uint8_t PlatformStartup(PlatformState* pState, const char* appName, int32_t /*initialX*/, int32_t /*initialY*/, uint32_t width, uint32_t height)
+        {
+            pState->pInternalState = new InternalState();
+            InternalState* pInternalState = reinterpret_cast<InternalState*>(pState->pInternalState);
+            pInternalState->width = width;
+            pInternalState->height = height;
+
+            struct sigaction quitAction{};
+            quitAction.sa_handler = LinuxQuitSignalHandler;
+            sigemptyset(&quitAction.sa_mask);
+            sigaction(SIGINT, &quitAction, nullptr);
+            sigaction(SIGTERM, &quitAction, nullptr);
+
+            BLIT_INFO("%s running headless at %ux%u, no window will be created", appName, width, height)
+            return 1;
+        }
+
+        void PlatformShutdown(PlatformState* pState)
+        {
+            InternalState* pInternalState = reinterpret_cast<InternalState*>(pState->pInternalState);
+            delete pInternalState;
+            pState->pInternalState = nullptr;
+        }
+
+        double GetAbsoluteTime()
+        {
+            // The raw clock is not slewed by NTP, so frame times measured across an adjustment stay honest
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+            return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 0.000000001;
+        }
+
+        void PSleep(uint64_t ms)
+        {
+            timespec remaining;
+            remaining.tv_sec = static_cast<time_t>(ms / 1000);
+            remaining.tv_nsec = static_cast<long>((ms % 1000) * 1000000);
+            // A signal cuts the sleep short, the rest of it is slept after the handler returns
+            while(nanosleep(&remaining, &remaining) == -1 && errno == EINTR);
+        }
+
+        void PSleepPrecise(double seconds)
+        {
+            uint64_t nanoseconds = static_cast<uint64_t>(seconds * 1000000000.0);
+            timespec remaining;
+            remaining.tv_sec = static_cast<time_t>(nanoseconds / 1000000000);
+            remaining.tv_nsec = static_cast<long>(nanoseconds % 1000000000);
+            while(nanosleep(&remaining, &remaining) == -1 && errno == EINTR);
+        }
+
+        // Indexed by log level, the same colors that the Windows console uses
+        static const char* linuxConsoleColors[6] = {"0;41", "1;31", "1;33", "1;32", "1;34", "1;30"};
+
+        void ConsoleWrite(const char* message, uint8_t color)
+        {
+            // Colors are left out when the output is redirected, so that log files on the benchmark machines stay readable
+            if(isatty(STDOUT_FILENO))
+            {
+                fprintf(stdout, "\033[%sm%s\033[0m", linuxConsoleColors[color], message);
+            }
+            else
+            {
+                fputs(message, stdout);
+            }
+        }
+
+        void ConsoleError(const char* message, uint8_t color)
+        {
+            if(isatty(STDERR_FILENO))
+            {
+                fprintf(stderr, "\033[%sm%s\033[0m", linuxConsoleColors[color], message);
+            }
+            else
+            {
+                fputs(message, stderr);
+            }
+        }
+
+
+        void* PlatformMalloc(size_t size, uint8_t /*aligned*/)
+        {
+            return malloc(size);
+        }
+
+        void PlatformFree(void* pBlock, uint8_t /*aligned*/)
+        {
+            free(pBlock);
+        }
+
+        void* PlatformMemZero(void* pBlock, size_t size)
+        {
+            return memset(pBlock, 0, size);
+        }
+
+        void* PlatformMemCopy(void* pDst, void* pSrc, size_t size)
+        {
+            return memcpy(pDst, pSrc, size);
+        }
+
+        void* PlatformMemSet(void* pDst, int32_t value, size_t size)
+        {
+            return memset(pDst, value, size);
+        }
+
+
+        uint8_t PlatformPumpMessages(PlatformState* /*pState*/)
+        {
+            // There is no window to receive input from, headless runs are driven by an input replay.
+            // A quit signal is passed on the same way that closing the window is
+            if(bQuitRequested)
+            {
+                bQuitRequested = 0;
+                PlatformEvent event{};
+                event.type = PlatformEventType::WindowClose;
+                DispatchPlatformEvent(event);
+            }
+
+            return 1;
+        }
+
+        uint8_t PlatformWaitForEvents(PlatformState* /*pState*/, double timeout)
+        {
+            // The only event without a window is a quit signal, which cuts the sleep short
+            if(bQuitRequested)
+            {
+                return 1;
+            }
+            if(timeout < 0.0)
+            {
+                // Sliced, so that a signal that lands right before the sleep is still seen soon
+                while(!bQuitRequested)
+                {
+                    PSleep(100);
+                }
+                return 1;
+            }
+
+            uint64_t nanoseconds = static_cast<uint64_t>(timeout * 1000000000.0);
+            timespec remaining;
+            remaining.tv_sec = static_cast<time_t>(nanoseconds / 1000000000);
+            remaining.tv_nsec = static_cast<long>(nanoseconds % 1000000000);
+            nanosleep(&remaining, nullptr);
+            return bQuitRequested != 0;
+        }
+
+        // Reads the first integer of a sysfs file
+        static uint8_t LinuxReadSysfsInt(const char* path, int64_t& value)
+        {
+            FILE* pFile = fopen(path, "r");
+            if(!pFile)
+            {
+                return 0;
+            }
+            long long read = 0;
+            uint8_t bRead = fscanf(pFile, "%lld", &read) == 1;
+            fclose(pFile);
+            value = read;
+            return bRead;
+        }
+
+        // Reads a sysfs cpu list (e.g. "0-3,8-11") and returns its lowest cpu, optionally marking every cpu of it
+        static int64_t LinuxReadSysfsCpuList(const char* path, uint8_t* pMarks = nullptr)
+        {
+            FILE* pFile = fopen(path, "r");
+            if(!pFile)
+            {
+                return -1;
+            }
+
+            int64_t lowest = -1;
+            long long first = 0;
+            while(fscanf(pFile, "%lld", &first) == 1)
+            {
+                long long last = first;
+                int separator = fgetc(pFile);
+                if(separator == '-')
+                {
+                    if(fscanf(pFile, "%lld", &last) != 1)
+                    {
+                        break;
+                    }
+                    separator = fgetc(pFile);
+                }
+                lowest = lowest < 0 || first < lowest ? first : lowest;
+                for(long long cpu = first; pMarks && cpu <= last && cpu < BLITZEN_PLATFORM_MAX_CPUS; ++cpu)
+                {
+                    pMarks[cpu] = 1;
+                }
+                if(separator != ',')
+                {
+                    break;
+                }
+            }
+            fclose(pFile);
+            return lowest;
+        }
+
+        uint8_t PlatformGetCpuTopology(CpuTopology& topology)
+        {
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if(sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0)
+            {
+                topology.cpuCount = 0;
+                return 0;
+            }
+
+            // Intel hybrid parts list their efficiency cores here, other machines mix core types through the cpu capacity
+            uint8_t atomCpus[BLITZEN_PLATFORM_MAX_CPUS] = {};
+            uint8_t bIntelHybrid = LinuxReadSysfsCpuList("/sys/devices/cpu_atom/cpus", atomCpus) >= 0;
+
+            RawCpuInfo raw[BLITZEN_PLATFORM_MAX_CPUS];
+            uint32_t count = 0;
+            uint8_t bComplete = 1;
+            char path[128];
+            for(uint32_t osIndex = 0; osIndex < BLITZEN_PLATFORM_MAX_CPUS && osIndex < CPU_SETSIZE; ++osIndex)
+            {
+                if(!CPU_ISSET(osIndex, &allowed))
+                {
+                    continue;
+                }
+
+                RawCpuInfo& cpu = raw[count++];
+                cpu.osIndex = static_cast<uint16_t>(osIndex);
+
+                int64_t package = 0;
+                int64_t core = osIndex;
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", osIndex);
+                bComplete &= LinuxReadSysfsInt(path, package);
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", osIndex);
+                bComplete &= LinuxReadSysfsInt(path, core);
+                cpu.packageKey = static_cast<uint32_t>(package);
+                // Core ids are only unique within a package
+                cpu.coreKey = (static_cast<uint32_t>(package) << 16) | static_cast<uint32_t>(core & 0xFFFF);
+
+                // The last level cache is the highest level that the cpu has, its group is named by the lowest cpu that shares it
+                int64_t cacheLevel = 0;
+                int64_t cacheOwner = -1;
+                for(uint32_t index = 0; index < 8; ++index)
+                {
+                    int64_t level = 0;
+                    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", osIndex, index);
+                    if(!LinuxReadSysfsInt(path, level))
+                    {
+                        break;
+                    }
+                    if(level > cacheLevel)
+                    {
+                        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", osIndex, index);
+                        cacheOwner = LinuxReadSysfsCpuList(path);
+                        cacheLevel = level;
+                    }
+                }
+                // Packages are kept apart from cpu numbers with the top bit
+                cpu.cacheKey = cacheOwner >= 0 ? static_cast<uint32_t>(cacheOwner) : (0x80000000u | cpu.packageKey);
+
+                int64_t capacity = 0;
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpu_capacity", osIndex);
+                if(bIntelHybrid)
+                {
+                    cpu.efficiencyClass = atomCpus[osIndex] ? 0 : 1;
+                }
+                else if(LinuxReadSysfsInt(path, capacity))
+                {
+                    // Capacities go up to 1024, the scale keeps classes apart without making every core its own class
+                    cpu.efficiencyClass = static_cast<uint8_t>(capacity / 128);
+                }
+                else
+                {
+                    cpu.efficiencyClass = 0;
+                }
+            }
+
+            BuildCpuTopology(topology, raw, count);
+            return bComplete;
+        }
+
+        uint8_t PlatformSetThreadAffinity(const uint16_t* pOsIndices, uint32_t count)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                CPU_SET(pOsIndices[i], &set);
+            }
+            // A pid of 0 is the calling thread, not the whole process
+            return count && sched_setaffinity(0, sizeof(cpu_set_t), &set) == 0;
+        }
+
+        void CreateVulkanSurface(PlatformState* /*pState*/, VkInstance& instance, VkSurfaceKHR& surface, VkAllocationCallbacks* pAllocator)
+        {
+            // Extension functions are not guaranteed to be exported by the loader, so it is looked up through the instance
+            PFN_vkCreateHeadlessSurfaceEXT pCreateHeadlessSurface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(
+            vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT"));
+            if(!pCreateHeadlessSurface)
+            {
+                BLIT_FATAL("vkCreateHeadlessSurfaceEXT is not available, the driver does not support VK_EXT_headless_surface")
+                return;
+            }
+
+            VkHeadlessSurfaceCreateInfoEXT info{};
+            info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+            pCreateHeadlessSurface(instance, &info, pAllocator, &surface);
+        }
 
     #endif
+
+    void DispatchPlatformEvent(const PlatformEvent& event)
+    {
+        switch(event.type)
+        {
+            case PlatformEventType::Key:
+            {
+                BlitzenCore::InputProcessKey(static_cast<BlitzenCore::BlitKey>(event.code), static_cast<uint8_t>(event.state));
+                break;
+            }
+            case PlatformEventType::MouseButton:
+            {
+                BlitzenCore::InputProcessButton(static_cast<BlitzenCore::MouseButton>(event.code), static_cast<uint8_t>(event.state));
+                break;
+            }
+            case PlatformEventType::MouseMove:
+            {
+                BlitzenCore::InputProcessMouseMove(static_cast<int16_t>(event.x), static_cast<int16_t>(event.y));
+                break;
+            }
+            case PlatformEventType::MouseWheel:
+            {
+                BlitzenCore::InputProcessMouseWheel(event.state);
+                break;
+            }
+            case PlatformEventType::WindowResize:
+            {
+                BlitzenCore::EventContext context;
+                context.data.ui32[0] = static_cast<uint32_t>(event.x);
+                context.data.ui32[1] = static_cast<uint32_t>(event.y);
+                BlitzenCore::FireEvent(BlitzenCore::BlitEventType::WindowResize, nullptr, context);
+                break;
+            }
+            case PlatformEventType::WindowClose:
+            {
+                BlitzenCore::EventContext context{};
+                BlitzenCore::FireEvent(BlitzenCore::BlitEventType::EngineShutdown, nullptr, context);
+                break;
+            }
+            case PlatformEventType::WindowFocus:
+            {
+                BlitzenCore::EventContext context{};
+                context.data.ui32[0] = static_cast<uint32_t>(event.state);
+                BlitzenCore::FireEvent(BlitzenCore::BlitEventType::WindowFocus, nullptr, context);
+                break;
+            }
+        }
+    }
 }
\ No newline at end of file
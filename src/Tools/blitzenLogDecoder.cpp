@@ -0,0 +1,201 @@
+#include "Core/blitLogFormat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Turns a binary log written with BLITZEN_LOG_BINARY back into the text that the logger would have written.
+// Usage: BlitzenLogDecoder <log.blog> [output.txt] [--sources], where --sources adds the file and line of every deferred message
+
+static const char* logLevels[] = {"{FATAL}: ", "{ERROR}: ", "{Warning}: ", "{Info}: ", "{Debug}: ", "{Trace}: "};
+
+struct DecodedFormat
+{
+    char* format = nullptr;
+    const char* file = nullptr;
+    uint32_t line = 0;
+};
+
+static const char* GetLevelName(uint8_t level)
+{
+    return level < sizeof(logLevels) / sizeof(logLevels[0]) ? logLevels[level] : "{Unknown}: ";
+}
+
+int main(int argc, char** argv)
+{
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    uint8_t bSources = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!strcmp(argv[i], "--sources"))
+        {
+            bSources = 1;
+        }
+        else if(!inputPath)
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            outputPath = argv[i];
+        }
+    }
+
+    if(!inputPath)
+    {
+        fprintf(stderr, "Usage: %s <log.blog> [output.txt] [--sources]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* pInput = fopen(inputPath, "rb");
+    if(!pInput)
+    {
+        fprintf(stderr, "Failed to open %s\n", inputPath);
+        return 1;
+    }
+
+    FILE* pOutput = stdout;
+    if(outputPath)
+    {
+        pOutput = fopen(outputPath, "w");
+        if(!pOutput)
+        {
+            fprintf(stderr, "Failed to open %s\n", outputPath);
+            fclose(pInput);
+            return 1;
+        }
+    }
+
+    BlitzenCore::BinaryLogFileHeader fileHeader;
+    if(fread(&fileHeader, sizeof(fileHeader), 1, pInput) != 1 || fileHeader.magic != BLITZEN_BINARY_LOG_MAGIC)
+    {
+        fprintf(stderr, "%s is not a binary log\n", inputPath);
+        fclose(pInput);
+        return 1;
+    }
+    if(fileHeader.version != BLITZEN_BINARY_LOG_VERSION)
+    {
+        fprintf(stderr, "%s was written with version %u of the format, this decoder reads version %u\n", inputPath, fileHeader.version,
+        BLITZEN_BINARY_LOG_VERSION);
+        fclose(pInput);
+        return 1;
+    }
+
+    // Formats are indexed by id, which the logger hands out in order starting from 1
+    DecodedFormat* pFormats = nullptr;
+    uint32_t formatCapacity = 0;
+
+    // The record size is a uint16_t, so this holds any payload
+    static uint8_t payload[UINT16_MAX + 1];
+    static char text[UINT16_MAX + 1];
+    uint32_t recordCount = 0;
+    uint8_t bTruncated = 0;
+    uint8_t bCorrupted = 0;
+
+    BlitzenCore::BinaryLogRecordHeader header;
+    while(fread(&header, sizeof(header), 1, pInput) == 1)
+    {
+        if(header.size && fread(payload, 1, header.size, pInput) != header.size)
+        {
+            bTruncated = 1;
+            break;
+        }
+        ++recordCount;
+
+        switch(header.type)
+        {
+            case BlitzenCore::BinaryLogRecordType::Format:
+            {
+                if(header.size < sizeof(uint32_t))
+                {
+                    fprintf(stderr, "Format record %u is too small, stopping\n", header.id);
+                    bCorrupted = 1;
+                    break;
+                }
+
+                if(header.id >= formatCapacity)
+                {
+                    uint32_t newCapacity = header.id * 2 + 16;
+                    DecodedFormat* pNewFormats = reinterpret_cast<DecodedFormat*>(realloc(pFormats, newCapacity * sizeof(DecodedFormat)));
+                    if(!pNewFormats)
+                    {
+                        fprintf(stderr, "Out of memory\n");
+                        bCorrupted = 1;
+                        break;
+                    }
+                    for(uint32_t i = formatCapacity; i < newCapacity; ++i)
+                    {
+                        pNewFormats[i] = DecodedFormat();
+                    }
+                    pFormats = pNewFormats;
+                    formatCapacity = newCapacity;
+                }
+
+                // The payload is the line followed by two null terminated strings, which are kept together in one allocation
+                DecodedFormat& format = pFormats[header.id];
+                free(format.format);
+                memcpy(&format.line, payload, sizeof(uint32_t));
+                uint32_t stringsSize = header.size - sizeof(uint32_t);
+                format.format = reinterpret_cast<char*>(malloc(stringsSize + 1));
+                memcpy(format.format, payload + sizeof(uint32_t), stringsSize);
+                format.format[stringsSize] = 0;
+                size_t formatLength = strlen(format.format);
+                format.file = formatLength < stringsSize ? format.format + formatLength + 1 : "";
+                break;
+            }
+            case BlitzenCore::BinaryLogRecordType::Message:
+            {
+                if(header.id >= formatCapacity || !pFormats[header.id].format)
+                {
+                    fprintf(pOutput, "%s<message with unknown format %u>\n", GetLevelName(header.level), header.id);
+                    break;
+                }
+                const DecodedFormat& format = pFormats[header.id];
+                BlitzenCore::RenderLogMessage(format.format, payload, header.size, text, sizeof(text));
+                if(bSources)
+                {
+                    fprintf(pOutput, "%s%s (%s:%u)\n", GetLevelName(header.level), text, format.file, format.line);
+                }
+                else
+                {
+                    fprintf(pOutput, "%s%s\n", GetLevelName(header.level), text);
+                }
+                break;
+            }
+            case BlitzenCore::BinaryLogRecordType::Text:
+            {
+                fprintf(pOutput, "%s%.*s\n", GetLevelName(header.level), static_cast<int32_t>(header.size), reinterpret_cast<char*>(payload));
+                break;
+            }
+            default:
+            {
+                fprintf(stderr, "Unknown record type %u, stopping\n", static_cast<uint32_t>(header.type));
+                bCorrupted = 1;
+                break;
+            }
+        }
+
+        if(bCorrupted)
+        {
+            break;
+        }
+    }
+
+    if(bTruncated)
+    {
+        fprintf(stderr, "%s ends in the middle of a record, it was probably not closed properly\n", inputPath);
+    }
+    fprintf(stderr, "Decoded %u records\n", recordCount);
+
+    for(uint32_t i = 0; i < formatCapacity; ++i)
+    {
+        free(pFormats[i].format);
+    }
+    free(pFormats);
+    fclose(pInput);
+    if(pOutput != stdout)
+    {
+        fclose(pOutput);
+    }
+    return bCorrupted;
+}
@@ -1,41 +1,118 @@
-#include "MainEngine.h"
+#include "mainEngine.h"
+
+static_assert(BLITZEN_BENCHMARK_SKIPPED_FRAMES >= BLITZEN_RENDER_CONTEXT_RING + BLITZEN_VULKAN_GPU_PROFILER_LATENCY,
+"Benchmark scenarios would count samples of frames that were in flight before they started measuring");
 
 namespace BlitzenEngine
 {
     Engine* Engine::m_pEngine;
 
-    Engine::Engine()
+    Engine::Engine(const char* inputRecordingFile /* = BLITZEN_INPUT_RECORDING_FILE */, 
+    const char* sceneManifestFile /* = BLITZEN_SCENE_MANIFEST_FILE */)
     {
         m_pEngine = this;
+
+        // Logging is started first, so that everything the other systems log during initialization goes through the background writer
+        m_systems.loggingSystem = BlitzenCore::LoggingInit();
         BLIT_INFO("%s booting", BLITZEN_VERSION)
 
+        m_systems.profiler = BlitzenCore::ProfilerInit();
+        BlitzenCore::ProfilerSetThreadName("Main");
+
+        // Threads are placed before they start, the workers pin themselves as they come up
+        BlitzenCore::ThreadAffinityInit(BLITZEN_RENDER_THREAD);
+        BlitzenCore::ThreadAffinityPinCurrentThread(BlitzenCore::ThreadRole::Main);
+
+        // The main thread becomes job thread 0, so it can help with the work that it waits for
+        m_systems.jobSystem = BlitzenCore::JobSystemInit(BlitzenCore::ThreadAffinityGetWorkerCount(), BLITZEN_RENDER_THREAD);
+        // Started before the renderer, which reads its scenes and textures through it
+        m_systems.asyncIo = BlitzenPlatform::AsyncIoInit();
+        BlitzenCore::MetricsRegister("CpuFrameUs", BlitzenCore::MetricType::Gauge, m_cpuFrameMetric);
+        BlitzenCore::MetricsRegister("SimulationSteps", BlitzenCore::MetricType::Counter, m_simulationStepMetric);
+        #if BLITZEN_TARGET_FPS
+            BlitzenCore::FramePacerInit(1.0 / BLITZEN_TARGET_FPS);
+        #else
+            BlitzenCore::FramePacerInit(0.0);
+        #endif
+
         m_systems.eventSystem = BlitzenCore::EventsInit();
         BLIT_ASSERT_MESSAGE(m_systems.eventSystem, "Event system initalization failed! The Engine cannot start without the event system")
 
         BlitzenCore::InputInit();
         m_systems.inputSystem = 1;
 
-        BLIT_ASSERT(BlitzenPlatform::PlatformStartup(&platformState, BLITZEN_VERSION, BLITZEN_WINDOW_STARTING_X, BLITZEN_WINDOW_STARTING_Y,
-        platformData.windowWidth, platformData.windowHeight))
+        #if BLITZEN_INPUT_RECORDING_MODE
+            m_systems.inputRecording = BlitzenCore::InputRecordingInit(static_cast<BlitzenCore::InputRecordingMode>(BLITZEN_INPUT_RECORDING_MODE), 
+            inputRecordingFile, BLITZEN_INPUT_REPLAY_DELTA_TIME);
+        #endif
+        if(!BlitzenCore::LoadSceneManifest(sceneManifestFile, m_sceneManifest))
+        {
+            BLIT_WARN("No scene manifest at %s, the default scenes are loaded", sceneManifestFile)
+            BlitzenCore::GetDefaultSceneManifest(m_sceneManifest);
+        }
+
+        #if BLITZEN_PLATFORM_HEADLESS
+            // Without a replay or a benchmark nothing would drive the run or end it
+            BLIT_ASSERT_MESSAGE(m_systems.inputRecording || !m_sceneManifest.scenarios.empty(), 
+            "Headless runs need an input recording to replay or benchmark scenarios")
+        #endif
+
+        // Startup work runs as soon as what it needs is done, so the scenes are read, parsed and decoded while the device is created
+        {
+            BlitzenCore::StartupGraph startup;
+            // The window stays on the main thread, which is the one that pumps its messages
+            uint32_t window = BlitzenCore::StartupAddTask(startup, "Window", [](void* pData) -> uint8_t
+            {
+                Engine* pEngine = reinterpret_cast<Engine*>(pData);
+                return BlitzenPlatform::PlatformStartup(&pEngine->platformState, BLITZEN_VERSION, BLITZEN_WINDOW_STARTING_X, 
+                BLITZEN_WINDOW_STARTING_Y, pEngine->platformData.windowWidth, pEngine->platformData.windowHeight);
+            }, this, {}, 1);
+            uint32_t instance = BlitzenCore::StartupAddTask(startup, "VulkanInstance", [](void* pData) -> uint8_t
+            {
+                return reinterpret_cast<Engine*>(pData)->m_vulkan.InitInstance();
+            }, this);
+            uint32_t device = BlitzenCore::StartupAddTask(startup, "VulkanDevice", [](void* pData) -> uint8_t
+            {
+                Engine* pEngine = reinterpret_cast<Engine*>(pData);
+                return pEngine->m_vulkan.InitDevice(&pEngine->platformState);
+            }, this, {window, instance});
+            uint32_t swapchain = BlitzenCore::StartupAddTask(startup, "Swapchain", [](void* pData) -> uint8_t
+            {
+                Engine* pEngine = reinterpret_cast<Engine*>(pData);
+                return pEngine->m_vulkan.InitSwapchain(&pEngine->platformData.windowWidth, &pEngine->platformData.windowHeight);
+            }, this, {device});
+            uint32_t scenes = BlitzenCore::StartupAddTask(startup, "ParseScenes", [](void* pData) -> uint8_t
+            {
+                Engine* pEngine = reinterpret_cast<Engine*>(pData);
+                return pEngine->m_vulkan.ParseScenes(pEngine->m_sceneManifest);
+            }, this);
+            uint32_t shaders = BlitzenCore::StartupAddTask(startup, "ReadShaders", [](void* pData) -> uint8_t
+            {
+                return reinterpret_cast<Engine*>(pData)->m_vulkan.ReadShaders();
+            }, this);
+            BlitzenCore::StartupAddTask(startup, "UploadDataToGPU", [](void* pData) -> uint8_t
+            {
+                Engine* pEngine = reinterpret_cast<Engine*>(pData);
+                pEngine->m_vulkan.UploadDataToGPU(pEngine->m_sceneManifest);
+                return 1;
+            }, this, {swapchain, scenes, shaders});
+
+            uint8_t bStarted = BlitzenCore::StartupRun(startup);
+            BLIT_ASSERT_MESSAGE(bStarted, "Engine startup failed, the startup report shows which task failed")
+        }
 
         BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::EngineShutdown, nullptr, OnEvent);
         BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::KeyPressed, nullptr, OnKeyPress);
         BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::KeyReleased, nullptr, OnKeyPress);
         BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::WindowResize, nullptr, OnEvent);
+        BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::WindowFocus, nullptr, OnEvent);
         BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::MouseMoved, this, OnMouseMove);
 
-        //Then initialize vulkan giving it the glfw window width and height
-        m_vulkan.Init(&platformState, &(platformData.windowWidth), &(platformData.windowHeight));
-
         isRunning = 1;
     }
 
     void Engine::MainEngineLoop()
     {
-        // Loads scenes and actually get ready to draw. Some of the stuff that this does should not normally be up to the renderer
-        // TODO: Change this, so that the scene data is loaded by another system and this just passes data to the GPU
-        m_vulkan.UploadDataToGPU();
-
         StartClock();
         double previousTime = m_clock.elapsed;
         m_clock.elapsed = BlitzenPlatform::GetAbsoluteTime() - m_clock.startTime;
@@ -48,37 +125,295 @@ namespace BlitzenEngine
         static_cast<float>(platformData.windowHeight), m_mainCamera.GetZNear(), m_mainCamera.GetZFar());
         m_mainCamera.m_projectionTranspose = glm::transpose(m_mainCamera.m_projectionMatrix);
 
+        // Everything that is loaded is in memory by now
+        ReportMemory(m_frameIndex, m_clock.elapsed);
+        m_lastMemoryReportTime = m_clock.elapsed;
+
+        // Starts with the loop, so that loading is not part of the first scenario
+        if(BlitzenCore::BenchmarkInit(m_sceneManifest))
+        {
+            BLIT_INFO("Running %u benchmark scenarios, the camera follows their paths", static_cast<uint32_t>(m_sceneManifest.scenarios.size()))
+        }
+
         // This is declared here so that it is possible to freeze the view frustum
         BlitzenVulkan::RenderContext renderContext;
 
+        // The renderer's transforms can still be read here, the render thread takes it over next
+        InitSpins();
+        StartRenderThread();
+
         //Loops until an event occurs that causes the engine to terminate
         while(isRunning)
         {
-            BlitzenPlatform::PlatformPumpMessages(&platformState);
+            if(isSuspended)
+            {
+                // Nothing is drawn, so there is no frame to pace. The thread sleeps until the OS has something for it
+                BlitzenPlatform::PlatformWaitForEvents(&platformState, BLITZEN_SUSPENDED_TICK_RATE ? 1.0 / BLITZEN_SUSPENDED_TICK_RATE : -1.0);
+                // The time spent suspended is not simulated once the engine resumes
+                m_clock.elapsed = BlitzenPlatform::GetAbsoluteTime() - m_clock.startTime;
+                BlitzenPlatform::PlatformPumpMessages(&platformState);
+
+                // Idle ticks are not frames, so the flight recorder, the metrics and the frame index skip them
+                if(!isSuspended)
+                {
+                    BlitzenCore::FramePacerReset();
+                }
+                continue;
+            }
+
+            // Waits before the frame starts, so that the input it samples is as recent as possible
+            BlitzenCore::FramePacerWait();
+
+            BLIT_PROFILE_SCOPE("Frame")
+            double frameStartTime = BlitzenPlatform::GetAbsoluteTime();
+            BlitzenCore::FlightRecorderBeginFrame(m_frameIndex);
+
+            // Recorded input is fed before the platform's messages, at the same frame boundary that it was recorded on
+            {
+                BLIT_FRAME_PHASE(Pump)
+                BlitzenCore::InputRecordingBeginFrame(m_frameIndex);
+                BlitzenPlatform::PlatformPumpMessages(&platformState);
+            }
 
             if (!isSuspended)
             {
                 previousTime = m_clock.elapsed;
                 m_clock.elapsed = BlitzenPlatform::GetAbsoluteTime() - m_clock.startTime;
                 m_deltaTime = m_clock.elapsed - previousTime;
+                // Replays always move at the fixed rate that the recording saved, so that every replay of it renders the same frames.
+                // Those are not the frames that were recorded, which ran at the live frame time
+                if(BlitzenCore::GetInputRecordingMode() == BlitzenCore::InputRecordingMode::Replay)
+                {
+                    m_deltaTime = BlitzenCore::GetInputReplayDeltaTime();
+                }
 
                 //Camera is update after events have bee polled
-                m_mainCamera.MoveCamera(static_cast<float>(m_deltaTime));
+                {
+                    BLIT_FRAME_PHASE(Camera)
+                    RunSimulation(m_deltaTime);
+                }
 
                 //Draw frame after camera has been updated
-                renderContext.pCamera = &(m_mainCamera);
                 renderContext.bResize = platformData.resize;
+                renderContext.windowWidth = platformData.windowWidth;
+                renderContext.windowHeight = platformData.windowHeight;
                 renderContext.bDrawIndirect = m_bVulkanDrawIndirect;
                 if (!m_bFreezeFrustum)
                     renderContext.viewMatrix = m_mainCamera.GetViewMatrix();
-                m_vulkan.DrawFrame(renderContext);
+                renderContext.projectionView = m_mainCamera.GetProjectionView();
+                renderContext.projectionTranspose = m_mainCamera.m_projectionTranspose;
+                renderContext.frameIndex = m_frameIndex;
+                renderContext.time = m_clock.elapsed;
+                renderContext.bReportMemory = m_clock.elapsed - m_lastMemoryReportTime >= BLITZEN_MEMORY_REPORT_INTERVAL_SECONDS;
+                if(renderContext.bReportMemory)
+                {
+                    m_lastMemoryReportTime = m_clock.elapsed;
+                }
+                renderContext.nodeUpdateCount = 0;
+                for(const BlitzenVulkan::NodeTransformUpdate& update : m_pendingNodeUpdates)
+                {
+                    if(renderContext.nodeUpdateCount == BLITZEN_RENDER_CONTEXT_MAX_NODE_UPDATES)
+                    {
+                        break;
+                    }
+                    renderContext.nodeUpdates[renderContext.nodeUpdateCount++] = update;
+                }
+                m_pendingNodeUpdates.erase(m_pendingNodeUpdates.begin(), m_pendingNodeUpdates.begin() + renderContext.nodeUpdateCount);
+                SubmitRenderContext(renderContext);
                 platformData.resize = 0;
+
+                // Suspended frames do not draw anything, so they would only drag the numbers down
+                double cpuFrameTime = BlitzenPlatform::GetAbsoluteTime() - frameStartTime;
+                BlitzenCore::FrameStatsRecord(BlitzenCore::FrameStatType::CpuFrame, cpuFrameTime * 1000.0);
+                BlitzenCore::MetricSet(m_cpuFrameMetric, static_cast<int64_t>(cpuFrameTime * 1000000.0));
+            }
+
+            BlitzenCore::FlightRecorderEndFrame();
+            BlitzenCore::MetricsSampleFrame(m_frameIndex);
+            ++m_frameIndex;
+            if(BlitzenCore::InputReplayFinished())
+            {
+                BLIT_INFO("Input replay finished after %u frames", m_frameIndex)
+                RequestShutdown();
             }
         }
 
+        StopRenderThread();
         StopClock();
     }
 
+    void Engine::SetNodeTransform(uint32_t scene, uint32_t node, const glm::mat4& localTransform)
+    {
+        // Only the last transform would be seen, and a node set every frame would otherwise fill the queue faster than it drains
+        for(BlitzenVulkan::NodeTransformUpdate& update : m_pendingNodeUpdates)
+        {
+            if(update.scene == scene && update.node == node)
+            {
+                update.localTransform = localTransform;
+                return;
+            }
+        }
+        m_pendingNodeUpdates.push_back({scene, node, localTransform});
+    }
+
+    void Engine::InitSpins()
+    {
+        for(const BlitzenCore::ManifestSpin& spin : m_sceneManifest.spins)
+        {
+            glm::mat4 baseTransform;
+            if(!m_vulkan.GetNodeLocalTransform(spin.scene, spin.node, baseTransform))
+            {
+                BLIT_WARN("Scene %s has no node %u to spin", m_sceneManifest.scenes[spin.scene].name.c_str(), spin.node)
+                continue;
+            }
+            m_spins.push_back(spin);
+            m_spinBaseTransforms.push_back(baseTransform);
+        }
+    }
+
+    void Engine::UpdateSpins()
+    {
+        for(size_t i = 0; i < m_spins.size(); ++i)
+        {
+            const BlitzenCore::ManifestSpin& spin = m_spins[i];
+            float angle = static_cast<float>(fmod(spin.speed * m_simulationTime, 2.0 * glm::pi<double>()));
+            SetNodeTransform(spin.scene, spin.node, m_spinBaseTransforms[i] * glm::rotate(glm::mat4(1.f), angle, spin.axis));
+        }
+    }
+
+    void Engine::SubmitRenderContext(const BlitzenVulkan::RenderContext& context)
+    {
+        #if BLITZEN_RENDER_THREAD
+            RenderThreadState& state = m_renderThread;
+            {
+                BLIT_FRAME_PHASE(RenderWait)
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.consumedCondition.wait(lock, [&state]() { return state.produced - state.consumed < BLITZEN_RENDER_CONTEXT_RING; });
+                state.contexts[state.produced % BLITZEN_RENDER_CONTEXT_RING] = context;
+                ++state.produced;
+            }
+            state.producedCondition.notify_one();
+        #else
+            DrawRenderContext(context);
+        #endif
+    }
+
+    void Engine::DrawRenderContext(const BlitzenVulkan::RenderContext& context)
+    {
+        m_vulkan.DrawFrame(context);
+        if(context.bReportMemory)
+        {
+            ReportMemory(context.frameIndex, context.time);
+        }
+    }
+
+    void Engine::StartRenderThread()
+    {
+        #if BLITZEN_RENDER_THREAD
+            m_renderThread.bStop = 0;
+            m_renderThread.thread = std::thread(&Engine::RenderThreadMain, this);
+        #endif
+    }
+
+    void Engine::StopRenderThread()
+    {
+        RenderThreadState& state = m_renderThread;
+        if(!state.thread.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.bStop = 1;
+        }
+        state.producedCondition.notify_one();
+        state.thread.join();
+    }
+
+    void Engine::RenderThreadMain()
+    {
+        BlitzenCore::ProfilerSetThreadName("Render");
+        BlitzenCore::ThreadAffinityPinCurrentThread(BlitzenCore::ThreadRole::Render);
+        // Culling and the other parallel work of the frame are spread to the workers from here
+        BlitzenCore::JobSystemRegisterThread(0);
+
+        RenderThreadState& state = m_renderThread;
+        for(;;)
+        {
+            const BlitzenVulkan::RenderContext* pContext;
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.producedCondition.wait(lock, [&state]() { return state.produced != state.consumed || state.bStop; });
+                if(state.produced == state.consumed)
+                {
+                    return;
+                }
+                // The main thread does not write this context again until consumed moves past it
+                pContext = &state.contexts[state.consumed % BLITZEN_RENDER_CONTEXT_RING];
+            }
+
+            DrawRenderContext(*pContext);
+
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                ++state.consumed;
+            }
+            state.consumedCondition.notify_one();
+        }
+    }
+
+    void Engine::RunSimulation(double deltaTime)
+    {
+        const double step = 1.0 / BLITZEN_SIMULATION_RATE;
+        // Keeps rounding from turning a whole number of steps into one less, replays with a fixed delta time would hit it every frame
+        const double tolerance = step * 0.000001;
+        m_simulationAccumulator += deltaTime;
+
+        uint32_t steps = 0;
+        while(m_simulationAccumulator >= step - tolerance)
+        {
+            if(steps == BLITZEN_SIMULATION_MAX_STEPS)
+            {
+                BLIT_WARN("Simulation fell %.2fms behind, the time past %u steps is dropped", m_simulationAccumulator * 1000.0, 
+                BLITZEN_SIMULATION_MAX_STEPS)
+                m_simulationAccumulator = fmod(m_simulationAccumulator, step);
+                break;
+            }
+
+            BlitzenCore::CameraPathPoint cameraPoint;
+            uint8_t bScriptedCamera = 0;
+            if(BlitzenCore::BenchmarkIsRunning() && !BlitzenCore::BenchmarkStep(step, cameraPoint, bScriptedCamera))
+            {
+                // The last scenario is done
+                RequestShutdown();
+            }
+
+            if(bScriptedCamera)
+            {
+                m_mainCamera.SetPose(cameraPoint.position, cameraPoint.yaw, cameraPoint.pitch);
+            }
+            else
+            {
+                m_mainCamera.MoveCamera(static_cast<float>(step));
+            }
+            m_simulationAccumulator -= step;
+            m_simulationTime += step;
+            ++steps;
+        }
+        if(m_simulationAccumulator < 0.0)
+        {
+            m_simulationAccumulator = 0.0;
+        }
+        BlitzenCore::MetricAdd(m_simulationStepMetric, steps);
+        if(steps)
+        {
+            UpdateSpins();
+        }
+
+        m_mainCamera.InterpolateView(static_cast<float>(m_simulationAccumulator / step));
+    }
+
     void Engine::StartClock()
     {
         m_clock.startTime = BlitzenPlatform::GetAbsoluteTime();
@@ -90,21 +425,60 @@ namespace BlitzenEngine
         m_clock.elapsed = 0;
     }
 
+    void Engine::ReportMemory(uint32_t frameIndex, double time)
+    {
+        BLIT_PROFILE_SCOPE("ReportMemory")
+        BlitzenCore::MemoryReport report;
+        BlitzenCore::GetMemoryReport(report);
+        // VMA's statistics walk the allocator's blocks, which the thread that draws is allocating from
+        m_vulkan.FillMemoryReport(report);
+        BlitzenCore::WriteMemoryReport(report, frameIndex, time);
+    }
+
     Engine::~Engine()
     {
         BLIT_WARN("%s shutting down", BLITZEN_VERSION)
 
+        // Jobs may still be using anything below, so they finish first. The render thread runs jobs as well, it is normally stopped
+        // by the main loop already
+        StopRenderThread();
+        m_systems.jobSystem = 0;
+        BlitzenCore::JobSystemShutdown();
+
         m_systems.eventSystem = 0;
         BlitzenCore::EventsShutdown();
 
+        if(m_systems.inputRecording)
+        {
+            m_systems.inputRecording = 0;
+            BlitzenCore::InputRecordingShutdown();
+        }
+
         m_systems.inputSystem = 0;
         BlitzenCore::InputShutdown();
 
         m_vulkan.CleanupResources();
         BlitzenPlatform::PlatformShutdown(&platformState);
 
+        m_systems.asyncIo = 0;
+        BlitzenPlatform::AsyncIoShutdown();
+
         m_pEngine = nullptr;
         isRunning = 0;
+
+        BlitzenCore::BenchmarkShutdown();
+        BlitzenCore::FrameStatsLogSummary();
+        BlitzenCore::FrameStatsWriteSummary();
+        BlitzenCore::FramePacerLogSummary();
+        BlitzenCore::MetricsShutdown();
+
+        // The trace is exported once every thread that records zones has stopped
+        m_systems.profiler = 0;
+        BlitzenCore::ProfilerShutdown();
+
+        // Shutdown last so that nothing logged by the other systems is lost
+        m_systems.loggingSystem = 0;
+        BlitzenCore::LoggingShutdown();
     }
 
 
@@ -127,6 +501,11 @@ namespace BlitzenEngine
 
             return 1;
         }
+        if(eventType == BlitzenCore::BlitEventType::WindowFocus)
+        {
+            Engine::GetEngineInstancePointer()->UpdateWindowFocus(static_cast<uint8_t>(data.data.ui32[0]));
+            return 1;
+        }
 
         return 0;
     }
@@ -137,12 +516,13 @@ namespace BlitzenEngine
         platformData.windowHeight = height;
         platformData.resize = 1;
 
-        if (width == 0 || height == 0)
+        // A minimized window has no size
+        m_bMinimized = width == 0 || height == 0;
+        UpdateSuspended();
+        if(m_bMinimized)
         {
-            uint8_t isSuspended = 1;
             return;
         }
-        uint8_t isSuspended = 0;
 
         m_mainCamera.m_projectionMatrix = 
         glm::perspective(glm::radians(70.f), static_cast<float>(platformData.windowWidth) / 
@@ -150,6 +530,35 @@ namespace BlitzenEngine
         m_mainCamera.m_projectionTranspose = glm::transpose(m_mainCamera.m_projectionMatrix);
     }
 
+    void Engine::UpdateWindowFocus(uint8_t bFocused)
+    {
+        m_bUnfocused = !bFocused;
+        UpdateSuspended();
+    }
+
+    void Engine::UpdateSuspended()
+    {
+        uint8_t bSuspend = m_bMinimized;
+        #if BLITZEN_SUSPEND_WHEN_UNFOCUSED
+            uint8_t bScripted = BlitzenCore::GetInputRecordingMode() == BlitzenCore::InputRecordingMode::Replay || BlitzenCore::BenchmarkIsRunning();
+            bSuspend = bSuspend || (m_bUnfocused && !bScripted);
+        #endif
+
+        if(bSuspend == isSuspended)
+        {
+            return;
+        }
+        isSuspended = bSuspend;
+        if(isSuspended)
+        {
+            BLIT_INFO("Suspended (%s), nothing is drawn until the window is back", m_bMinimized ? "minimized" : "unfocused")
+        }
+        else
+        {
+            BLIT_INFO("Resumed after frame %u", m_frameIndex)
+        }
+    }
+
     uint8_t OnKeyPress(BlitzenCore::BlitEventType eventType, void* pSender, void* pListener, BlitzenCore::EventContext data)
     {
         //Get the key pressed from the event context
@@ -190,6 +599,17 @@ namespace BlitzenEngine
                     Engine::GetEngineInstancePointer()->FreezeFrustum();
                     break;
                 }
+                case BlitzenCore::BlitKey::__F2:
+                {
+                    BlitzenCore::FrameStatsLogSummary();
+                    BlitzenCore::FramePacerLogSummary();
+                    break;
+                }
+                case BlitzenCore::BlitKey::__F3:
+                {
+                    BlitzenCore::FlightRecorderDump(BLITZEN_FLIGHT_RECORDER_DUMP_FILE);
+                    break;
+                }
                 case BlitzenCore::BlitKey::__F4:
                 {
                     Engine::GetEngineInstancePointer()->ChangeVulkanDrawMode();
@@ -230,20 +650,22 @@ namespace BlitzenEngine
 
         float pitchMovement = static_cast<float>(data.data.si16[1]);
         float yawMovement = static_cast<float>(data.data.si16[0]);
-        blitCamera.RotateCamera(yawMovement, pitchMovement, static_cast<float>(pBlitzen->GetDeltaTime()));
+        blitCamera.RotateCamera(yawMovement, pitchMovement);
         return 1;
     }
 
 }
 
-void main()
+// Usage: BlitzenEngine [input recording] [scene manifest]
+int main(int argc, char** argv)
 {
     BlitzenCore::MemoryManagementInit();
 
     {
-        BlitzenEngine::Engine engine;
+        BlitzenEngine::Engine engine(argc > 1 ? argv[1] : BLITZEN_INPUT_RECORDING_FILE, argc > 2 ? argv[2] : BLITZEN_SCENE_MANIFEST_FILE);
         engine.MainEngineLoop();
     }
 
     BlitzenCore::MemoryManagementShutdown();
+    return 0;
 }
\ No newline at end of file
@@ -1,11 +1,27 @@
 #pragma once
 
 #include "Platform/blitPlatform.h"
+#include "Platform/blitAsyncIO.h"
 #include "Core/blitzenContainerLibrary.h"
 #include "Core/blitEvents.h"
+#include "Core/blitInputRecorder.h"
+#include "Core/blitProfiler.h"
+#include "Core/blitFrameStats.h"
+#include "Core/blitFlightRecorder.h"
+#include "Core/blitMetrics.h"
+#include "Core/blitFramePacer.h"
+#include "Core/blitJobs.h"
+#include "Core/blitThreadAffinity.h"
+#include "Core/blitSceneManifest.h"
+#include "Core/blitBenchmark.h"
+#include "Core/blitStartup.h"
 
 #include "BlitzenVulkan/vulkanRenderer.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 #define BLITZEN_VERSION                 "Blitzen Engine 0.X"
 
 #define BLITZEN_VULKAN                  1
@@ -15,6 +31,41 @@
 #define BLITZEN_WINDOW_WIDTH            1280
 #define BLITZEN_WINDOW_HEIGHT           720
 
+// 0: input recording inactive, 1: records live input to the file below, 2: replays the file with a fixed delta time.
+// Headless runs have no other input, so they always replay
+#if BLITZEN_PLATFORM_HEADLESS
+    #define BLITZEN_INPUT_RECORDING_MODE    2
+#else
+    #define BLITZEN_INPUT_RECORDING_MODE    0
+#endif
+#define BLITZEN_INPUT_RECORDING_FILE        "BlitzenInput.rec"
+// Saved in new recordings, every frame of a replay uses the delta time that its recording saved
+#define BLITZEN_INPUT_REPLAY_DELTA_TIME     (1.0 / 60.0)
+
+// Frames are paced to this rate, 0 leaves them unlimited. Headless runs are benchmarks, so they are never held back
+#if BLITZEN_PLATFORM_HEADLESS
+    #define BLITZEN_TARGET_FPS              0
+#else
+    #define BLITZEN_TARGET_FPS              144
+#endif
+
+// When this is set, frames are drawn on a thread of their own from copies of the main thread's state, so that the next frame is simulated
+// while the last one is recorded and submitted
+#define BLITZEN_RENDER_THREAD           1
+// Contexts that the main thread can hand over before it waits for the render thread
+#define BLITZEN_RENDER_CONTEXT_RING     2
+
+// While the window is minimized (or unfocused, when the one below is set) nothing is simulated or drawn and the main thread sleeps on
+// the OS's events. It still wakes at this rate for the frame bookkeeping, 0 makes it wait for an event however long it takes
+#define BLITZEN_SUSPENDED_TICK_RATE     4
+// Losing focus suspends the engine too. Replays and benchmarks are left running, since those are often run in the background
+#define BLITZEN_SUSPEND_WHEN_UNFOCUSED  1
+
+// The simulation advances in fixed steps at this rate however fast frames are drawn, frames in between interpolate the last two steps
+#define BLITZEN_SIMULATION_RATE         120
+// Steps that one frame may run to catch up. Time past that is dropped, so that a stall does not make the frames after it slower too
+#define BLITZEN_SIMULATION_MAX_STEPS    8
+
 namespace BlitzenEngine
 {
     struct PlatformData
@@ -39,12 +90,37 @@ namespace BlitzenEngine
         BlitzenCore::EventSystemState eventSystemState;
 
         uint8_t inputSystem = 0;
+
+        uint8_t inputRecording = 0;
+
+        uint8_t profiler = 0;
+
+        uint8_t jobSystem = 0;
+
+        uint8_t asyncIo = 0;
+    };
+
+    struct RenderThreadState
+    {
+        std::thread thread;
+
+        // The main thread writes the context at produced. The render thread draws the one at consumed and only moves past it once it is drawn
+        BlitzenVulkan::RenderContext contexts[BLITZEN_RENDER_CONTEXT_RING];
+        uint64_t produced = 0;
+        uint64_t consumed = 0;
+        uint8_t bStop = 0;
+
+        std::mutex mutex;
+        std::condition_variable producedCondition;
+        std::condition_variable consumedCondition;
     };
 
     class Engine
     {
     public:
-        Engine();
+        // The input recording and the scene manifest can be given on the command line, so that the same build can replay different scripts
+        // and benchmark different content
+        Engine(const char* inputRecordingFile = BLITZEN_INPUT_RECORDING_FILE, const char* sceneManifestFile = BLITZEN_SCENE_MANIFEST_FILE);
 
         void MainEngineLoop();
 
@@ -55,10 +131,15 @@ namespace BlitzenEngine
         inline EngineSystems& GetEngineSystems() {return m_systems;}
 
         void UpdateWindowSize(uint32_t width, uint32_t height);
+        void UpdateWindowFocus(uint8_t bFocused);
 
         inline Camera& GetMainCamera() { return m_mainCamera; }
         inline double GetDeltaTime() { return m_deltaTime; }
 
+        // Moves a node of one of the manifest's scenes (by manifest index) in every instance of that scene, from the next drawn frame.
+        // Setting the same node again before then replaces the transform that is waiting
+        void SetNodeTransform(uint32_t scene, uint32_t node, const glm::mat4& localTransform);
+
         inline void ChangeVulkanDrawMode() { m_bVulkanDrawIndirect = !m_bVulkanDrawIndirect; }
         inline void FreezeFrustum() { m_bFreezeFrustum = !m_bFreezeFrustum; }
     
@@ -66,6 +147,31 @@ namespace BlitzenEngine
 
         void StartClock();
         void StopClock();
+
+        // Writes the engine's and the renderer's memory usage to the memory report. Called by whichever thread owns the renderer
+        void ReportMemory(uint32_t frameIndex, double time);
+
+        // Draws the context and takes the memory report if it asks for one
+        void DrawRenderContext(const BlitzenVulkan::RenderContext& context);
+
+        // Hands the context to the render thread, or draws it right away without one
+        void SubmitRenderContext(const BlitzenVulkan::RenderContext& context);
+
+        void StartRenderThread();
+        // Draws the contexts that were already handed over before the thread stops
+        void StopRenderThread();
+        void RenderThreadMain();
+
+        // Runs the simulation steps that the frame's time adds up to and interpolates what is drawn between the last two
+        void RunSimulation(double deltaTime);
+
+        // Takes the loaded transforms of the manifest's spinning nodes, the ones that do not exist are dropped
+        void InitSpins();
+        // Sets the transform of every spinning node for the current simulation time
+        void UpdateSpins();
+
+        // Suspends or resumes the engine, after the window was minimized, restored, or changed focus
+        void UpdateSuspended();
     
     private:
 
@@ -73,13 +179,26 @@ namespace BlitzenEngine
 
         BlitzenVulkan::VulkanRenderer m_vulkan;
 
+        // After the main loop starts, the renderer is only used by the render thread
+        RenderThreadState m_renderThread;
+
         BlitzenPlatform::PlatformState platformState;
         PlatformData platformData;
 
         EngineSystems m_systems;
 
+        // What the renderer loads, and the benchmark scenarios that drive the camera if there are any
+        BlitzenCore::SceneManifest m_sceneManifest;
+
         Camera m_mainCamera;
 
+        // Node transforms that were set since the last render context, or did not fit in it
+        std::vector<BlitzenVulkan::NodeTransformUpdate> m_pendingNodeUpdates;
+
+        // The manifest's spinning nodes that were found, with the transforms that they were loaded with
+        std::vector<BlitzenCore::ManifestSpin> m_spins;
+        std::vector<glm::mat4> m_spinBaseTransforms;
+
         Controller m_mainController;
         bool m_bVulkanDrawIndirect = true;
         bool m_bFreezeFrustum = false;
@@ -88,8 +207,25 @@ namespace BlitzenEngine
 
         double m_deltaTime = 0;
 
+        // Frame time that has not been simulated yet, always less than a step after RunSimulation
+        double m_simulationAccumulator = 0.0;
+        // Time of the last simulation step since the main loop started
+        double m_simulationTime = 0.0;
+        uint32_t m_simulationStepMetric = BLITZEN_INVALID_METRIC;
+
+        // Counts the frames since the main loop started, input recordings use it to tag events
+        uint32_t m_frameIndex = 0;
+
+        // Clock time of the last memory report that a render context asked for
+        double m_lastMemoryReportTime = 0.0;
+
+        uint32_t m_cpuFrameMetric = BLITZEN_INVALID_METRIC;
+
         uint8_t isRunning = 0;
+        // Nothing is simulated or drawn while this is set
         uint8_t isSuspended = 0;
+        uint8_t m_bMinimized = 0;
+        uint8_t m_bUnfocused = 0;
     };
 
 